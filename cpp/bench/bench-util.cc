@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <new>
+
+#include "bench-util.h"
+
+
+using Clock = std::chrono::steady_clock;
+
+
+// ---- allocation counter -----------------------------------------------------
+
+static std::atomic<usize> s_allocation_count { 0 };
+static std::atomic<usize> s_allocation_bytes { 0 };
+
+
+void* operator new(std::size_t size)
+{
+    s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    s_allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+AllocationStats CurrentAllocations()
+{
+    return AllocationStats {
+        s_allocation_count.load(std::memory_order_relaxed),
+        s_allocation_bytes.load(std::memory_order_relaxed),
+    };
+}
+
+
+BenchAllocator::BenchAllocator()
+    : ZstdMallocAllocator()
+    , allocation_count_(0)
+{
+}
+
+
+usize BenchAllocator::AllocationCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocation_count_;
+}
+
+
+void* BenchAllocator::AllocateBlock(usize size)
+{
+    ++allocation_count_;
+    return ZstdMallocAllocator::AllocateBlock(size);
+}
+
+
+// ---- fixtures ---------------------------------------------------------------
+
+Vec<u8> LoadFixture(const std::string& name)
+{
+    std::ifstream stream("test/fixtures/" + name, std::ios::binary);
+    return Vec<u8>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+
+Vec<Vec<u8>> SplitChunks(const Vec<u8>& bytes, usize chunk_size)
+{
+    Vec<Vec<u8>> chunks;
+    for (usize offset = 0; offset < bytes.size(); offset += chunk_size) {
+        const auto end = std::min(offset + chunk_size, bytes.size());
+        chunks.emplace_back(std::begin(bytes) + offset, std::begin(bytes) + end);
+    }
+
+    return chunks;
+}
+
+
+// ---- measurement ------------------------------------------------------------
+
+BenchResult Measure(int min_iterations, double min_seconds, usize content_size, BenchAllocator& allocator,
+                    const std::function<usize()>& body)
+{
+    BenchResult result {};
+    result.content_size = content_size;
+
+    // warm up, also pools contexts
+    result.compressed_size = body();
+
+    const auto allocations_before = CurrentAllocations();
+    const auto zstd_allocations_before = allocator.AllocationCount();
+    allocator.ResetPeak();
+    const auto begin = Clock::now();
+
+    auto iterations = 0;
+    auto elapsed = 0.0;
+    while (iterations < min_iterations || elapsed < min_seconds) {
+        body();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    }
+
+    const auto allocations_after = CurrentAllocations();
+    const auto zstd_allocations_after = allocator.AllocationCount();
+
+    const auto total_mb = static_cast<double>(content_size) * iterations / (1024.0 * 1024.0);
+    result.iterations = iterations;
+    result.mb_per_sec = total_mb / elapsed;
+    result.allocations = static_cast<double>(allocations_after.count - allocations_before.count) / iterations;
+    result.allocated_bytes = static_cast<double>(allocations_after.bytes - allocations_before.bytes) / iterations;
+    result.zstd_allocations = static_cast<double>(zstd_allocations_after - zstd_allocations_before) / iterations;
+    result.zstd_current_bytes = allocator.CurrentBytes();
+    result.zstd_peak_bytes = allocator.PeakBytes();
+
+    return result;
+}
+
+
+// ---- json -------------------------------------------------------------------
+
+// NOTE: names are plain ascii identifiers, no escaping needed.
+static std::string Quote(const std::string& s)
+{
+    return "\"" + s + "\"";
+}
+
+
+std::string ToJson(const std::string& zstd_version, const Vec<BenchResult>& results)
+{
+    std::string json;
+    json += "{\n";
+    json += "  \"zstd_version\": " + Quote(zstd_version) + ",\n";
+    json += "  \"results\": [\n";
+
+    char line[1024];
+    for (usize i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        snprintf(line, sizeof(line),
+                 "    {\"api\": %s, \"operation\": %s, \"variant\": %s, \"fixture\": %s, "
+                 "\"level\": %d, \"chunk_size\": %zu, \"content_size\": %zu, \"compressed_size\": %zu, "
+                 "\"iterations\": %d, \"mb_per_sec\": %.2f, \"allocations\": %.1f, \"allocated_bytes\": %.0f, "
+                 "\"zstd_allocations\": %.1f, \"zstd_current_bytes\": %zu, \"zstd_peak_bytes\": %zu}%s\n",
+                 Quote(r.api).c_str(), Quote(r.operation).c_str(), Quote(r.variant).c_str(), Quote(r.fixture).c_str(),
+                 r.level, r.chunk_size, r.content_size, r.compressed_size,
+                 r.iterations, r.mb_per_sec, r.allocations, r.allocated_bytes,
+                 r.zstd_allocations, r.zstd_current_bytes, r.zstd_peak_bytes,
+                 i + 1 < results.size() ? "," : "");
+        json += line;
+    }
+
+    json += "  ]\n";
+    json += "}\n";
+    return json;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "common-types.h"
+#include "zstd-allocator.h"
+
+
+/*
+helpers of bench-zstd-codec.
+
+allocations are counted by replacing global operator new/delete,
+so they cover Vec<u8> and other C++ heap usage, not zstd's internal malloc.
+benchmarked codecs and streams allocate through BenchAllocator to count zstd's ones.
+*/
+
+struct AllocationStats
+{
+    usize   count;
+    usize   bytes;
+};
+
+
+AllocationStats CurrentAllocations();
+
+
+// malloc/free, counting allocations on top of bytes.
+class BenchAllocator : public ZstdMallocAllocator
+{
+public:
+    BenchAllocator();
+
+    usize AllocationCount() const;
+
+protected:
+    void* AllocateBlock(usize size) override;
+
+private:
+    usize   allocation_count_;
+};
+
+
+Vec<u8> LoadFixture(const std::string& name);
+Vec<Vec<u8>> SplitChunks(const Vec<u8>& bytes, usize chunk_size);
+
+
+struct BenchResult
+{
+    std::string api;            // simple, streaming, dict, read
+    std::string operation;      // compress, decompress
+    std::string variant;        // input path etc, empty if none
+    std::string fixture;
+    int         level;          // 0 for decompress
+    usize       chunk_size;     // 0 for one-shot apis
+    usize       content_size;
+    usize       compressed_size;
+    int         iterations;
+    double      mb_per_sec;     // of content (uncompressed) bytes
+    double      allocations;    // per iteration
+    double      allocated_bytes;
+    double      zstd_allocations;   // per iteration
+    usize       zstd_current_bytes; // held after the iterations, by pooled contexts etc
+    usize       zstd_peak_bytes;    // during the iterations
+};
+
+
+// runs `body` repeatedly (at least `min_iterations` times and `min_seconds` long),
+// `body` returns compressed size of the iteration, zstd allocations are read from `allocator`.
+BenchResult Measure(int min_iterations, double min_seconds, usize content_size, BenchAllocator& allocator,
+                    const std::function<usize()>& body);
+
+
+std::string ToJson(const std::string& zstd_version, const Vec<BenchResult>& results);
@@ -0,0 +1,261 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "zstd.h"
+#include "bench-util.h"
+#include "zstd-codec.h"
+#include "zstd-dict.h"
+#include "zstd-read.h"
+#include "zstd-stream.h"
+
+/*
+measures throughput (MB/s of uncompressed bytes) and allocations (C++ heap and zstd) per iteration
+of Simple, Streaming, Dict and Read paths over the test fixtures,
+then writes the results as JSON.
+
+usage: bench-zstd-codec [--quick] [output.json]
+    writes to stdout unless output path is given.
+
+run from the cpp directory, see run_bench.sh
+*/
+
+static const char* FIXTURES[] = {
+    "lorem.txt",
+    "sample-books.json",
+    "dance_yorokobi_mai_man.bmp",
+    "dance_yorokobi_mai_woman.bmp",
+};
+
+static const int LEVELS[] = { 1, 3, 9 };
+
+static const usize CHUNK_SIZES[] = {
+    1 * 1024,
+    32 * 1024,
+    512 * 1024,
+};
+
+static const char* DICT_FIXTURE = "sample-books.json";
+static const char* DICT_NAME = "sample-dict";
+
+
+struct BenchConfig
+{
+    int     min_iterations;
+    double  min_seconds;
+};
+
+
+static Vec<u8> CompressSimple(const ZstdCodec& codec, const Vec<u8>& content, int level)
+{
+    Vec<u8> compressed(codec.CompressBound(content.size()));
+    compressed.resize(codec.Compress(compressed, content, level));
+    return compressed;
+}
+
+
+static BenchResult Labeled(BenchResult result, const char* api, const char* operation, const char* variant,
+                           const std::string& fixture, int level, usize chunk_size)
+{
+    result.api = api;
+    result.operation = operation;
+    result.variant = variant;
+    result.fixture = fixture;
+    result.level = level;
+    result.chunk_size = chunk_size;
+    return result;
+}
+
+
+static void BenchSimple(const BenchConfig& config, Vec<BenchResult>& results)
+{
+    const auto allocator = std::make_shared<BenchAllocator>();
+    ZstdCodec codec(allocator);
+
+    for (const auto fixture : FIXTURES) {
+        const auto content = LoadFixture(fixture);
+
+        for (const auto level : LEVELS) {
+            Vec<u8> dest(codec.CompressBound(content.size()));
+            const auto compress = Measure(config.min_iterations, config.min_seconds, content.size(), *allocator, [&]() {
+                return static_cast<usize>(codec.Compress(dest, content, level));
+            });
+            results.push_back(Labeled(compress, "simple", "compress", "", fixture, level, 0));
+
+            const auto compressed = CompressSimple(codec, content, level);
+            Vec<u8> decompressed(content.size());
+            auto decompress = Measure(config.min_iterations, config.min_seconds, content.size(), *allocator, [&]() {
+                codec.Decompress(decompressed, compressed);
+                return compressed.size();
+            });
+            results.push_back(Labeled(decompress, "simple", "decompress", "", fixture, level, 0));
+        }
+    }
+}
+
+
+static void BenchStreaming(const BenchConfig& config, Vec<BenchResult>& results)
+{
+    const auto allocator = std::make_shared<BenchAllocator>();
+    ZstdCodec codec(allocator);
+
+    for (const auto fixture : FIXTURES) {
+        const auto content = LoadFixture(fixture);
+
+        for (const auto level : LEVELS) {
+            const auto compressed = CompressSimple(codec, content, level);
+
+            for (const auto chunk_size : CHUNK_SIZES) {
+                const auto content_chunks = SplitChunks(content, chunk_size);
+                const auto compressed_chunks = SplitChunks(compressed, chunk_size);
+
+                usize output_size = 0;
+                const StreamCallback callback = [&output_size](const Vec<u8>& bytes) {
+                    output_size += bytes.size();
+                };
+
+                const auto buffered = Measure(config.min_iterations, config.min_seconds, content.size(), *allocator, [&]() {
+                    output_size = 0;
+                    ZstdCompressStream stream(allocator);
+                    stream.Begin(level);
+                    for (const auto& chunk : content_chunks) {
+                        stream.Transform(chunk, callback);
+                    }
+                    stream.End(callback);
+                    return output_size;
+                });
+                results.push_back(Labeled(buffered, "streaming", "compress", "buffered", fixture, level, chunk_size));
+
+                const auto direct = Measure(config.min_iterations, config.min_seconds, content.size(), *allocator, [&]() {
+                    output_size = 0;
+                    ZstdCompressStream stream(allocator);
+                    stream.Begin(level);
+                    for (const auto& chunk : content_chunks) {
+                        stream.Transform(chunk.data(), chunk.size(), callback);
+                    }
+                    stream.End(callback);
+                    return output_size;
+                });
+                results.push_back(Labeled(direct, "streaming", "compress", "direct", fixture, level, chunk_size));
+
+                auto decompress = Measure(config.min_iterations, config.min_seconds, content.size(), *allocator, [&]() {
+                    ZstdDecompressStream stream(allocator);
+                    stream.Begin();
+                    for (const auto& chunk : compressed_chunks) {
+                        stream.Transform(chunk.data(), chunk.size(), callback);
+                    }
+                    stream.End(callback);
+                    return compressed.size();
+                });
+                results.push_back(Labeled(decompress, "streaming", "decompress", "", fixture, level, chunk_size));
+            }
+        }
+    }
+}
+
+
+static void BenchDict(const BenchConfig& config, Vec<BenchResult>& results)
+{
+    const auto allocator = std::make_shared<BenchAllocator>();
+    ZstdCodec codec(allocator);
+    const auto content = LoadFixture(DICT_FIXTURE);
+    const auto dict_bytes = LoadFixture(DICT_NAME);
+    const ZstdDecompressionDict ddict(dict_bytes);
+
+    for (const auto level : LEVELS) {
+        const ZstdCompressionDict cdict(dict_bytes, level);
+
+        Vec<u8> compressed(codec.CompressBound(content.size()));
+        const auto compress = Measure(config.min_iterations, config.min_seconds, content.size(), *allocator, [&]() {
+            compressed.resize(compressed.capacity());
+            compressed.resize(codec.CompressUsingDict(compressed, content, cdict));
+            return compressed.size();
+        });
+        results.push_back(Labeled(compress, "dict", "compress", "", DICT_FIXTURE, level, 0));
+
+        Vec<u8> decompressed(content.size());
+        auto decompress = Measure(config.min_iterations, config.min_seconds, content.size(), *allocator, [&]() {
+            codec.DecompressUsingDict(decompressed, compressed, ddict);
+            return compressed.size();
+        });
+        results.push_back(Labeled(decompress, "dict", "decompress", "", DICT_FIXTURE, level, 0));
+    }
+}
+
+
+static void BenchRead(const BenchConfig& config, Vec<BenchResult>& results)
+{
+    const auto allocator = std::make_shared<BenchAllocator>();
+    ZstdCodec codec(allocator);
+
+    for (const auto fixture : FIXTURES) {
+        const auto content = LoadFixture(fixture);
+        const auto compressed = CompressSimple(codec, content, 3);
+
+        for (const auto chunk_size : CHUNK_SIZES) {
+            const auto compressed_chunks = SplitChunks(compressed, chunk_size);
+            const StreamCallback callback = [](const Vec<u8>&) {};
+
+            auto decompress = Measure(config.min_iterations, config.min_seconds, content.size(), *allocator, [&]() {
+                ZstdDecompressRead stream(allocator);
+                stream.Begin();
+                for (const auto& chunk : compressed_chunks) {
+                    stream.Load(chunk);
+                    while (stream.Read(callback)) {
+                    }
+                }
+                stream.End(callback);
+                return compressed.size();
+            });
+            results.push_back(Labeled(decompress, "read", "decompress", "", fixture, 3, chunk_size));
+
+            Vec<u8> dest(ZSTD_DStreamOutSize());
+            auto pull = Measure(config.min_iterations, config.min_seconds, content.size(), *allocator, [&]() {
+                ZstdDecompressRead stream(allocator);
+                stream.Begin();
+                for (const auto& chunk : compressed_chunks) {
+                    stream.Load(chunk.data(), chunk.size());
+                    while (stream.Read(dest.data(), dest.size()) > 0) {
+                    }
+                }
+                stream.End(callback);
+                return compressed.size();
+            });
+            results.push_back(Labeled(pull, "read", "decompress", "pull", fixture, 3, chunk_size));
+        }
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    BenchConfig config { 5, 0.2 };
+    const char* output_path = nullptr;
+
+    for (auto i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            config = BenchConfig { 1, 0.0 };
+        }
+        else {
+            output_path = argv[i];
+        }
+    }
+
+    Vec<BenchResult> results;
+    BenchSimple(config, results);
+    BenchStreaming(config, results);
+    BenchDict(config, results);
+    BenchRead(config, results);
+
+    const auto json = ToJson(ZSTD_versionString(), results);
+    if (output_path == nullptr) {
+        fputs(json.c_str(), stdout);
+        return 0;
+    }
+
+    std::ofstream stream(output_path);
+    stream << json;
+    return stream ? 0 : 1;
+}
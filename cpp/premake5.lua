@@ -11,6 +11,27 @@ newoption {
 }
 
 
+newoption {
+    trigger = "with-zstd-mt-dir",
+    description = "Absolute path to zstd directory built with ZSTD_MULTITHREAD (pthreads)",
+    value = "/full/path/to/zstd-mt",
+}
+
+
+newoption {
+    trigger = "with-node-include-dir",
+    description = "Absolute path to Node.js headers (node_api.h) for zstd-codec-binding-node",
+    value = "/full/path/to/include/node",
+}
+
+
+newoption {
+    trigger = "with-trace-level",
+    description = "Compile-time trace level (0: off, 1: error, 2: info, 3: debug), see src/zstd-trace.h",
+    value = "LEVEL",
+}
+
+
 if premake.modules.gmake2 then
     premake.override(premake.modules.gmake2.cpp, "linkCmd", function(base, cfg, toolset)
         local is_emscripten = _OPTIONS["with-emscripten"]
@@ -39,6 +60,31 @@ function zstd_lib_dir()
 end
 
 
+-- NOTE: native zstd builds are multi-threaded already, share the directory unless specified.
+function zstd_mt_root_dir()
+    if _OPTIONS["with-zstd-mt-dir"] then
+        return _OPTIONS["with-zstd-mt-dir"]
+    else
+        return zstd_root_dir()
+    end
+end
+
+
+function zstd_mt_lib_dir()
+    return string.format("%s/lib", zstd_mt_root_dir())
+end
+
+
+function node_include_dir()
+    if _OPTIONS["with-node-include-dir"] then
+        return _OPTIONS["with-node-include-dir"]
+    else
+        -- NOTE: headers are installed next to the node executable.
+        return os.outputof('node -p "require(\'path\').resolve(process.execPath, \'../../include/node\')"')
+    end
+end
+
+
 function zstd_lib_name()
     if os.istarget("macosx") then
         return 'libzstd.dylib'
@@ -51,6 +97,10 @@ end
 workspace "zstd-codec"
     configurations {"Debug", "Release"}
 
+    if _OPTIONS["with-trace-level"] then
+        defines { "ZSTD_CODEC_TRACE_LEVEL=" .. _OPTIONS["with-trace-level"] }
+    end
+
     filter "configurations:Debug"
         defines { "DEBUG" }
         symbols "On"
@@ -65,8 +115,11 @@ workspace "zstd-codec"
     filter { "action:gmake*", "options:with-emscripten" }
         location "./build-emscripten"
 
+    -- NOTE: ZstdThreadPool runs std::thread on native builds.
     filter { "action:gmake*", "options:not with-emscripten" }
         location "./build-gmake"
+        buildoptions {"-pthread"}
+        linkoptions {"-pthread"}
 
 
 externalproject "zstd"
@@ -79,6 +132,17 @@ externalproject "zstd"
         targetextension ".bc"
 
 
+externalproject "zstd-mt"
+    location (zstd_mt_root_dir())
+    kind "StaticLib"
+    language "C"
+    targetname "zstd"
+    targetdir (zstd_mt_lib_dir())
+
+    filter "options:with-emscripten"
+        targetextension ".bc"
+
+
 project "zstd-codec"
     language "C++"
     kind "StaticLib"
@@ -113,6 +177,50 @@ project "zstd-codec"
             string.format("{COPY} %s/%s %s/libzstd.bc", zstd_lib_dir(), zstd_lib_name(), zstd_lib_dir()),
         }
 
+    -- NOTE: linked into zstd-codec-binding-node shared library.
+    filter "options:not with-emscripten"
+        pic "On"
+
+
+-- NOTE: same sources as zstd-codec, compiled with pthreads for zstd-codec-binding-wasm-mt.
+project "zstd-codec-mt"
+    language "C++"
+    kind "StaticLib"
+
+    dependson "zstd-mt"
+
+    defines {
+        "ZSTD_STATIC_LINKING_ONLY",
+    }
+
+    buildoptions {
+        "-pthread",
+    }
+
+    includedirs {
+        zstd_mt_lib_dir(),
+    }
+
+    files {
+        "src/**.h",
+        "src/**.hpp",
+        "src/**.c",
+        "src/**.cc",
+    }
+
+    libdirs {
+        zstd_mt_lib_dir(),
+    }
+
+    removefiles {
+        "src/binding/**"
+    }
+
+    filter "options:with-emscripten"
+        prebuildcommands {
+            string.format("{COPY} %s/%s %s/libzstd.bc", zstd_mt_lib_dir(), zstd_lib_name(), zstd_mt_lib_dir()),
+        }
+
 
 project "test-zstd-codec"
     kind "ConsoleApp"
@@ -137,6 +245,27 @@ project "test-zstd-codec"
     }
 
 
+project "bench-zstd-codec"
+    kind "ConsoleApp"
+    language "C++"
+    targetdir "%{wks.location}/bin/%{cfg.buildcfg}"
+
+    includedirs {
+        "zstd/lib",
+        "src",
+    }
+
+    files {
+        "bench/**.h",
+        "bench/**.cc",
+    }
+
+    links {
+        "zstd-codec",
+        "zstd",
+    }
+
+
 project "zstd-codec-binding"
     kind "SharedLib"
     language "C++"
@@ -213,6 +342,7 @@ project "zstd-codec-binding-wasm"
             "-s 'EXTRA_EXPORTED_RUNTIME_METHODS=[\"FS\"]'",
             "-s MODULARIZE=1",
             "-s WASM=1",
+            "-s ALLOW_MEMORY_GROWTH=1",
             "-s SINGLE_FILE=1",
             "-s BINARYEN_ASYNC_COMPILATION=1",
             "-s NODEJS_CATCH_EXIT=0",
@@ -230,3 +360,98 @@ project "zstd-codec-binding-wasm"
         files {
             "src/binding/others/**.cc",
         }
+
+project "zstd-codec-binding-wasm-mt"
+    kind "SharedLib"
+    language "C++"
+    targetdir "%{wks.location}/bin/%{cfg.buildcfg}"
+
+    -- NOTE: avoid build bindings on non-Emscripten platform
+    filter "options:with-emscripten"
+        targetprefix    ""
+        targetextension ".js"
+
+        includedirs {
+            zstd_mt_lib_dir(),
+        }
+
+        files {
+            "src/binding/emscripten/**.cc",
+        }
+
+        links {
+            "zstd-codec-mt",
+            "zstd-mt",
+        }
+
+        buildoptions {
+            "-pthread",
+        }
+
+        -- NOTE: requires SharedArrayBuffer, Node.js runs pthreads on worker_threads.
+        --       shared heap can't grow with pthreads, so reserve a larger one up front.
+        linkoptions {
+            "--bind",
+            "--memory-init-file 0",
+            "-s DEMANGLE_SUPPORT=1",
+            "-s 'EXTRA_EXPORTED_RUNTIME_METHODS=[\"FS\"]'",
+            "-s MODULARIZE=1",
+            "-s WASM=1",
+            "-s USE_PTHREADS=1",
+            "-s PTHREAD_POOL_SIZE=4",
+            "-s TOTAL_MEMORY=268435456",
+            "-s ENVIRONMENT=web,worker,node",
+            "-s NODEJS_CATCH_EXIT=0",
+            "-s NODEJS_CATCH_REJECTION=0"
+        }
+
+    filter {"options:with-emscripten", "configurations:Release"}
+        linkoptions {
+            "-O2",
+            "-s USE_CLOSURE_COMPILER=1",
+        }
+
+    -- NOTE: don't know how to exclude this project on other platofrms.
+    filter "options:not with-emscripten"
+        files {
+            "src/binding/others/**.cc",
+        }
+
+project "zstd-codec-binding-node"
+    kind "SharedLib"
+    language "C++"
+    targetdir "%{wks.location}/bin/%{cfg.buildcfg}"
+
+    -- NOTE: Node.js addon is native only, copy it into js/lib to use.
+    filter "options:not with-emscripten"
+        targetprefix    ""
+        targetextension ".node"
+
+        defines {
+            "NAPI_VERSION=8",
+            "ZSTD_STATIC_LINKING_ONLY",
+        }
+
+        includedirs {
+            "zstd/lib",
+            node_include_dir(),
+        }
+
+        files {
+            "src/binding/node/**.cc",
+        }
+
+        links {
+            "zstd-codec",
+            "zstd",
+        }
+
+    filter {"options:not with-emscripten", "system:macosx"}
+        linkoptions {
+            "-undefined dynamic_lookup",
+        }
+
+    filter "options:with-emscripten"
+        files {
+            "src/binding/others/**.cc",
+        }
@@ -0,0 +1,18 @@
+#!/bin/bash
+
+CPP_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+BUILD_TYPE=$1
+OUTPUT=$2
+
+if [ "${BUILD_TYPE}" == "" ]; then
+    BUILD_TYPE="Release"
+fi
+
+if [ "${OUTPUT}" == "" ]; then
+    OUTPUT="bench/tmp/bench-zstd-codec.json"
+fi
+
+mkdir -p "$CPP_DIR/bench/tmp"
+
+cd $CPP_DIR
+./build-gmake/bin/${BUILD_TYPE}/bench-zstd-codec "${OUTPUT}"
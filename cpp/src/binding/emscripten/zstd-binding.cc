@@ -1,8 +1,15 @@
 #include <emscripten/bind.h>
 #include <array>
+#include <string>
 
+#include "../../zstd-allocator.h"
+#include "../../zstd-cdict-cache.h"
 #include "../../zstd-codec.h"
 #include "../../zstd-dict.h"
+#include "../../zstd-dict-registry.h"
+#include "../../zstd-dict-trainer.h"
+#include "../../zstd-params.h"
+#include "../../zstd-seekable.h"
 #include "../../zstd-stream.h"
 #include "../../zstd-read.h"
 
@@ -10,22 +17,44 @@
 using namespace emscripten;
 
 
+// allocator bindings (declarations)
+
+// NOTE: objects created with the allocator share it, it lives until all of them are deleted.
+class ZstdAllocatorBinding
+{
+public:
+    std::shared_ptr<ZstdAllocator>  allocator;
+};
+
+
 // stream bindings (declarations)
 
 class ZstdCompressStreamBinding
 {
 public:
     ZstdCompressStreamBinding();
+    explicit ZstdCompressStreamBinding(const ZstdAllocatorBinding& allocator);
+    explicit ZstdCompressStreamBinding(ZstdWorkspace workspace);
     ~ZstdCompressStreamBinding();
 
     bool Begin(int compression_level);
+    bool Begin(int compression_level, int nb_workers);
+    bool BeginUsingParams(const ZstdCompressionParams& params);
     bool BeginUsingDict(const ZstdCompressionDict& cdict);
+    bool BeginUsingCache(ZstdCDictCache& cache, double dict_id, int compression_level);
     bool Transform(val chunk, val callback);
     bool Flush(val callback);
     bool End(val callback);
 
+    // write input into `InputBuffer(size)` view, then `TransformInput(size, callback)`.
+    val InputBuffer(usize size);
+    bool TransformInput(usize size, val callback);
+
+    double MemoryUsage() const;     // stream and input buffer
+
 private:
     ZstdCompressStream  stream_;
+    Vec<u8>             input_;
 };
 
 
@@ -33,35 +62,101 @@ class ZstdDecompressStreamBinding
 {
 public:
     ZstdDecompressStreamBinding();
+    explicit ZstdDecompressStreamBinding(const ZstdAllocatorBinding& allocator);
+    explicit ZstdDecompressStreamBinding(ZstdWorkspace workspace);
     ~ZstdDecompressStreamBinding();
 
     bool Begin();
     bool BeginUsingDict(const ZstdDecompressionDict& ddict);
-    int Transform(val chunk, int chunk_offset, int pos, val callback);
+    bool BeginUsingRegistry(const ZstdDictRegistry& registry);
+    bool Transform(val chunk, val callback);
     bool Flush(val callback);
-    bool End(int pos, val callback);
+    bool End(val callback);
+
+    // write input into `InputBuffer(size)` view, then `TransformInput(size, callback)`.
+    val InputBuffer(usize size);
+    bool TransformInput(usize size, val callback);
+
+    double MemoryUsage() const;     // stream and input buffer
 
 private:
     ZstdDecompressStream    stream_;
+    Vec<u8>                 input_;
 };
 
+
 class ZstdDecompressReadBinding
 {
 public:
     ZstdDecompressReadBinding();
+    explicit ZstdDecompressReadBinding(const ZstdAllocatorBinding& allocator);
+    explicit ZstdDecompressReadBinding(ZstdWorkspace workspace);
     ~ZstdDecompressReadBinding();
 
     bool Begin();
     bool BeginUsingDict(const ZstdDecompressionDict& ddict);
+    bool BeginUsingRegistry(const ZstdDictRegistry& registry);
 
     bool Load(val chunk);
     bool Read(val callback);
 
+    // decompresses into `dest` Uint8Array, returns the size written (see ZstdDecompressRead::Read).
+    double ReadInto(val dest);
+    bool HasInput() const;
+
     bool Flush(val callback);
     bool End(val callback);
 
+    double MemoryUsage() const;     // stream and its buffers
+
 private:
     ZstdDecompressRead    stream_;
+    Vec<u8>               chunk_;     // loaded chunk, referenced by the stream
+    Vec<u8>               output_;
+};
+
+
+class ZstdSeekableCompressStreamBinding
+{
+public:
+    ZstdSeekableCompressStreamBinding();
+    ~ZstdSeekableCompressStreamBinding();
+
+    bool Begin(int compression_level, double max_frame_size, bool checksum_flag);
+    bool BeginUsingParams(const ZstdCompressionParams& params, double max_frame_size);
+    bool Transform(val chunk, val callback);
+    bool EndFrame(val callback);
+    bool End(val callback);
+    double FrameCount() const;
+
+    // write input into `InputBuffer(size)` view, then `TransformInput(size, callback)`.
+    val InputBuffer(usize size);
+    bool TransformInput(usize size, val callback);
+
+private:
+    ZstdSeekableCompressStream  stream_;
+    Vec<u8>                     input_;
+};
+
+
+// NOTE: JS source `(offset, size) => Uint8Array` is called back while the reader reads.
+class ZstdSeekableReaderBinding
+{
+public:
+    ZstdSeekableReaderBinding();
+    ~ZstdSeekableReaderBinding();
+
+    bool Open(val src_bytes);
+    bool OpenUsingSource(double src_size, val source);
+    void Close();
+    double FrameCount() const;
+    double ContentSize() const;
+    val Read(double offset, double size);   // null on failure
+
+private:
+    ZstdSeekableReader  reader_;
+    Vec<u8>             src_bytes_;     // copy of compressed data, unless opened with a source
+    val                 source_;
 };
 
 
@@ -120,9 +215,10 @@ static size_t read_from_js_callback(val callback, Vec<u8>& buffer, size_t read_s
 }
 
 
+// NOTE: callback receives a view of the heap (not a copy), it's only valid until the callback returns.
 static void write_to_js_callback(val callback, const Vec<u8>& buffer, size_t write_size)
 {
-    callback(val(typed_memory_view(write_size, &buffer[0])));
+    callback(val(typed_memory_view(write_size, buffer.data())));
 }
 
 
@@ -155,7 +251,8 @@ val CloneAsTypedArray(const Vec<u8>& src)
     val src_buffer = heap_buffer();
     val src_view = heapu8["constructor"].new_(src_buffer, reinterpret_cast<uintptr_t>(&src[0]), src.size());
 
-    val dest_buffer = src_buffer["constructor"].new_(src.size());
+    // NOTE: heap may be a SharedArrayBuffer on pthreads build, always return a plain ArrayBuffer.
+    val dest_buffer = val::global("ArrayBuffer").new_(src.size());
     val dest_view = heapu8["constructor"].new_(dest_buffer);
 
     dest_view.call<void>("set", src_view);
@@ -175,6 +272,7 @@ val ToTypedArrayView(const Vec<u8>& src)
 // --- dictionary bindings (implementations) ----------------------------------
 
 
+// NOTE: dictionaries take the copied bytes and zstd references them, no second copy inside zstd.
 ZstdCompressionDict* CreateCompressionDict(val dict_bytes, int compression_level)
 {
     return new ZstdCompressionDict(from_js_typed_array<u8>(dict_bytes), compression_level);
@@ -187,6 +285,416 @@ ZstdDecompressionDict* CreateDecompressionDict(val dict_bytes)
 }
 
 
+// --- allocator bindings (implementations) -----------------------------------
+
+
+ZstdAllocatorBinding* CreateMallocAllocator()
+{
+    return new ZstdAllocatorBinding { std::make_shared<ZstdMallocAllocator>() };
+}
+
+
+ZstdAllocatorBinding* CreateArenaAllocator(double capacity)
+{
+    auto allocator = std::make_shared<ZstdArenaAllocator>(static_cast<usize>(capacity));
+    if (allocator->Capacity() != static_cast<usize>(capacity)) return nullptr;
+
+    return new ZstdAllocatorBinding { std::move(allocator) };
+}
+
+
+ZstdAllocatorBinding* CreatePoolAllocator(double max_cached_bytes)
+{
+    return new ZstdAllocatorBinding { std::make_shared<ZstdPoolAllocator>(static_cast<usize>(max_cached_bytes)) };
+}
+
+
+double AllocatorCurrentBytes(const ZstdAllocatorBinding& binding)
+{
+    return static_cast<double>(binding.allocator->CurrentBytes());
+}
+
+
+double AllocatorPeakBytes(const ZstdAllocatorBinding& binding)
+{
+    return static_cast<double>(binding.allocator->PeakBytes());
+}
+
+
+double AllocatorReservedBytes(const ZstdAllocatorBinding& binding)
+{
+    return static_cast<double>(binding.allocator->ReservedBytes());
+}
+
+
+void AllocatorResetPeak(ZstdAllocatorBinding& binding)
+{
+    binding.allocator->ResetPeak();
+}
+
+
+void AllocatorTrim(ZstdAllocatorBinding& binding)
+{
+    binding.allocator->Trim();
+}
+
+
+double CodecStaticCompressWorkspaceSize(int compression_level)
+{
+    return static_cast<double>(ZstdCodec::StaticCompressWorkspaceSize(compression_level));
+}
+
+
+double CodecStaticDecompressWorkspaceSize()
+{
+    return static_cast<double>(ZstdCodec::StaticDecompressWorkspaceSize());
+}
+
+
+double CompressStreamStaticWorkspaceSize(int compression_level)
+{
+    return static_cast<double>(ZstdCompressStream::StaticWorkspaceSize(compression_level));
+}
+
+
+double DecompressStreamStaticWorkspaceSize(double max_window_size)
+{
+    return static_cast<double>(ZstdDecompressStream::StaticWorkspaceSize(static_cast<usize>(max_window_size)));
+}
+
+
+double DecompressReadStaticWorkspaceSize(double max_window_size)
+{
+    return static_cast<double>(ZstdDecompressRead::StaticWorkspaceSize(static_cast<usize>(max_window_size)));
+}
+
+
+double CodecEstimateCompressMemory(int compression_level, double src_size)
+{
+    return static_cast<double>(ZstdCodec::EstimateCompressMemory(compression_level, static_cast<usize>(src_size)));
+}
+
+
+double CodecEstimateCompressMemoryUsingParams(const ZstdCompressionParams& params, double src_size)
+{
+    return static_cast<double>(ZstdCodec::EstimateCompressMemory(params, static_cast<usize>(src_size)));
+}
+
+
+double CodecEstimateDecompressMemory()
+{
+    return static_cast<double>(ZstdCodec::EstimateDecompressMemory());
+}
+
+
+double CodecMemoryUsage(const ZstdCodec& codec)
+{
+    return static_cast<double>(codec.MemoryUsage());
+}
+
+
+double CompressStreamEstimateMemory(int compression_level)
+{
+    return static_cast<double>(ZstdCompressStream::EstimateMemory(compression_level));
+}
+
+
+double CompressStreamEstimateMemoryUsingParams(const ZstdCompressionParams& params)
+{
+    return static_cast<double>(ZstdCompressStream::EstimateMemory(params));
+}
+
+
+double DecompressStreamEstimateMemory(const Vec<u8>& frame_header)
+{
+    return static_cast<double>(ZstdDecompressStream::EstimateMemory(frame_header));
+}
+
+
+double DecompressReadEstimateMemory(const Vec<u8>& frame_header)
+{
+    return static_cast<double>(ZstdDecompressRead::EstimateMemory(frame_header));
+}
+
+
+double CompressionDictMemoryUsage(const ZstdCompressionDict& cdict)
+{
+    return static_cast<double>(cdict.MemoryUsage());
+}
+
+
+double CompressionDictEstimateMemory(double dict_size, int compression_level)
+{
+    return static_cast<double>(ZstdCompressionDict::EstimateMemory(static_cast<usize>(dict_size), compression_level));
+}
+
+
+double DecompressionDictMemoryUsage(const ZstdDecompressionDict& ddict)
+{
+    return static_cast<double>(ddict.MemoryUsage());
+}
+
+
+double DecompressionDictEstimateMemory(double dict_size)
+{
+    return static_cast<double>(ZstdDecompressionDict::EstimateMemory(static_cast<usize>(dict_size)));
+}
+
+
+ZstdCodec* CreateCodecUsingAllocator(const ZstdAllocatorBinding& allocator)
+{
+    return new ZstdCodec(allocator.allocator);
+}
+
+
+ZstdCodec* CreateStaticCodec(double cctx_workspace_size, double dctx_workspace_size)
+{
+    return new ZstdCodec(ZstdWorkspace(static_cast<usize>(cctx_workspace_size)),
+                         ZstdWorkspace(static_cast<usize>(dctx_workspace_size)));
+}
+
+
+// NOTE: embind overloads constructors by argument count only,
+//       the argument is a ZstdAllocator, or workspace size of a static stream.
+template <typename T>
+T* NewStreamBinding(val allocator_or_workspace_size)
+{
+    if (allocator_or_workspace_size.typeOf().as<std::string>() == "number") {
+        return new T(ZstdWorkspace(static_cast<usize>(allocator_or_workspace_size.as<double>())));
+    }
+
+    return new T(*allocator_or_workspace_size.as<ZstdAllocatorBinding*>(allow_raw_pointers()));
+}
+
+
+// ---- dictionary trainer bindings --------------------------------------------
+
+void DictTrainerAddSample(ZstdDictTrainer& trainer, val sample)
+{
+    Vec<u8> sample_vec;
+    CloneToVector(sample_vec, sample);
+    trainer.AddSample(sample_vec);
+}
+
+
+double DictTrainerSampleCount(const ZstdDictTrainer& trainer)
+{
+    return static_cast<double>(trainer.SampleCount());
+}
+
+
+double DictTrainerSamplesSize(const ZstdDictTrainer& trainer)
+{
+    return static_cast<double>(trainer.SamplesSize());
+}
+
+
+double DictTrainerTrain(const ZstdDictTrainer& trainer, Vec<u8>& dict, double dict_capacity)
+{
+    return static_cast<double>(trainer.Train(dict, static_cast<usize>(dict_capacity)));
+}
+
+
+double DictTrainerTrainCover(const ZstdDictTrainer& trainer, Vec<u8>& dict, double dict_capacity,
+                             const ZstdDictTrainingParams& params)
+{
+    return static_cast<double>(trainer.TrainCover(dict, static_cast<usize>(dict_capacity), params));
+}
+
+
+double DictTrainerTrainFastCover(const ZstdDictTrainer& trainer, Vec<u8>& dict, double dict_capacity,
+                                 const ZstdDictTrainingParams& params)
+{
+    return static_cast<double>(trainer.TrainFastCover(dict, static_cast<usize>(dict_capacity), params));
+}
+
+
+// ---- dictionary registry bindings ------------------------------------------
+
+double DictRegistryAdd(ZstdDictRegistry& registry, val dict_bytes)
+{
+    return static_cast<double>(registry.Add(from_js_typed_array<u8>(dict_bytes)));
+}
+
+
+double DictRegistryCount(const ZstdDictRegistry& registry)
+{
+    return static_cast<double>(registry.Count());
+}
+
+
+// ---- CDict cache bindings ---------------------------------------------------
+
+double CDictCacheAddDict(ZstdCDictCache& cache, val dict_bytes)
+{
+    return static_cast<double>(cache.AddDict(from_js_typed_array<u8>(dict_bytes)));
+}
+
+
+bool CDictCacheRemoveDict(ZstdCDictCache& cache, double dict_id)
+{
+    return cache.RemoveDict(static_cast<unsigned>(dict_id));
+}
+
+
+bool CDictCacheContainsDict(const ZstdCDictCache& cache, double dict_id)
+{
+    return cache.ContainsDict(static_cast<unsigned>(dict_id));
+}
+
+
+double CDictCacheDigestedCount(const ZstdCDictCache& cache)
+{
+    return static_cast<double>(cache.DigestedCount());
+}
+
+
+double CDictCacheMemoryUsage(const ZstdCDictCache& cache)
+{
+    return static_cast<double>(cache.MemoryUsage());
+}
+
+
+double CDictCacheMemoryBudget(const ZstdCDictCache& cache)
+{
+    return static_cast<double>(cache.MemoryBudget());
+}
+
+
+void CDictCacheSetMemoryBudget(ZstdCDictCache& cache, double memory_budget)
+{
+    cache.SetMemoryBudget(static_cast<usize>(memory_budget));
+}
+
+
+// ---- codec bindings ----------------------------------------------------------
+
+// NOTE: embind can't return 64-bit integers without BigInt support,
+//       sizes are passed as double (exact up to Number.MAX_SAFE_INTEGER).
+double CodecCompressBound(const ZstdCodec& codec, double src_size)
+{
+    return static_cast<double>(codec.CompressBound(static_cast<usize>(src_size)));
+}
+
+
+double CodecContentSize(const ZstdCodec& codec, const Vec<u8>& src)
+{
+    return static_cast<double>(codec.ContentSize(src));
+}
+
+
+double CodecFramesContentSize(const ZstdCodec& codec, const Vec<u8>& src)
+{
+    return static_cast<double>(codec.FramesContentSize(src));
+}
+
+
+double CodecCompress(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src, int compression_level)
+{
+    return static_cast<double>(codec.Compress(dest, src, compression_level));
+}
+
+
+double CodecCompressWithWorkers(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src, int compression_level, int nb_workers)
+{
+    return static_cast<double>(codec.Compress(dest, src, compression_level, nb_workers));
+}
+
+
+double CodecCompressUsingParams(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionParams& params)
+{
+    return static_cast<double>(codec.Compress(dest, src, params));
+}
+
+
+double CodecCompressParallel(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src, int compression_level,
+                             int nb_threads, double block_size)
+{
+    return static_cast<double>(codec.CompressParallel(dest, src, compression_level, nb_threads, static_cast<usize>(block_size)));
+}
+
+
+double CodecCompressParallelUsingParams(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionParams& params,
+                                        int nb_threads, double block_size)
+{
+    return static_cast<double>(codec.CompressParallel(dest, src, params, nb_threads, static_cast<usize>(block_size)));
+}
+
+
+double CodecDecompress(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src)
+{
+    return static_cast<double>(codec.Decompress(dest, src));
+}
+
+
+double CodecDecompressParallel(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src, int nb_threads)
+{
+    return static_cast<double>(codec.DecompressParallel(dest, src, nb_threads));
+}
+
+
+double CodecCompressUsingDict(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionDict& cdict)
+{
+    return static_cast<double>(codec.CompressUsingDict(dest, src, cdict));
+}
+
+
+double CodecCompressUsingCache(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src, ZstdCDictCache& cache,
+                               double dict_id, int compression_level)
+{
+    return static_cast<double>(codec.CompressUsingDict(dest, src, cache, static_cast<unsigned>(dict_id), compression_level));
+}
+
+
+double CodecDecompressUsingDict(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src, const ZstdDecompressionDict& ddict)
+{
+    return static_cast<double>(codec.DecompressUsingDict(dest, src, ddict));
+}
+
+
+double CodecDecompressUsingRegistry(const ZstdCodec& codec, Vec<u8>& dest, const Vec<u8>& src, const ZstdDictRegistry& registry)
+{
+    return static_cast<double>(codec.DecompressUsingDict(dest, src, registry));
+}
+
+
+// NOTE: batches cross the binding once, packed bytes and Uint32Array offsets in and out.
+// returns packed output, or a negative error code.
+static val BatchResult(i64 rc, const Vec<u8>& dest, const Vec<usize>& dest_offsets, val js_dest_offsets)
+{
+    if (rc < 0) return val(static_cast<double>(rc));
+    if (dest.size() > UINT32_MAX) return val(static_cast<double>(ERR_SIZE_TOO_LARGE));
+
+    const Vec<u32> offsets(std::begin(dest_offsets), std::end(dest_offsets));
+    js_dest_offsets.call<void>("set", val(typed_memory_view(offsets.size(), offsets.data())));
+    return CloneAsTypedArray(dest);
+}
+
+
+val CodecCompressBatch(const ZstdCodec& codec, val src_bytes, val src_offsets, val dest_offsets, int compression_level)
+{
+    const auto src = from_js_typed_array<u8>(src_bytes);
+    const auto offsets = from_js_typed_array<u32>(src_offsets);
+
+    Vec<u8> dest;
+    Vec<usize> dest_offset_vec;
+    const auto rc = codec.CompressBatch(dest, dest_offset_vec, src, Vec<usize>(std::begin(offsets), std::end(offsets)), compression_level);
+    return BatchResult(rc, dest, dest_offset_vec, dest_offsets);
+}
+
+
+val CodecDecompressBatch(const ZstdCodec& codec, val src_bytes, val src_offsets, val dest_offsets)
+{
+    const auto src = from_js_typed_array<u8>(src_bytes);
+    const auto offsets = from_js_typed_array<u32>(src_offsets);
+
+    Vec<u8> dest;
+    Vec<usize> dest_offset_vec;
+    const auto rc = codec.DecompressBatch(dest, dest_offset_vec, src, Vec<usize>(std::begin(offsets), std::end(offsets)));
+    return BatchResult(rc, dest, dest_offset_vec, dest_offsets);
+}
+
+
 // ---- stream bindings (implementations) -------------------------------------
 
 //
@@ -200,6 +708,18 @@ ZstdCompressStreamBinding::ZstdCompressStreamBinding()
 }
 
 
+ZstdCompressStreamBinding::ZstdCompressStreamBinding(const ZstdAllocatorBinding& allocator)
+    : stream_(allocator.allocator)
+{
+}
+
+
+ZstdCompressStreamBinding::ZstdCompressStreamBinding(ZstdWorkspace workspace)
+    : stream_(std::move(workspace))
+{
+}
+
+
 ZstdCompressStreamBinding::~ZstdCompressStreamBinding()
 {
 }
@@ -211,30 +731,70 @@ bool ZstdCompressStreamBinding::Begin(int compression_level)
 }
 
 
+bool ZstdCompressStreamBinding::Begin(int compression_level, int nb_workers)
+{
+    return stream_.Begin(compression_level, nb_workers);
+}
+
+
+bool ZstdCompressStreamBinding::BeginUsingParams(const ZstdCompressionParams& params)
+{
+    return stream_.Begin(params);
+}
+
+
 bool ZstdCompressStreamBinding::BeginUsingDict(const ZstdCompressionDict& cdict)
 {
     return stream_.Begin(cdict);
 }
 
 
+bool ZstdCompressStreamBinding::BeginUsingCache(ZstdCDictCache& cache, double dict_id, int compression_level)
+{
+    return stream_.Begin(cache, static_cast<unsigned>(dict_id), compression_level);
+}
+
+
 bool ZstdCompressStreamBinding::Transform(val chunk, val callback)
 {
     // use local vector to ensure thread-safety
     Vec<u8> chunk_vec;
     CloneToVector(chunk_vec, chunk);
 
-    return stream_.Transform(chunk_vec, [&callback](const Vec<u8>& compressed_vec) {
-        val compressed = CloneAsTypedArray(compressed_vec);
-        callback(compressed);
+    return stream_.Transform(chunk_vec.data(), chunk_vec.size(), [&callback](const Vec<u8>& compressed_vec) {
+        write_to_js_callback(callback, compressed_vec, compressed_vec.size());
     });
 }
 
 
+val ZstdCompressStreamBinding::InputBuffer(usize size)
+{
+    // NOTE: buffer is owned by the stream and reused, the view is valid until next `InputBuffer` call.
+    if (input_.size() < size) input_.resize(size);
+    return val(typed_memory_view(size, input_.data()));
+}
+
+
+bool ZstdCompressStreamBinding::TransformInput(usize size, val callback)
+{
+    if (size > input_.size()) return false;
+
+    return stream_.Transform(input_.data(), size, [&callback](const Vec<u8>& compressed_vec) {
+        write_to_js_callback(callback, compressed_vec, compressed_vec.size());
+    });
+}
+
+
+double ZstdCompressStreamBinding::MemoryUsage() const
+{
+    return static_cast<double>(stream_.MemoryUsage() + input_.capacity());
+}
+
+
 bool ZstdCompressStreamBinding::Flush(val callback)
 {
     return stream_.Flush([&callback](const Vec<u8>& compressed_vec) {
-        val compressed = CloneAsTypedArray(compressed_vec);
-        callback(compressed);
+        write_to_js_callback(callback, compressed_vec, compressed_vec.size());
     });
 }
 
@@ -242,8 +802,7 @@ bool ZstdCompressStreamBinding::Flush(val callback)
 bool ZstdCompressStreamBinding::End(val callback)
 {
     return stream_.End([&callback](const Vec<u8>& compressed_vec) {
-        val compressed = CloneAsTypedArray(compressed_vec);
-        callback(compressed);
+        write_to_js_callback(callback, compressed_vec, compressed_vec.size());
     });
 }
 
@@ -259,6 +818,18 @@ ZstdDecompressStreamBinding::ZstdDecompressStreamBinding()
 }
 
 
+ZstdDecompressStreamBinding::ZstdDecompressStreamBinding(const ZstdAllocatorBinding& allocator)
+    : stream_(allocator.allocator)
+{
+}
+
+
+ZstdDecompressStreamBinding::ZstdDecompressStreamBinding(ZstdWorkspace workspace)
+    : stream_(std::move(workspace))
+{
+}
+
+
 ZstdDecompressStreamBinding::~ZstdDecompressStreamBinding()
 {
 }
@@ -276,36 +847,64 @@ bool ZstdDecompressStreamBinding::BeginUsingDict(const ZstdDecompressionDict& dd
 }
 
 
-int ZstdDecompressStreamBinding::Transform(val chunk, int chunk_offset, int pos, val callback)
+bool ZstdDecompressStreamBinding::BeginUsingRegistry(const ZstdDictRegistry& registry)
+{
+    return stream_.Begin(registry);
+}
+
+
+bool ZstdDecompressStreamBinding::Transform(val chunk, val callback)
 {
     // use local vector to ensure thread-safety
     Vec<u8> chunk_vec;
     CloneToVector(chunk_vec, chunk);
 
-    return stream_.Transform(chunk_vec, chunk_offset, pos, [&callback](const Vec<u8>& decompressed_vec) {
-        val decompressed = CloneAsTypedArray(decompressed_vec);
-        callback(decompressed);
+    return stream_.Transform(chunk_vec.data(), chunk_vec.size(), [&callback](const Vec<u8>& decompressed_vec) {
+        write_to_js_callback(callback, decompressed_vec, decompressed_vec.size());
     });
 }
 
 
+val ZstdDecompressStreamBinding::InputBuffer(usize size)
+{
+    // NOTE: buffer is owned by the stream and reused, the view is valid until next `InputBuffer` call.
+    if (input_.size() < size) input_.resize(size);
+    return val(typed_memory_view(size, input_.data()));
+}
+
+
+bool ZstdDecompressStreamBinding::TransformInput(usize size, val callback)
+{
+    if (size > input_.size()) return false;
+
+    return stream_.Transform(input_.data(), size, [&callback](const Vec<u8>& decompressed_vec) {
+        write_to_js_callback(callback, decompressed_vec, decompressed_vec.size());
+    });
+}
+
+
+double ZstdDecompressStreamBinding::MemoryUsage() const
+{
+    return static_cast<double>(stream_.MemoryUsage() + input_.capacity());
+}
+
+
 bool ZstdDecompressStreamBinding::Flush(val callback)
 {
     return stream_.Flush([&callback](const Vec<u8>& decompressed_vec) {
-        val decompressed = CloneAsTypedArray(decompressed_vec);
-        callback(decompressed);
+        write_to_js_callback(callback, decompressed_vec, decompressed_vec.size());
     });
 }
 
 
-bool ZstdDecompressStreamBinding::End(int pos, val callback)
+bool ZstdDecompressStreamBinding::End(val callback)
 {
-    return stream_.End(pos, [&callback](const Vec<u8>& decompressed_vec) {
-        val decompressed = CloneAsTypedArray(decompressed_vec);
-        callback(decompressed);
+    return stream_.End([&callback](const Vec<u8>& decompressed_vec) {
+        write_to_js_callback(callback, decompressed_vec, decompressed_vec.size());
     });
 }
 
+
 //
 // ZstdDecompressReadBinding
 //
@@ -317,6 +916,18 @@ ZstdDecompressReadBinding::ZstdDecompressReadBinding()
 }
 
 
+ZstdDecompressReadBinding::ZstdDecompressReadBinding(const ZstdAllocatorBinding& allocator)
+    : stream_(allocator.allocator)
+{
+}
+
+
+ZstdDecompressReadBinding::ZstdDecompressReadBinding(ZstdWorkspace workspace)
+    : stream_(std::move(workspace))
+{
+}
+
+
 ZstdDecompressReadBinding::~ZstdDecompressReadBinding()
 {
 }
@@ -334,28 +945,59 @@ bool ZstdDecompressReadBinding::BeginUsingDict(const ZstdDecompressionDict& ddic
 }
 
 
+bool ZstdDecompressReadBinding::BeginUsingRegistry(const ZstdDictRegistry& registry)
+{
+    return stream_.Begin(registry);
+}
+
+
 bool ZstdDecompressReadBinding::Load(val chunk)
 {
-    Vec<u8> chunk_vec;
-    CloneToVector(chunk_vec, chunk);
+    // NOTE: `chunk_` is referenced until the stream consumes it.
+    if (stream_.HasInput()) return false;
 
-    return stream_.Load(chunk_vec);
+    CloneToVector(chunk_, chunk);
+    return stream_.Load(chunk_.data(), chunk_.size());
 }
 
 bool ZstdDecompressReadBinding::Read(val callback)
 {
 
     return stream_.Read([&callback](const Vec<u8>& decompressed_vec) {
-        val decompressed = CloneAsTypedArray(decompressed_vec);
-        callback(decompressed);
+        write_to_js_callback(callback, decompressed_vec, decompressed_vec.size());
     });
 }
 
+
+double ZstdDecompressReadBinding::ReadInto(val dest)
+{
+    const auto capacity = dest["length"].as<usize>();
+    if (output_.size() < capacity) output_.resize(capacity);
+
+    const auto read_size = stream_.Read(output_.data(), capacity);
+    if (read_size > 0) {
+        dest.call<void>("set", val(typed_memory_view(static_cast<usize>(read_size), output_.data())));
+    }
+
+    return static_cast<double>(read_size);
+}
+
+
+bool ZstdDecompressReadBinding::HasInput() const
+{
+    return stream_.HasInput();
+}
+
+
+double ZstdDecompressReadBinding::MemoryUsage() const
+{
+    return static_cast<double>(stream_.MemoryUsage() + chunk_.capacity() + output_.capacity());
+}
+
 bool ZstdDecompressReadBinding::Flush(val callback)
 {
     return stream_.Flush([&callback](const Vec<u8>& decompressed_vec) {
-        val decompressed = CloneAsTypedArray(decompressed_vec);
-        callback(decompressed);
+        write_to_js_callback(callback, decompressed_vec, decompressed_vec.size());
     });
 }
 
@@ -363,11 +1005,163 @@ bool ZstdDecompressReadBinding::Flush(val callback)
 bool ZstdDecompressReadBinding::End(val callback) //FIX THIS
 {
     return stream_.End([&callback](const Vec<u8>& decompressed_vec) {
-        val decompressed = CloneAsTypedArray(decompressed_vec);
-        callback(decompressed);
+        write_to_js_callback(callback, decompressed_vec, decompressed_vec.size());
+    });
+}
+
+
+//
+// ZstdSeekableCompressStreamBinding
+//
+///////////////////////////////////////////////////////////////////////////////
+
+ZstdSeekableCompressStreamBinding::ZstdSeekableCompressStreamBinding()
+    : stream_()
+    , input_()
+{
+}
+
+
+ZstdSeekableCompressStreamBinding::~ZstdSeekableCompressStreamBinding()
+{
+}
+
+
+bool ZstdSeekableCompressStreamBinding::Begin(int compression_level, double max_frame_size, bool checksum_flag)
+{
+    return stream_.Begin(compression_level, static_cast<usize>(max_frame_size), checksum_flag);
+}
+
+
+bool ZstdSeekableCompressStreamBinding::BeginUsingParams(const ZstdCompressionParams& params, double max_frame_size)
+{
+    return stream_.Begin(params, static_cast<usize>(max_frame_size));
+}
+
+
+bool ZstdSeekableCompressStreamBinding::Transform(val chunk, val callback)
+{
+    Vec<u8> chunk_vec;
+    CloneToVector(chunk_vec, chunk);
+
+    return stream_.Transform(chunk_vec.data(), chunk_vec.size(), [&callback](const Vec<u8>& compressed_vec) {
+        write_to_js_callback(callback, compressed_vec, compressed_vec.size());
+    });
+}
+
+
+val ZstdSeekableCompressStreamBinding::InputBuffer(usize size)
+{
+    // NOTE: buffer is owned by the stream and reused, the view is valid until next `InputBuffer` call.
+    if (input_.size() < size) input_.resize(size);
+    return val(typed_memory_view(size, input_.data()));
+}
+
+
+bool ZstdSeekableCompressStreamBinding::TransformInput(usize size, val callback)
+{
+    if (size > input_.size()) return false;
+
+    return stream_.Transform(input_.data(), size, [&callback](const Vec<u8>& compressed_vec) {
+        write_to_js_callback(callback, compressed_vec, compressed_vec.size());
+    });
+}
+
+
+bool ZstdSeekableCompressStreamBinding::EndFrame(val callback)
+{
+    return stream_.EndFrame([&callback](const Vec<u8>& compressed_vec) {
+        write_to_js_callback(callback, compressed_vec, compressed_vec.size());
+    });
+}
+
+
+bool ZstdSeekableCompressStreamBinding::End(val callback)
+{
+    return stream_.End([&callback](const Vec<u8>& compressed_vec) {
+        write_to_js_callback(callback, compressed_vec, compressed_vec.size());
+    });
+}
+
+
+double ZstdSeekableCompressStreamBinding::FrameCount() const
+{
+    return static_cast<double>(stream_.FrameCount());
+}
+
+
+//
+// ZstdSeekableReaderBinding
+//
+///////////////////////////////////////////////////////////////////////////////
+
+ZstdSeekableReaderBinding::ZstdSeekableReaderBinding()
+    : reader_()
+    , src_bytes_()
+    , source_(val::undefined())
+{
+}
+
+
+ZstdSeekableReaderBinding::~ZstdSeekableReaderBinding()
+{
+}
+
+
+bool ZstdSeekableReaderBinding::Open(val src_bytes)
+{
+    Close();
+    CloneToVector(src_bytes_, src_bytes);
+
+    return reader_.Open(src_bytes_.data(), src_bytes_.size());
+}
+
+
+bool ZstdSeekableReaderBinding::OpenUsingSource(double src_size, val source)
+{
+    Close();
+    source_ = source;
+
+    return reader_.Open(static_cast<u64>(src_size), [this](u64 offset, usize size, Vec<u8>& dest) {
+        // NOTE: source returns null (or nothing) on failure.
+        const auto bytes = source_(static_cast<double>(offset), static_cast<double>(size));
+        if (bytes.isNull() || bytes.isUndefined()) return false;
+
+        CloneToVector(dest, bytes);
+        return true;
     });
 }
 
+
+void ZstdSeekableReaderBinding::Close()
+{
+    reader_.Close();
+    src_bytes_.clear();
+    source_ = val::undefined();
+}
+
+
+double ZstdSeekableReaderBinding::FrameCount() const
+{
+    return static_cast<double>(reader_.FrameCount());
+}
+
+
+double ZstdSeekableReaderBinding::ContentSize() const
+{
+    return static_cast<double>(reader_.ContentSize());
+}
+
+
+val ZstdSeekableReaderBinding::Read(double offset, double size)
+{
+    Vec<u8> dest;
+    const auto rc = reader_.Read(dest, static_cast<u64>(offset), static_cast<usize>(size));
+    if (rc < 0) return val::null();
+
+    return CloneAsTypedArray(dest);
+}
+
 // ---- bindings --------------------------------------------------------------
 
 EMSCRIPTEN_BINDINGS(zstd) {
@@ -378,39 +1172,192 @@ EMSCRIPTEN_BINDINGS(zstd) {
     function("cloneAsTypedArray", &CloneAsTypedArray);
     function("toTypedArrayView", &ToTypedArrayView);
 
-    class_<ZstdCompressionDict>("ZstdCompressionDict");
+    class_<ZstdCompressionDict>("ZstdCompressionDict")
+        .function("memoryUsage", &CompressionDictMemoryUsage)
+        .class_function("estimateMemory", &CompressionDictEstimateMemory)
+        ;
     function("createCompressionDict", &CreateCompressionDict, allow_raw_pointers());
 
-    class_<ZstdDecompressionDict>("ZstdDecompressionDict");
+    class_<ZstdDecompressionDict>("ZstdDecompressionDict")
+        .function("memoryUsage", &DecompressionDictMemoryUsage)
+        .class_function("estimateMemory", &DecompressionDictEstimateMemory)
+        ;
     function("createDecompressionDict", &CreateDecompressionDict, allow_raw_pointers());
 
+    class_<ZstdAllocatorBinding>("ZstdAllocator")
+        .function("currentBytes", &AllocatorCurrentBytes)
+        .function("peakBytes", &AllocatorPeakBytes)
+        .function("reservedBytes", &AllocatorReservedBytes)
+        .function("resetPeak", &AllocatorResetPeak)
+        .function("trim", &AllocatorTrim)
+        ;
+    function("createMallocAllocator", &CreateMallocAllocator, allow_raw_pointers());
+    function("createArenaAllocator", &CreateArenaAllocator, allow_raw_pointers());
+    function("createPoolAllocator", &CreatePoolAllocator, allow_raw_pointers());
+
+    class_<ZstdCompressionParams>("ZstdCompressionParams")
+        .constructor<>()
+        .property("compressionLevel", &ZstdCompressionParams::compression_level)
+        .property("windowLog", &ZstdCompressionParams::window_log)
+        .property("hashLog", &ZstdCompressionParams::hash_log)
+        .property("chainLog", &ZstdCompressionParams::chain_log)
+        .property("searchLog", &ZstdCompressionParams::search_log)
+        .property("minMatch", &ZstdCompressionParams::min_match)
+        .property("targetLength", &ZstdCompressionParams::target_length)
+        .property("strategy", &ZstdCompressionParams::strategy)
+        .property("enableLongDistanceMatching", &ZstdCompressionParams::enable_long_distance_matching)
+        .property("checksumFlag", &ZstdCompressionParams::checksum_flag)
+        .property("contentSizeFlag", &ZstdCompressionParams::content_size_flag)
+        .property("nbWorkers", &ZstdCompressionParams::nb_workers)
+        ;
+
+    class_<ZstdDictTrainingParams>("ZstdDictTrainingParams")
+        .constructor<>()
+        .property("k", &ZstdDictTrainingParams::k)
+        .property("d", &ZstdDictTrainingParams::d)
+        .property("f", &ZstdDictTrainingParams::f)
+        .property("steps", &ZstdDictTrainingParams::steps)
+        .property("accel", &ZstdDictTrainingParams::accel)
+        .property("nbThreads", &ZstdDictTrainingParams::nb_threads)
+        .property("splitPoint", &ZstdDictTrainingParams::split_point)
+        .property("compressionLevel", &ZstdDictTrainingParams::compression_level)
+        ;
+
+    class_<ZstdDictTrainer>("ZstdDictTrainer")
+        .constructor<>()
+        .function("addSample", &DictTrainerAddSample)
+        .function("clear", &ZstdDictTrainer::Clear)
+        .function("sampleCount", &DictTrainerSampleCount)
+        .function("samplesSize", &DictTrainerSamplesSize)
+        .function("train", &DictTrainerTrain)
+        .function("trainCover", &DictTrainerTrainCover)
+        .function("trainFastCover", &DictTrainerTrainFastCover)
+        .class_function("dictID", &ZstdDictTrainer::DictID)
+        ;
+
+    class_<ZstdDictRegistry>("ZstdDictRegistry")
+        .constructor<>()
+        .function("add", &DictRegistryAdd)
+        .function("remove", &ZstdDictRegistry::Remove)
+        .function("clear", &ZstdDictRegistry::Clear)
+        .function("count", &DictRegistryCount)
+        .function("contains", &ZstdDictRegistry::Contains)
+        ;
+
+    class_<ZstdCDictCache>("ZstdCDictCache")
+        .constructor<>()
+        .function("addDict", &CDictCacheAddDict)
+        .function("removeDict", &CDictCacheRemoveDict)
+        .function("containsDict", &CDictCacheContainsDict)
+        .function("clear", &ZstdCDictCache::Clear)
+        .function("digestedCount", &CDictCacheDigestedCount)
+        .function("memoryUsage", &CDictCacheMemoryUsage)
+        .function("memoryBudget", &CDictCacheMemoryBudget)
+        .function("setMemoryBudget", &CDictCacheSetMemoryBudget)
+        ;
+
     class_<ZstdCodec>("ZstdCodec")
         .constructor<>()
-        .function("compressBound", &ZstdCodec::CompressBound)
-        .function("contentSize", &ZstdCodec::ContentSize)
-        .function("compress", &ZstdCodec::Compress)
-        .function("decompress", &ZstdCodec::Decompress)
-        .function("compressUsingDict", &ZstdCodec::CompressUsingDict)
-        .function("decompressUsingDict", &ZstdCodec::DecompressUsingDict)
+        .constructor(&CreateCodecUsingAllocator, allow_raw_pointers())
+        .constructor(&CreateStaticCodec, allow_raw_pointers())
+        .function("compressBound", &CodecCompressBound)
+        .function("contentSize", &CodecContentSize)
+        .function("framesContentSize", &CodecFramesContentSize)
+        .function("compress", &CodecCompress)
+        .function("compress", &CodecCompressWithWorkers)
+        .function("compressUsingParams", &CodecCompressUsingParams)
+        .function("compressParallel", &CodecCompressParallel)
+        .function("compressParallelUsingParams", &CodecCompressParallelUsingParams)
+        .function("decompress", &CodecDecompress)
+        .function("decompressParallel", &CodecDecompressParallel)
+        .function("compressUsingDict", &CodecCompressUsingDict)
+        .function("compressUsingCache", &CodecCompressUsingCache)
+        .function("decompressUsingDict", &CodecDecompressUsingDict)
+        .function("decompressUsingRegistry", &CodecDecompressUsingRegistry)
+        .function("compressBatch", &CodecCompressBatch)
+        .function("decompressBatch", &CodecDecompressBatch)
+        .function("releaseContexts", &ZstdCodec::ReleaseContexts)
+        .class_function("maxWorkers", &ZstdCodec::MaxWorkers)
+        .class_function("staticCompressWorkspaceSize", &CodecStaticCompressWorkspaceSize)
+        .class_function("staticDecompressWorkspaceSize", &CodecStaticDecompressWorkspaceSize)
+        .class_function("estimateCompressMemory", &CodecEstimateCompressMemory)
+        .class_function("estimateCompressMemoryUsingParams", &CodecEstimateCompressMemoryUsingParams)
+        .class_function("estimateDecompressMemory", &CodecEstimateDecompressMemory)
+        .function("memoryUsage", &CodecMemoryUsage)
         ;
 
     class_<ZstdCompressStreamBinding>("ZstdCompressStreamBinding")
         .constructor<>()
-        .function("begin", &ZstdCompressStreamBinding::Begin)
+        .constructor(&NewStreamBinding<ZstdCompressStreamBinding>, allow_raw_pointers())
+        .function("begin", select_overload<bool(int)>(&ZstdCompressStreamBinding::Begin))
+        .function("begin", select_overload<bool(int, int)>(&ZstdCompressStreamBinding::Begin))
+        .function("beginUsingParams", &ZstdCompressStreamBinding::BeginUsingParams)
         .function("beginUsingDict", &ZstdCompressStreamBinding::BeginUsingDict)
+        .function("beginUsingCache", &ZstdCompressStreamBinding::BeginUsingCache)
         .function("transform", &ZstdCompressStreamBinding::Transform)
+        .function("inputBuffer", &ZstdCompressStreamBinding::InputBuffer)
+        .function("transformInput", &ZstdCompressStreamBinding::TransformInput)
         .function("flush", &ZstdCompressStreamBinding::Flush)
         .function("end", &ZstdCompressStreamBinding::End)
+        .class_function("staticWorkspaceSize", &CompressStreamStaticWorkspaceSize)
+        .class_function("estimateMemory", &CompressStreamEstimateMemory)
+        .class_function("estimateMemoryUsingParams", &CompressStreamEstimateMemoryUsingParams)
+        .function("memoryUsage", &ZstdCompressStreamBinding::MemoryUsage)
+        ;
+
+    class_<ZstdDecompressStreamBinding>("ZstdDecompressStreamBinding")
+        .constructor<>()
+        .constructor(&NewStreamBinding<ZstdDecompressStreamBinding>, allow_raw_pointers())
+        .function("begin", &ZstdDecompressStreamBinding::Begin)
+        .function("beginUsingDict", &ZstdDecompressStreamBinding::BeginUsingDict)
+        .function("beginUsingRegistry", &ZstdDecompressStreamBinding::BeginUsingRegistry)
+        .function("transform", &ZstdDecompressStreamBinding::Transform)
+        .function("inputBuffer", &ZstdDecompressStreamBinding::InputBuffer)
+        .function("transformInput", &ZstdDecompressStreamBinding::TransformInput)
+        .function("flush", &ZstdDecompressStreamBinding::Flush)
+        .function("end", &ZstdDecompressStreamBinding::End)
+        .class_function("staticWorkspaceSize", &DecompressStreamStaticWorkspaceSize)
+        .class_function("estimateMemory", &DecompressStreamEstimateMemory)
+        .function("memoryUsage", &ZstdDecompressStreamBinding::MemoryUsage)
         ;
 
     class_<ZstdDecompressReadBinding>("ZstdDecompressReadBinding")
         .constructor<>()
+        .constructor(&NewStreamBinding<ZstdDecompressReadBinding>, allow_raw_pointers())
         .function("begin", &ZstdDecompressReadBinding::Begin)
         .function("beginUsingDict", &ZstdDecompressReadBinding::BeginUsingDict)
+        .function("beginUsingRegistry", &ZstdDecompressReadBinding::BeginUsingRegistry)
         .function("load", &ZstdDecompressReadBinding::Load)
         .function("read", &ZstdDecompressReadBinding::Read)
+        .function("readInto", &ZstdDecompressReadBinding::ReadInto)
+        .function("hasInput", &ZstdDecompressReadBinding::HasInput)
         .function("flush", &ZstdDecompressReadBinding::Flush)
         .function("end", &ZstdDecompressReadBinding::End)
+        .class_function("staticWorkspaceSize", &DecompressReadStaticWorkspaceSize)
+        .class_function("estimateMemory", &DecompressReadEstimateMemory)
+        .function("memoryUsage", &ZstdDecompressReadBinding::MemoryUsage)
+        ;
+
+    class_<ZstdSeekableCompressStreamBinding>("ZstdSeekableCompressStreamBinding")
+        .constructor<>()
+        .function("begin", &ZstdSeekableCompressStreamBinding::Begin)
+        .function("beginUsingParams", &ZstdSeekableCompressStreamBinding::BeginUsingParams)
+        .function("transform", &ZstdSeekableCompressStreamBinding::Transform)
+        .function("inputBuffer", &ZstdSeekableCompressStreamBinding::InputBuffer)
+        .function("transformInput", &ZstdSeekableCompressStreamBinding::TransformInput)
+        .function("endFrame", &ZstdSeekableCompressStreamBinding::EndFrame)
+        .function("end", &ZstdSeekableCompressStreamBinding::End)
+        .function("frameCount", &ZstdSeekableCompressStreamBinding::FrameCount)
+        ;
+
+    class_<ZstdSeekableReaderBinding>("ZstdSeekableReaderBinding")
+        .constructor<>()
+        .function("open", &ZstdSeekableReaderBinding::Open)
+        .function("openUsingSource", &ZstdSeekableReaderBinding::OpenUsingSource)
+        .function("close", &ZstdSeekableReaderBinding::Close)
+        .function("frameCount", &ZstdSeekableReaderBinding::FrameCount)
+        .function("contentSize", &ZstdSeekableReaderBinding::ContentSize)
+        .function("read", &ZstdSeekableReaderBinding::Read)
         ;
 }
 
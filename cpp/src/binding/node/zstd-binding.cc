@@ -0,0 +1,2492 @@
+#include <node_api.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <new>
+
+#include "../../zstd-allocator.h"
+#include "../../zstd-cdict-cache.h"
+#include "../../zstd-codec.h"
+#include "../../zstd-dict.h"
+#include "../../zstd-dict-registry.h"
+#include "../../zstd-dict-trainer.h"
+#include "../../zstd-params.h"
+#include "../../zstd-seekable.h"
+#include "../../zstd-stream.h"
+#include "../../zstd-read.h"
+
+/*
+Node-API binding, exports the same objects as the Emscripten binding
+(see ../emscripten/zstd-binding.cc), so that js/lib can use both of them.
+
+objects are released by `delete()` as with embind, or by GC.
+*/
+
+
+// allocator bindings (declarations)
+
+// NOTE: objects created with the allocator share it, it lives until all of them are deleted.
+class ZstdAllocatorBinding
+{
+public:
+    std::shared_ptr<ZstdAllocator>  allocator;
+};
+
+
+// stream bindings (declarations)
+
+class ZstdCompressStreamBinding
+{
+public:
+    ZstdCompressStreamBinding() = default;
+    explicit ZstdCompressStreamBinding(std::shared_ptr<ZstdAllocator> allocator) : stream(std::move(allocator)) {}
+    explicit ZstdCompressStreamBinding(ZstdWorkspace workspace) : stream(std::move(workspace)) {}
+
+    ZstdCompressStream  stream;
+};
+
+
+class ZstdDecompressStreamBinding
+{
+public:
+    ZstdDecompressStreamBinding() = default;
+    explicit ZstdDecompressStreamBinding(std::shared_ptr<ZstdAllocator> allocator) : stream(std::move(allocator)) {}
+    explicit ZstdDecompressStreamBinding(ZstdWorkspace workspace) : stream(std::move(workspace)) {}
+
+    ZstdDecompressStream    stream;
+};
+
+
+class ZstdDecompressReadBinding
+{
+public:
+    ZstdDecompressReadBinding() = default;
+    explicit ZstdDecompressReadBinding(std::shared_ptr<ZstdAllocator> allocator) : stream(std::move(allocator)) {}
+    explicit ZstdDecompressReadBinding(ZstdWorkspace workspace) : stream(std::move(workspace)) {}
+
+    ZstdDecompressRead  stream;
+    Vec<u8>             chunk;      // loaded chunk, referenced by the stream
+};
+
+
+class ZstdSeekableCompressStreamBinding
+{
+public:
+    ZstdSeekableCompressStream  stream;
+};
+
+
+// NOTE: JS source `(offset, size) => Uint8Array` is called back while the reader reads.
+class ZstdSeekableReaderBinding
+{
+public:
+    ~ZstdSeekableReaderBinding()
+    {
+        if (source != nullptr) napi_delete_reference(env, source);
+    }
+
+    ZstdSeekableReader  reader;
+    Vec<u8>             src_bytes;          // copy of compressed data, unless opened with a source
+    napi_env            env = nullptr;
+    napi_ref            source = nullptr;
+};
+
+
+// ==== IMPLEMENTATIONS =======================================================
+//
+
+#define NAPI_CALL(env, call)                                    \
+    do {                                                        \
+        if ((call) != napi_ok) {                                \
+            ThrowLastError(env);                                \
+            return nullptr;                                     \
+        }                                                       \
+    } while (0)
+
+
+static void ThrowLastError(napi_env env)
+{
+    bool pending = false;
+    napi_is_exception_pending(env, &pending);
+    if (pending) return;
+
+    const napi_extended_error_info* info = nullptr;
+    napi_get_last_error_info(env, &info);
+
+    const auto message = (info != nullptr && info->error_message != nullptr)
+        ? info->error_message
+        : "zstd-codec: unknown N-API error";
+    napi_throw_error(env, nullptr, message);
+}
+
+
+static napi_value Undefined(napi_env env)
+{
+    napi_value result = nullptr;
+    napi_get_undefined(env, &result);
+    return result;
+}
+
+
+static napi_value FromBool(napi_env env, bool value)
+{
+    napi_value result = nullptr;
+    napi_get_boolean(env, value, &result);
+    return result;
+}
+
+
+static napi_value FromInt(napi_env env, int value)
+{
+    napi_value result = nullptr;
+    napi_create_int32(env, value, &result);
+    return result;
+}
+
+
+static napi_value FromInt64(napi_env env, i64 value)
+{
+    napi_value result = nullptr;
+    napi_create_int64(env, value, &result);
+    return result;
+}
+
+
+static napi_value FromDouble(napi_env env, double value)
+{
+    napi_value result = nullptr;
+    napi_create_double(env, value, &result);
+    return result;
+}
+
+
+static int ToInt(napi_env env, napi_value value)
+{
+    int32_t result = 0;
+    napi_get_value_int32(env, value, &result);
+    return result;
+}
+
+
+static bool ToBool(napi_env env, napi_value value)
+{
+    bool result = false;
+    napi_coerce_to_bool(env, value, &value);
+    napi_get_value_bool(env, value, &result);
+    return result;
+}
+
+
+static double ToDouble(napi_env env, napi_value value)
+{
+    double result = 0.0;
+    napi_get_value_double(env, value, &result);
+    return result;
+}
+
+
+static bool IsUndefined(napi_env env, napi_value value)
+{
+    napi_valuetype type = napi_undefined;
+    napi_typeof(env, value, &type);
+    return type == napi_undefined;
+}
+
+
+struct Arguments
+{
+    static const size_t MAX_ARGS = 5;
+
+    napi_value  self;
+    size_t      count;
+    napi_value  values[MAX_ARGS];
+    void*       data;
+
+    napi_value operator[](size_t i) const { return values[i]; }
+};
+
+
+static bool GetArguments(napi_env env, napi_callback_info info, Arguments& args)
+{
+    args.count = Arguments::MAX_ARGS;
+    const auto status = napi_get_cb_info(env, info, &args.count, args.values, &args.self, &args.data);
+    if (status != napi_ok) {
+        ThrowLastError(env);
+        return false;
+    }
+
+    // NOTE: missing arguments are `undefined`, as JavaScript functions.
+    napi_value undefined = Undefined(env);
+    for (auto i = args.count; i < Arguments::MAX_ARGS; ++i) {
+        args.values[i] = undefined;
+    }
+
+    return true;
+}
+
+
+// borrowed bytes of a TypedArray/Buffer, valid while the JS object is alive.
+struct ByteSpan
+{
+    const u8*   data;
+    usize       size;
+};
+
+
+static bool GetByteSpan(napi_env env, napi_value value, ByteSpan& span)
+{
+    bool is_typedarray = false;
+    napi_is_typedarray(env, value, &is_typedarray);
+    if (!is_typedarray) {
+        napi_throw_type_error(env, nullptr, "zstd-codec: Uint8Array is required");
+        return false;
+    }
+
+    napi_typedarray_type type;
+    size_t length = 0;
+    void* data = nullptr;
+    napi_value buffer = nullptr;
+    size_t byte_offset = 0;
+    napi_get_typedarray_info(env, value, &type, &length, &data, &buffer, &byte_offset);
+    if (type != napi_uint8_array) {
+        napi_throw_type_error(env, nullptr, "zstd-codec: Uint8Array is required");
+        return false;
+    }
+
+    span.data = static_cast<const u8*>(data);
+    span.size = length;
+    return true;
+}
+
+
+// writable elements of a Uint32Array, valid while the JS object is alive.
+struct OffsetSpan
+{
+    u32*    data;
+    usize   size;
+};
+
+
+static bool GetOffsetSpan(napi_env env, napi_value value, OffsetSpan& span)
+{
+    bool is_typedarray = false;
+    napi_is_typedarray(env, value, &is_typedarray);
+
+    napi_typedarray_type type = napi_int8_array;
+    size_t length = 0;
+    void* data = nullptr;
+    if (is_typedarray) {
+        napi_value buffer = nullptr;
+        size_t byte_offset = 0;
+        napi_get_typedarray_info(env, value, &type, &length, &data, &buffer, &byte_offset);
+    }
+
+    if (type != napi_uint32_array) {
+        napi_throw_type_error(env, nullptr, "zstd-codec: Uint32Array is required");
+        return false;
+    }
+
+    span.data = static_cast<u32*>(data);
+    span.size = length;
+    return true;
+}
+
+
+static napi_value CopyAsTypedArray(napi_env env, const u8* bytes, usize size)
+{
+    void* data = nullptr;
+    napi_value buffer = nullptr;
+    NAPI_CALL(env, napi_create_arraybuffer(env, size, &data, &buffer));
+    if (size > 0) std::memcpy(data, bytes, size);
+
+    napi_value array = nullptr;
+    NAPI_CALL(env, napi_create_typedarray(env, napi_uint8_array, size, buffer, 0, &array));
+    return array;
+}
+
+
+// ---- object wrapping --------------------------------------------------------
+
+static uint64_t NextTypeTagId()
+{
+    static uint64_t next_id = 0;
+    return ++next_id;
+}
+
+
+template <typename T>
+static const napi_type_tag* TypeTagOf()
+{
+    static const napi_type_tag tag = { 0x7a737464636f6465ULL, NextTypeTagId() };     // "zstdcode"
+    return &tag;
+}
+
+
+template <typename T>
+static void Finalize(napi_env env, void* data, void* hint)
+{
+    delete static_cast<T*>(data);
+}
+
+
+template <typename T>
+static bool Wrap(napi_env env, napi_value object, T* native)
+{
+    if (napi_wrap(env, object, native, Finalize<T>, nullptr, nullptr) != napi_ok) {
+        delete native;
+        ThrowLastError(env);
+        return false;
+    }
+
+    napi_type_tag_object(env, object, TypeTagOf<T>());
+    return true;
+}
+
+
+template <typename T>
+static T* Unwrap(napi_env env, napi_value object)
+{
+    bool matched = false;
+    napi_check_object_type_tag(env, object, TypeTagOf<T>(), &matched);
+
+    void* native = nullptr;
+    if (!matched || napi_unwrap(env, object, &native) != napi_ok || native == nullptr) {
+        napi_throw_type_error(env, nullptr, "zstd-codec: invalid or deleted object");
+        return nullptr;
+    }
+
+    return static_cast<T*>(native);
+}
+
+
+template <typename T>
+static napi_value Construct(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto native = new (std::nothrow) T();
+    if (native == nullptr) {
+        napi_throw_error(env, nullptr, "zstd-codec: failed to allocate object");
+        return nullptr;
+    }
+
+    if (!Wrap(env, args.self, native)) return nullptr;
+    return args.self;
+}
+
+
+// NOTE: dictionaries have no default constructor, those are created by factory functions.
+template <typename T>
+static napi_value ConstructByFactoryOnly(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    napi_valuetype type = napi_undefined;
+    napi_typeof(env, args[0], &type);
+    if (type != napi_external) {
+        napi_throw_type_error(env, nullptr, "zstd-codec: use factory function to create this object");
+        return nullptr;
+    }
+
+    void* external = nullptr;
+    napi_get_value_external(env, args[0], &external);
+    if (!Wrap(env, args.self, static_cast<T*>(external))) return nullptr;
+    return args.self;
+}
+
+
+template <typename T>
+static napi_value WrapConstructed(napi_env env, napi_value self, T* native)
+{
+    if (native == nullptr) {
+        napi_throw_error(env, nullptr, "zstd-codec: failed to allocate object");
+        return nullptr;
+    }
+
+    if (!Wrap(env, self, native)) return nullptr;
+    return self;
+}
+
+
+static bool GetAllocator(napi_env env, napi_value value, std::shared_ptr<ZstdAllocator>& allocator)
+{
+    if (IsUndefined(env, value)) return true;
+
+    auto binding = Unwrap<ZstdAllocatorBinding>(env, value);
+    if (binding == nullptr) return false;
+
+    allocator = binding->allocator;
+    return true;
+}
+
+
+static bool IsNumber(napi_env env, napi_value value)
+{
+    napi_valuetype type = napi_undefined;
+    napi_typeof(env, value, &type);
+    return type == napi_number;
+}
+
+
+// NOTE: takes an optional ZstdAllocator, or workspace size of a static stream.
+template <typename T>
+static napi_value ConstructStream(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    if (IsNumber(env, args[0])) {
+        const auto workspace_size = static_cast<usize>(ToDouble(env, args[0]));
+        return WrapConstructed(env, args.self, new (std::nothrow) T(ZstdWorkspace(workspace_size)));
+    }
+
+    std::shared_ptr<ZstdAllocator> allocator;
+    if (!GetAllocator(env, args[0], allocator)) return nullptr;
+
+    return WrapConstructed(env, args.self, new (std::nothrow) T(std::move(allocator)));
+}
+
+
+// NOTE: takes an optional ZstdAllocator, or workspace sizes of static compression and decompression contexts.
+static napi_value ConstructCodec(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    if (IsNumber(env, args[0])) {
+        const auto cctx_workspace_size = static_cast<usize>(ToDouble(env, args[0]));
+        const auto dctx_workspace_size = static_cast<usize>(ToDouble(env, args[1]));
+        return WrapConstructed(env, args.self, new (std::nothrow) ZstdCodec(ZstdWorkspace(cctx_workspace_size),
+                                                                            ZstdWorkspace(dctx_workspace_size)));
+    }
+
+    std::shared_ptr<ZstdAllocator> allocator;
+    if (!GetAllocator(env, args[0], allocator)) return nullptr;
+
+    return WrapConstructed(env, args.self, new (std::nothrow) ZstdCodec(std::move(allocator)));
+}
+
+
+template <typename T>
+static napi_value Delete(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    void* native = nullptr;
+    if (napi_remove_wrap(env, args.self, &native) == napi_ok) {
+        delete static_cast<T*>(native);
+    }
+
+    return Undefined(env);
+}
+
+
+struct AddonData
+{
+    napi_ref    compression_dict_class;
+    napi_ref    decompression_dict_class;
+    napi_ref    allocator_class;
+};
+
+
+static napi_value NewInstance(napi_env env, napi_ref class_ref, void* native)
+{
+    napi_value constructor = nullptr;
+    NAPI_CALL(env, napi_get_reference_value(env, class_ref, &constructor));
+
+    napi_value external = nullptr;
+    NAPI_CALL(env, napi_create_external(env, native, nullptr, nullptr, &external));
+
+    napi_value instance = nullptr;
+    NAPI_CALL(env, napi_new_instance(env, constructor, 1, &external, &instance));
+    return instance;
+}
+
+
+static napi_value DefineClass(napi_env env, napi_value exports, const char* name,
+                              napi_callback constructor,
+                              const napi_property_descriptor* properties, size_t property_count)
+{
+    napi_value klass = nullptr;
+    NAPI_CALL(env, napi_define_class(env, name, NAPI_AUTO_LENGTH, constructor, nullptr,
+                                     property_count, properties, &klass));
+    NAPI_CALL(env, napi_set_named_property(env, exports, name, klass));
+    return klass;
+}
+
+
+static napi_property_descriptor Method(const char* name, napi_callback method)
+{
+    return { name, nullptr, method, nullptr, nullptr, nullptr, napi_default, nullptr };
+}
+
+
+static napi_property_descriptor StaticMethod(const char* name, napi_callback method)
+{
+    return { name, nullptr, method, nullptr, nullptr, nullptr, napi_static, nullptr };
+}
+
+
+// invokes JS callback with a copy of each block, stops calling once JS throws.
+class JsCallback
+{
+public:
+    JsCallback(napi_env env, napi_value callback)
+        : env_(env)
+        , callback_(callback)
+        , failed_(false)
+    {
+    }
+
+    void operator()(const Vec<u8>& bytes)
+    {
+        if (failed_) return;
+
+        napi_value array = CopyAsTypedArray(env_, bytes.data(), bytes.size());
+        if (array == nullptr || napi_call_function(env_, Undefined(env_), callback_, 1, &array, nullptr) != napi_ok) {
+            failed_ = true;
+        }
+    }
+
+    napi_value Result(bool success) const
+    {
+        return failed_ ? nullptr : FromBool(env_, success);
+    }
+
+private:
+    napi_env    env_;
+    napi_value  callback_;
+    bool        failed_;
+};
+
+
+// ---- binding helper functions ----------------------------------------------
+
+static napi_value Dummy(napi_env env, napi_callback_info info)
+{
+    return Undefined(env);
+}
+
+
+static napi_value CloneToVector(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    if (dest == nullptr) return nullptr;
+
+    ByteSpan src;
+    if (!GetByteSpan(env, args[1], src)) return nullptr;
+
+    dest->assign(src.data, src.data + src.size);
+    return Undefined(env);
+}
+
+
+static napi_value CloneAsTypedArray(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto src = Unwrap<Vec<u8>>(env, args[0]);
+    if (src == nullptr) return nullptr;
+
+    return CopyAsTypedArray(env, src->data(), src->size());
+}
+
+
+// NOTE: the view is valid until the vector is resized or deleted.
+static napi_value ToTypedArrayView(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto src = Unwrap<Vec<u8>>(env, args[0]);
+    if (src == nullptr) return nullptr;
+
+    napi_value buffer = nullptr;
+    NAPI_CALL(env, napi_create_external_arraybuffer(env, src->data(), src->size(), nullptr, nullptr, &buffer));
+
+    napi_value array = nullptr;
+    NAPI_CALL(env, napi_create_typedarray(env, napi_uint8_array, src->size(), buffer, 0, &array));
+    return array;
+}
+
+
+// ---- VectorU8 ---------------------------------------------------------------
+
+static napi_value VectorResize(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<Vec<u8>>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    const auto value = IsUndefined(env, args[1]) ? 0 : ToInt(env, args[1]);
+    self->resize(static_cast<usize>(ToDouble(env, args[0])), static_cast<u8>(value));
+    return Undefined(env);
+}
+
+
+static napi_value VectorSize(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<Vec<u8>>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->size()));
+}
+
+
+static napi_value VectorGet(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<Vec<u8>>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    const auto index = static_cast<usize>(ToDouble(env, args[0]));
+    if (index >= self->size()) return Undefined(env);
+
+    return FromInt(env, (*self)[index]);
+}
+
+
+static napi_value VectorSet(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<Vec<u8>>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    const auto index = static_cast<usize>(ToDouble(env, args[0]));
+    if (index >= self->size()) return FromBool(env, false);
+
+    (*self)[index] = static_cast<u8>(ToInt(env, args[1]));
+    return FromBool(env, true);
+}
+
+
+static napi_value VectorPushBack(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<Vec<u8>>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    self->push_back(static_cast<u8>(ToInt(env, args[0])));
+    return Undefined(env);
+}
+
+
+// --- dictionary bindings (implementations) ----------------------------------
+
+static napi_value CreateCompressionDict(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    ByteSpan dict_bytes;
+    if (!GetByteSpan(env, args[0], dict_bytes)) return nullptr;
+
+    AddonData* addon = nullptr;
+    NAPI_CALL(env, napi_get_instance_data(env, reinterpret_cast<void**>(&addon)));
+
+    // NOTE: the dictionary owns the copy and zstd references it, JS bytes can be released.
+    Vec<u8> dict_vec(dict_bytes.data, dict_bytes.data + dict_bytes.size);
+    auto cdict = new ZstdCompressionDict(std::move(dict_vec), ToInt(env, args[1]));
+    return NewInstance(env, addon->compression_dict_class, cdict);
+}
+
+
+static napi_value CreateDecompressionDict(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    ByteSpan dict_bytes;
+    if (!GetByteSpan(env, args[0], dict_bytes)) return nullptr;
+
+    AddonData* addon = nullptr;
+    NAPI_CALL(env, napi_get_instance_data(env, reinterpret_cast<void**>(&addon)));
+
+    Vec<u8> dict_vec(dict_bytes.data, dict_bytes.data + dict_bytes.size);
+    auto ddict = new ZstdDecompressionDict(std::move(dict_vec));
+    return NewInstance(env, addon->decompression_dict_class, ddict);
+}
+
+
+static napi_value CompressionDictMemoryUsage(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCompressionDict>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->MemoryUsage()));
+}
+
+
+static napi_value CompressionDictEstimateMemory(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    const auto dict_size = static_cast<usize>(ToDouble(env, args[0]));
+    return FromDouble(env, static_cast<double>(ZstdCompressionDict::EstimateMemory(dict_size, ToInt(env, args[1]))));
+}
+
+
+static napi_value DecompressionDictMemoryUsage(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressionDict>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->MemoryUsage()));
+}
+
+
+static napi_value DecompressionDictEstimateMemory(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    const auto dict_size = static_cast<usize>(ToDouble(env, args[0]));
+    return FromDouble(env, static_cast<double>(ZstdDecompressionDict::EstimateMemory(dict_size)));
+}
+
+
+// --- allocator bindings (implementations) -----------------------------------
+
+static napi_value NewAllocator(napi_env env, std::shared_ptr<ZstdAllocator> allocator)
+{
+    AddonData* addon = nullptr;
+    NAPI_CALL(env, napi_get_instance_data(env, reinterpret_cast<void**>(&addon)));
+
+    auto binding = new ZstdAllocatorBinding();
+    binding->allocator = std::move(allocator);
+    return NewInstance(env, addon->allocator_class, binding);
+}
+
+
+static napi_value CreateMallocAllocator(napi_env env, napi_callback_info info)
+{
+    return NewAllocator(env, std::make_shared<ZstdMallocAllocator>());
+}
+
+
+static napi_value CreateArenaAllocator(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    const auto capacity = static_cast<usize>(ToDouble(env, args[0]));
+    auto allocator = std::make_shared<ZstdArenaAllocator>(capacity);
+    if (allocator->Capacity() != capacity) {
+        napi_throw_error(env, nullptr, "zstd-codec: failed to reserve arena");
+        return nullptr;
+    }
+
+    return NewAllocator(env, std::move(allocator));
+}
+
+
+static napi_value CreatePoolAllocator(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    const auto max_cached_bytes = IsUndefined(env, args[0])
+        ? ZstdPoolAllocator::DEFAULT_MAX_CACHED_BYTES
+        : static_cast<usize>(ToDouble(env, args[0]));
+    return NewAllocator(env, std::make_shared<ZstdPoolAllocator>(max_cached_bytes));
+}
+
+
+static napi_value AllocatorCurrentBytes(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdAllocatorBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->allocator->CurrentBytes()));
+}
+
+
+static napi_value AllocatorPeakBytes(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdAllocatorBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->allocator->PeakBytes()));
+}
+
+
+static napi_value AllocatorReservedBytes(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdAllocatorBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->allocator->ReservedBytes()));
+}
+
+
+static napi_value AllocatorResetPeak(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdAllocatorBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    self->allocator->ResetPeak();
+    return Undefined(env);
+}
+
+
+static napi_value AllocatorTrim(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdAllocatorBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    self->allocator->Trim();
+    return Undefined(env);
+}
+
+
+// ---- parameter structs ------------------------------------------------------
+
+// exposes a public member of a plain parameter struct as a JS property.
+template <typename T, typename V>
+struct Param
+{
+    const char*     name;
+    V T::*          member;
+};
+
+
+static napi_value FromValue(napi_env env, int value) { return FromInt(env, value); }
+static napi_value FromValue(napi_env env, bool value) { return FromBool(env, value); }
+static napi_value FromValue(napi_env env, double value) { return FromDouble(env, value); }
+
+static void ToValue(napi_env env, napi_value value, int& out) { out = ToInt(env, value); }
+static void ToValue(napi_env env, napi_value value, bool& out) { out = ToBool(env, value); }
+static void ToValue(napi_env env, napi_value value, double& out) { out = ToDouble(env, value); }
+
+
+template <typename T, typename V>
+static napi_value GetParam(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<T>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    const auto param = static_cast<const Param<T, V>*>(args.data);
+    return FromValue(env, self->*(param->member));
+}
+
+
+template <typename T, typename V>
+static napi_value SetParam(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<T>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    const auto param = static_cast<const Param<T, V>*>(args.data);
+    ToValue(env, args[0], self->*(param->member));
+    return Undefined(env);
+}
+
+
+template <typename T, typename V, usize N>
+static void AddParamProperties(Vec<napi_property_descriptor>& properties, const Param<T, V> (&params)[N])
+{
+    for (const auto& param : params) {
+        properties.push_back({ param.name, nullptr, nullptr, GetParam<T, V>, SetParam<T, V>, nullptr, napi_default,
+                               const_cast<Param<T, V>*>(&param) });
+    }
+}
+
+
+// ---- ZstdCompressionParams --------------------------------------------------
+
+static const Param<ZstdCompressionParams, int> COMPRESSION_INT_PARAMS[] = {
+    { "compressionLevel", &ZstdCompressionParams::compression_level },
+    { "windowLog", &ZstdCompressionParams::window_log },
+    { "hashLog", &ZstdCompressionParams::hash_log },
+    { "chainLog", &ZstdCompressionParams::chain_log },
+    { "searchLog", &ZstdCompressionParams::search_log },
+    { "minMatch", &ZstdCompressionParams::min_match },
+    { "targetLength", &ZstdCompressionParams::target_length },
+    { "strategy", &ZstdCompressionParams::strategy },
+    { "nbWorkers", &ZstdCompressionParams::nb_workers },
+};
+
+
+static const Param<ZstdCompressionParams, bool> COMPRESSION_BOOL_PARAMS[] = {
+    { "enableLongDistanceMatching", &ZstdCompressionParams::enable_long_distance_matching },
+    { "checksumFlag", &ZstdCompressionParams::checksum_flag },
+    { "contentSizeFlag", &ZstdCompressionParams::content_size_flag },
+};
+
+
+// ---- ZstdDictTrainingParams -------------------------------------------------
+
+static const Param<ZstdDictTrainingParams, int> TRAINING_INT_PARAMS[] = {
+    { "k", &ZstdDictTrainingParams::k },
+    { "d", &ZstdDictTrainingParams::d },
+    { "f", &ZstdDictTrainingParams::f },
+    { "steps", &ZstdDictTrainingParams::steps },
+    { "accel", &ZstdDictTrainingParams::accel },
+    { "nbThreads", &ZstdDictTrainingParams::nb_threads },
+    { "compressionLevel", &ZstdDictTrainingParams::compression_level },
+};
+
+
+static const Param<ZstdDictTrainingParams, double> TRAINING_DOUBLE_PARAMS[] = {
+    { "splitPoint", &ZstdDictTrainingParams::split_point },
+};
+
+
+// ---- ZstdDictTrainer --------------------------------------------------------
+
+static napi_value DictTrainerAddSample(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictTrainer>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    ByteSpan sample;
+    if (!GetByteSpan(env, args[0], sample)) return nullptr;
+
+    self->AddSample(sample.data, sample.size);
+    return Undefined(env);
+}
+
+
+static napi_value DictTrainerClear(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictTrainer>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    self->Clear();
+    return Undefined(env);
+}
+
+
+static napi_value DictTrainerSampleCount(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictTrainer>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->SampleCount()));
+}
+
+
+static napi_value DictTrainerSamplesSize(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictTrainer>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->SamplesSize()));
+}
+
+
+static napi_value DictTrainerTrain(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictTrainer>(env, args.self);
+    auto dict = Unwrap<Vec<u8>>(env, args[0]);
+    if (self == nullptr || dict == nullptr) return nullptr;
+
+    const auto dict_capacity = static_cast<usize>(ToDouble(env, args[1]));
+    return FromInt64(env, self->Train(*dict, dict_capacity));
+}
+
+
+static napi_value DictTrainerTrainCover(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictTrainer>(env, args.self);
+    auto dict = Unwrap<Vec<u8>>(env, args[0]);
+    auto params = Unwrap<ZstdDictTrainingParams>(env, args[2]);
+    if (self == nullptr || dict == nullptr || params == nullptr) return nullptr;
+
+    const auto dict_capacity = static_cast<usize>(ToDouble(env, args[1]));
+    return FromInt64(env, self->TrainCover(*dict, dict_capacity, *params));
+}
+
+
+static napi_value DictTrainerTrainFastCover(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictTrainer>(env, args.self);
+    auto dict = Unwrap<Vec<u8>>(env, args[0]);
+    auto params = Unwrap<ZstdDictTrainingParams>(env, args[2]);
+    if (self == nullptr || dict == nullptr || params == nullptr) return nullptr;
+
+    const auto dict_capacity = static_cast<usize>(ToDouble(env, args[1]));
+    return FromInt64(env, self->TrainFastCover(*dict, dict_capacity, *params));
+}
+
+
+static napi_value DictTrainerDictID(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto dict = Unwrap<Vec<u8>>(env, args[0]);
+    if (dict == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(ZstdDictTrainer::DictID(*dict)));
+}
+
+
+// ---- ZstdDictRegistry -------------------------------------------------------
+
+static napi_value DictRegistryAdd(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictRegistry>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    ByteSpan dict_bytes;
+    if (!GetByteSpan(env, args[0], dict_bytes)) return nullptr;
+
+    Vec<u8> dict_vec(dict_bytes.data, dict_bytes.data + dict_bytes.size);
+    return FromInt64(env, self->Add(std::move(dict_vec)));
+}
+
+
+static napi_value DictRegistryRemove(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictRegistry>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromBool(env, self->Remove(static_cast<unsigned>(ToDouble(env, args[0]))));
+}
+
+
+static napi_value DictRegistryClear(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictRegistry>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    self->Clear();
+    return Undefined(env);
+}
+
+
+static napi_value DictRegistryCount(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictRegistry>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->Count()));
+}
+
+
+static napi_value DictRegistryContains(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDictRegistry>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromBool(env, self->Contains(static_cast<unsigned>(ToDouble(env, args[0]))));
+}
+
+
+// ---- ZstdCDictCache ---------------------------------------------------------
+
+static napi_value CDictCacheAddDict(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCDictCache>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    ByteSpan dict_bytes;
+    if (!GetByteSpan(env, args[0], dict_bytes)) return nullptr;
+
+    Vec<u8> dict_vec(dict_bytes.data, dict_bytes.data + dict_bytes.size);
+    return FromInt64(env, self->AddDict(std::move(dict_vec)));
+}
+
+
+static napi_value CDictCacheRemoveDict(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCDictCache>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromBool(env, self->RemoveDict(static_cast<unsigned>(ToDouble(env, args[0]))));
+}
+
+
+static napi_value CDictCacheContainsDict(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCDictCache>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromBool(env, self->ContainsDict(static_cast<unsigned>(ToDouble(env, args[0]))));
+}
+
+
+static napi_value CDictCacheClear(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCDictCache>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    self->Clear();
+    return Undefined(env);
+}
+
+
+static napi_value CDictCacheDigestedCount(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCDictCache>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->DigestedCount()));
+}
+
+
+static napi_value CDictCacheMemoryUsage(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCDictCache>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->MemoryUsage()));
+}
+
+
+static napi_value CDictCacheMemoryBudget(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCDictCache>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->MemoryBudget()));
+}
+
+
+static napi_value CDictCacheSetMemoryBudget(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCDictCache>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    self->SetMemoryBudget(static_cast<usize>(ToDouble(env, args[0])));
+    return Undefined(env);
+}
+
+
+// ---- ZstdCodec --------------------------------------------------------------
+
+static napi_value CodecCompressBound(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromInt64(env, self->CompressBound(static_cast<usize>(ToDouble(env, args[0]))));
+}
+
+
+static napi_value CodecContentSize(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto src = Unwrap<Vec<u8>>(env, args[0]);
+    if (self == nullptr || src == nullptr) return nullptr;
+
+    return FromInt64(env, self->ContentSize(*src));
+}
+
+
+static napi_value CodecFramesContentSize(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto src = Unwrap<Vec<u8>>(env, args[0]);
+    if (self == nullptr || src == nullptr) return nullptr;
+
+    return FromInt64(env, self->FramesContentSize(*src));
+}
+
+
+static napi_value CodecCompress(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    auto src = Unwrap<Vec<u8>>(env, args[1]);
+    if (self == nullptr || dest == nullptr || src == nullptr) return nullptr;
+
+    const auto compression_level = ToInt(env, args[2]);
+    if (args.count >= 4) {
+        return FromInt64(env, self->Compress(*dest, *src, compression_level, ToInt(env, args[3])));
+    }
+
+    return FromInt64(env, self->Compress(*dest, *src, compression_level));
+}
+
+
+static napi_value CodecCompressUsingParams(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    auto src = Unwrap<Vec<u8>>(env, args[1]);
+    auto params = Unwrap<ZstdCompressionParams>(env, args[2]);
+    if (self == nullptr || dest == nullptr || src == nullptr || params == nullptr) return nullptr;
+
+    return FromInt64(env, self->Compress(*dest, *src, *params));
+}
+
+
+static napi_value CodecCompressParallel(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    auto src = Unwrap<Vec<u8>>(env, args[1]);
+    if (self == nullptr || dest == nullptr || src == nullptr) return nullptr;
+
+    const auto block_size = static_cast<usize>(ToDouble(env, args[4]));
+    return FromInt64(env, self->CompressParallel(*dest, *src, ToInt(env, args[2]), ToInt(env, args[3]), block_size));
+}
+
+
+static napi_value CodecCompressParallelUsingParams(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    auto src = Unwrap<Vec<u8>>(env, args[1]);
+    auto params = Unwrap<ZstdCompressionParams>(env, args[2]);
+    if (self == nullptr || dest == nullptr || src == nullptr || params == nullptr) return nullptr;
+
+    const auto block_size = static_cast<usize>(ToDouble(env, args[4]));
+    return FromInt64(env, self->CompressParallel(*dest, *src, *params, ToInt(env, args[3]), block_size));
+}
+
+
+static napi_value CodecDecompress(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    auto src = Unwrap<Vec<u8>>(env, args[1]);
+    if (self == nullptr || dest == nullptr || src == nullptr) return nullptr;
+
+    return FromInt64(env, self->Decompress(*dest, *src));
+}
+
+
+static napi_value CodecDecompressParallel(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    auto src = Unwrap<Vec<u8>>(env, args[1]);
+    if (self == nullptr || dest == nullptr || src == nullptr) return nullptr;
+
+    return FromInt64(env, self->DecompressParallel(*dest, *src, ToInt(env, args[2])));
+}
+
+
+static napi_value CodecCompressUsingDict(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    auto src = Unwrap<Vec<u8>>(env, args[1]);
+    auto cdict = Unwrap<ZstdCompressionDict>(env, args[2]);
+    if (self == nullptr || dest == nullptr || src == nullptr || cdict == nullptr) return nullptr;
+
+    return FromInt64(env, self->CompressUsingDict(*dest, *src, *cdict));
+}
+
+
+static napi_value CodecCompressUsingCache(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    auto src = Unwrap<Vec<u8>>(env, args[1]);
+    auto cache = Unwrap<ZstdCDictCache>(env, args[2]);
+    if (self == nullptr || dest == nullptr || src == nullptr || cache == nullptr) return nullptr;
+
+    const auto dict_id = static_cast<unsigned>(ToDouble(env, args[3]));
+    return FromInt64(env, self->CompressUsingDict(*dest, *src, *cache, dict_id, ToInt(env, args[4])));
+}
+
+
+static napi_value CodecDecompressUsingDict(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    auto src = Unwrap<Vec<u8>>(env, args[1]);
+    auto ddict = Unwrap<ZstdDecompressionDict>(env, args[2]);
+    if (self == nullptr || dest == nullptr || src == nullptr || ddict == nullptr) return nullptr;
+
+    return FromInt64(env, self->DecompressUsingDict(*dest, *src, *ddict));
+}
+
+
+static napi_value CodecDecompressUsingRegistry(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    auto dest = Unwrap<Vec<u8>>(env, args[0]);
+    auto src = Unwrap<Vec<u8>>(env, args[1]);
+    auto registry = Unwrap<ZstdDictRegistry>(env, args[2]);
+    if (self == nullptr || dest == nullptr || src == nullptr || registry == nullptr) return nullptr;
+
+    return FromInt64(env, self->DecompressUsingDict(*dest, *src, *registry));
+}
+
+
+// NOTE: batches cross the binding once, packed bytes and Uint32Array offsets in and out.
+// returns packed output, or a negative error code.
+template <typename F>
+static napi_value CodecBatch(napi_env env, napi_value src_value, napi_value src_offsets_value, napi_value dest_offsets_value, F batch)
+{
+    ByteSpan src_bytes;
+    OffsetSpan src_offsets, dest_offsets;
+    if (!GetByteSpan(env, src_value, src_bytes)) return nullptr;
+    if (!GetOffsetSpan(env, src_offsets_value, src_offsets)) return nullptr;
+    if (!GetOffsetSpan(env, dest_offsets_value, dest_offsets)) return nullptr;
+
+    const Vec<u8> src(src_bytes.data, src_bytes.data + src_bytes.size);
+    const Vec<usize> src_offset_vec(src_offsets.data, src_offsets.data + src_offsets.size);
+
+    Vec<u8> dest;
+    Vec<usize> dest_offset_vec;
+    const auto rc = batch(dest, dest_offset_vec, src, src_offset_vec);
+    if (rc < 0) return FromInt64(env, rc);
+    if (dest.size() > UINT32_MAX) return FromInt64(env, ERR_SIZE_TOO_LARGE);
+
+    if (dest_offsets.size < dest_offset_vec.size()) {
+        napi_throw_range_error(env, nullptr, "zstd-codec: output offsets are too short");
+        return nullptr;
+    }
+    std::copy(std::begin(dest_offset_vec), std::end(dest_offset_vec), dest_offsets.data);
+
+    return CopyAsTypedArray(env, dest.data(), dest.size());
+}
+
+
+static napi_value CodecCompressBatch(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    const auto compression_level = ToInt(env, args[3]);
+    return CodecBatch(env, args[0], args[1], args[2], [&](Vec<u8>& dest, Vec<usize>& dest_offsets, const Vec<u8>& src, const Vec<usize>& src_offsets) {
+        return self->CompressBatch(dest, dest_offsets, src, src_offsets, compression_level);
+    });
+}
+
+
+static napi_value CodecDecompressBatch(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return CodecBatch(env, args[0], args[1], args[2], [&](Vec<u8>& dest, Vec<usize>& dest_offsets, const Vec<u8>& src, const Vec<usize>& src_offsets) {
+        return self->DecompressBatch(dest, dest_offsets, src, src_offsets);
+    });
+}
+
+
+static napi_value CodecReleaseContexts(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    self->ReleaseContexts();
+    return Undefined(env);
+}
+
+
+static napi_value CodecMaxWorkers(napi_env env, napi_callback_info info)
+{
+    return FromInt(env, ZstdCodec::MaxWorkers());
+}
+
+
+static napi_value CodecStaticCompressWorkspaceSize(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    return FromDouble(env, static_cast<double>(ZstdCodec::StaticCompressWorkspaceSize(ToInt(env, args[0]))));
+}
+
+
+static napi_value CodecStaticDecompressWorkspaceSize(napi_env env, napi_callback_info info)
+{
+    return FromDouble(env, static_cast<double>(ZstdCodec::StaticDecompressWorkspaceSize()));
+}
+
+
+static napi_value CodecEstimateCompressMemory(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    const auto src_size = static_cast<usize>(ToDouble(env, args[1]));
+    return FromInt64(env, ZstdCodec::EstimateCompressMemory(ToInt(env, args[0]), src_size));
+}
+
+
+static napi_value CodecEstimateCompressMemoryUsingParams(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto params = Unwrap<ZstdCompressionParams>(env, args[0]);
+    if (params == nullptr) return nullptr;
+
+    const auto src_size = static_cast<usize>(ToDouble(env, args[1]));
+    return FromInt64(env, ZstdCodec::EstimateCompressMemory(*params, src_size));
+}
+
+
+static napi_value CodecEstimateDecompressMemory(napi_env env, napi_callback_info info)
+{
+    return FromInt64(env, ZstdCodec::EstimateDecompressMemory());
+}
+
+
+static napi_value CodecMemoryUsage(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCodec>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->MemoryUsage()));
+}
+
+
+// ---- stream bindings (implementations) -------------------------------------
+
+//
+// ZstdCompressStreamBinding
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static napi_value CompressStreamBegin(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    const auto compression_level = ToInt(env, args[0]);
+    if (args.count >= 2) {
+        return FromBool(env, self->stream.Begin(compression_level, ToInt(env, args[1])));
+    }
+
+    return FromBool(env, self->stream.Begin(compression_level));
+}
+
+
+static napi_value CompressStreamBeginUsingParams(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCompressStreamBinding>(env, args.self);
+    auto params = Unwrap<ZstdCompressionParams>(env, args[0]);
+    if (self == nullptr || params == nullptr) return nullptr;
+
+    return FromBool(env, self->stream.Begin(*params));
+}
+
+
+static napi_value CompressStreamBeginUsingDict(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCompressStreamBinding>(env, args.self);
+    auto cdict = Unwrap<ZstdCompressionDict>(env, args[0]);
+    if (self == nullptr || cdict == nullptr) return nullptr;
+
+    return FromBool(env, self->stream.Begin(*cdict));
+}
+
+
+static napi_value CompressStreamBeginUsingCache(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCompressStreamBinding>(env, args.self);
+    auto cache = Unwrap<ZstdCDictCache>(env, args[0]);
+    if (self == nullptr || cache == nullptr) return nullptr;
+
+    const auto dict_id = static_cast<unsigned>(ToDouble(env, args[1]));
+    return FromBool(env, self->stream.Begin(*cache, dict_id, ToInt(env, args[2])));
+}
+
+
+static napi_value CompressStreamTransform(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    // NOTE: no copy, native code reads JS memory directly.
+    ByteSpan chunk;
+    if (!GetByteSpan(env, args[0], chunk)) return nullptr;
+
+    JsCallback callback(env, args[1]);
+    const auto success = self->stream.Transform(chunk.data, chunk.size, std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value CompressStreamFlush(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    JsCallback callback(env, args[0]);
+    const auto success = self->stream.Flush(std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value CompressStreamEnd(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    JsCallback callback(env, args[0]);
+    const auto success = self->stream.End(std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value CompressStreamStaticWorkspaceSize(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    return FromDouble(env, static_cast<double>(ZstdCompressStream::StaticWorkspaceSize(ToInt(env, args[0]))));
+}
+
+
+static napi_value CompressStreamEstimateMemory(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    return FromInt64(env, ZstdCompressStream::EstimateMemory(ToInt(env, args[0])));
+}
+
+
+static napi_value CompressStreamEstimateMemoryUsingParams(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto params = Unwrap<ZstdCompressionParams>(env, args[0]);
+    if (params == nullptr) return nullptr;
+
+    return FromInt64(env, ZstdCompressStream::EstimateMemory(*params));
+}
+
+
+static napi_value CompressStreamMemoryUsage(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdCompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->stream.MemoryUsage()));
+}
+
+
+//
+// ZstdDecompressStreamBinding
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static napi_value DecompressStreamBegin(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromBool(env, self->stream.Begin());
+}
+
+
+static napi_value DecompressStreamBeginUsingDict(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressStreamBinding>(env, args.self);
+    auto ddict = Unwrap<ZstdDecompressionDict>(env, args[0]);
+    if (self == nullptr || ddict == nullptr) return nullptr;
+
+    return FromBool(env, self->stream.Begin(*ddict));
+}
+
+
+static napi_value DecompressStreamBeginUsingRegistry(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressStreamBinding>(env, args.self);
+    auto registry = Unwrap<ZstdDictRegistry>(env, args[0]);
+    if (self == nullptr || registry == nullptr) return nullptr;
+
+    return FromBool(env, self->stream.Begin(*registry));
+}
+
+
+static napi_value DecompressStreamTransform(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    // NOTE: no copy, native code reads JS memory directly.
+    ByteSpan chunk;
+    if (!GetByteSpan(env, args[0], chunk)) return nullptr;
+
+    JsCallback callback(env, args[1]);
+    const auto success = self->stream.Transform(chunk.data, chunk.size, std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value DecompressStreamFlush(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    JsCallback callback(env, args[0]);
+    const auto success = self->stream.Flush(std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value DecompressStreamEnd(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    JsCallback callback(env, args[0]);
+    const auto success = self->stream.End(std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value DecompressStreamStaticWorkspaceSize(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    const auto max_window_size = static_cast<usize>(ToDouble(env, args[0]));
+    return FromDouble(env, static_cast<double>(ZstdDecompressStream::StaticWorkspaceSize(max_window_size)));
+}
+
+
+static napi_value DecompressStreamEstimateMemory(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto frame_header = Unwrap<Vec<u8>>(env, args[0]);
+    if (frame_header == nullptr) return nullptr;
+
+    return FromInt64(env, ZstdDecompressStream::EstimateMemory(*frame_header));
+}
+
+
+static napi_value DecompressStreamMemoryUsage(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->stream.MemoryUsage()));
+}
+
+
+//
+// ZstdDecompressReadBinding
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static napi_value DecompressReadBegin(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressReadBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromBool(env, self->stream.Begin());
+}
+
+
+static napi_value DecompressReadBeginUsingDict(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressReadBinding>(env, args.self);
+    auto ddict = Unwrap<ZstdDecompressionDict>(env, args[0]);
+    if (self == nullptr || ddict == nullptr) return nullptr;
+
+    return FromBool(env, self->stream.Begin(*ddict));
+}
+
+
+static napi_value DecompressReadBeginUsingRegistry(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressReadBinding>(env, args.self);
+    auto registry = Unwrap<ZstdDictRegistry>(env, args[0]);
+    if (self == nullptr || registry == nullptr) return nullptr;
+
+    return FromBool(env, self->stream.Begin(*registry));
+}
+
+
+static napi_value DecompressReadLoad(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressReadBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    ByteSpan chunk;
+    if (!GetByteSpan(env, args[0], chunk)) return nullptr;
+
+    // NOTE: JS may reuse its bytes after `load` returns, keep a copy until the stream consumes it.
+    if (self->stream.HasInput()) return FromBool(env, false);
+
+    self->chunk.assign(chunk.data, chunk.data + chunk.size);
+    return FromBool(env, self->stream.Load(self->chunk.data(), self->chunk.size()));
+}
+
+
+static napi_value DecompressReadRead(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressReadBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    JsCallback callback(env, args[0]);
+    const auto success = self->stream.Read(std::ref(callback));
+    return callback.Result(success);
+}
+
+
+// NOTE: decompresses straight into JS memory of `dest`.
+static napi_value DecompressReadReadInto(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressReadBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    ByteSpan dest;
+    if (!GetByteSpan(env, args[0], dest)) return nullptr;
+
+    return FromInt64(env, self->stream.Read(const_cast<u8*>(dest.data), dest.size));
+}
+
+
+static napi_value DecompressReadHasInput(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressReadBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromBool(env, self->stream.HasInput());
+}
+
+
+static napi_value DecompressReadFlush(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressReadBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    JsCallback callback(env, args[0]);
+    const auto success = self->stream.Flush(std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value DecompressReadEnd(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressReadBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    JsCallback callback(env, args[0]);
+    const auto success = self->stream.End(std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value DecompressReadStaticWorkspaceSize(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    const auto max_window_size = static_cast<usize>(ToDouble(env, args[0]));
+    return FromDouble(env, static_cast<double>(ZstdDecompressRead::StaticWorkspaceSize(max_window_size)));
+}
+
+
+static napi_value DecompressReadEstimateMemory(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto frame_header = Unwrap<Vec<u8>>(env, args[0]);
+    if (frame_header == nullptr) return nullptr;
+
+    return FromInt64(env, ZstdDecompressRead::EstimateMemory(*frame_header));
+}
+
+
+static napi_value DecompressReadMemoryUsage(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdDecompressReadBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->stream.MemoryUsage()));
+}
+
+
+//
+// ZstdSeekableCompressStreamBinding
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static napi_value SeekableCompressStreamBegin(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableCompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    const auto max_frame_size = static_cast<usize>(ToDouble(env, args[1]));
+    return FromBool(env, self->stream.Begin(ToInt(env, args[0]), max_frame_size, ToBool(env, args[2])));
+}
+
+
+static napi_value SeekableCompressStreamBeginUsingParams(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableCompressStreamBinding>(env, args.self);
+    auto params = Unwrap<ZstdCompressionParams>(env, args[0]);
+    if (self == nullptr || params == nullptr) return nullptr;
+
+    const auto max_frame_size = static_cast<usize>(ToDouble(env, args[1]));
+    return FromBool(env, self->stream.Begin(*params, max_frame_size));
+}
+
+
+static napi_value SeekableCompressStreamTransform(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableCompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    // NOTE: no copy, native code reads JS memory directly.
+    ByteSpan chunk;
+    if (!GetByteSpan(env, args[0], chunk)) return nullptr;
+
+    JsCallback callback(env, args[1]);
+    const auto success = self->stream.Transform(chunk.data, chunk.size, std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value SeekableCompressStreamEndFrame(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableCompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    JsCallback callback(env, args[0]);
+    const auto success = self->stream.EndFrame(std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value SeekableCompressStreamEnd(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableCompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    JsCallback callback(env, args[0]);
+    const auto success = self->stream.End(std::ref(callback));
+    return callback.Result(success);
+}
+
+
+static napi_value SeekableCompressStreamFrameCount(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableCompressStreamBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->stream.FrameCount()));
+}
+
+
+//
+// ZstdSeekableReaderBinding
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static void ResetSeekableSource(ZstdSeekableReaderBinding* self)
+{
+    if (self->source != nullptr) {
+        napi_delete_reference(self->env, self->source);
+        self->source = nullptr;
+    }
+}
+
+
+static napi_value SeekableReaderOpen(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableReaderBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    ByteSpan src;
+    if (!GetByteSpan(env, args[0], src)) return nullptr;
+
+    self->reader.Close();
+    ResetSeekableSource(self);
+
+    self->src_bytes.assign(src.data, src.data + src.size);
+    return FromBool(env, self->reader.Open(self->src_bytes.data(), self->src_bytes.size()));
+}
+
+
+static napi_value SeekableReaderOpenUsingSource(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableReaderBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    self->reader.Close();
+    ResetSeekableSource(self);
+    self->src_bytes.clear();
+
+    self->env = env;
+    NAPI_CALL(env, napi_create_reference(env, args[1], 1, &self->source));
+
+    // NOTE: returns false once JS throws, the exception is rethrown to the caller.
+    const auto src_size = static_cast<u64>(ToDouble(env, args[0]));
+    const auto success = self->reader.Open(src_size, [self](u64 offset, usize size, Vec<u8>& dest) {
+        napi_value source = nullptr;
+        napi_value argv[] = { FromDouble(self->env, static_cast<double>(offset)), FromDouble(self->env, static_cast<double>(size)) };
+        napi_value bytes = nullptr;
+        if (napi_get_reference_value(self->env, self->source, &source) != napi_ok) return false;
+        if (napi_call_function(self->env, Undefined(self->env), source, 2, argv, &bytes) != napi_ok) return false;
+
+        // NOTE: source returns null (or nothing) on failure.
+        napi_valuetype type = napi_undefined;
+        napi_typeof(self->env, bytes, &type);
+        if (type == napi_undefined || type == napi_null) return false;
+
+        ByteSpan span;
+        if (!GetByteSpan(self->env, bytes, span)) return false;
+
+        dest.assign(span.data, span.data + span.size);
+        return true;
+    });
+
+    bool is_exception_pending = false;
+    napi_is_exception_pending(env, &is_exception_pending);
+    return is_exception_pending ? nullptr : FromBool(env, success);
+}
+
+
+static napi_value SeekableReaderClose(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableReaderBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    self->reader.Close();
+    ResetSeekableSource(self);
+    self->src_bytes.clear();
+    return Undefined(env);
+}
+
+
+static napi_value SeekableReaderFrameCount(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableReaderBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->reader.FrameCount()));
+}
+
+
+static napi_value SeekableReaderContentSize(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableReaderBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    return FromDouble(env, static_cast<double>(self->reader.ContentSize()));
+}
+
+
+// returns decompressed bytes, or null on failure.
+static napi_value SeekableReaderRead(napi_env env, napi_callback_info info)
+{
+    Arguments args;
+    if (!GetArguments(env, info, args)) return nullptr;
+
+    auto self = Unwrap<ZstdSeekableReaderBinding>(env, args.self);
+    if (self == nullptr) return nullptr;
+
+    const auto offset = static_cast<u64>(ToDouble(env, args[0]));
+    const auto size = static_cast<usize>(ToDouble(env, args[1]));
+
+    Vec<u8> dest;
+    const auto rc = self->reader.Read(dest, offset, size);
+
+    bool is_exception_pending = false;
+    napi_is_exception_pending(env, &is_exception_pending);
+    if (is_exception_pending) return nullptr;
+
+    if (rc < 0) {
+        napi_value null_value = nullptr;
+        NAPI_CALL(env, napi_get_null(env, &null_value));
+        return null_value;
+    }
+
+    return CopyAsTypedArray(env, dest.data(), dest.size());
+}
+
+
+// ---- bindings --------------------------------------------------------------
+
+static void FinalizeAddonData(napi_env env, void* data, void* hint)
+{
+    auto addon = static_cast<AddonData*>(data);
+    napi_delete_reference(env, addon->compression_dict_class);
+    napi_delete_reference(env, addon->decompression_dict_class);
+    napi_delete_reference(env, addon->allocator_class);
+    delete addon;
+}
+
+
+static napi_value Init(napi_env env, napi_value exports)
+{
+    const napi_property_descriptor functions[] = {
+        Method("dummy", Dummy),
+        Method("cloneToVector", CloneToVector),
+        Method("cloneAsTypedArray", CloneAsTypedArray),
+        Method("toTypedArrayView", ToTypedArrayView),
+        Method("createCompressionDict", CreateCompressionDict),
+        Method("createDecompressionDict", CreateDecompressionDict),
+        Method("createMallocAllocator", CreateMallocAllocator),
+        Method("createArenaAllocator", CreateArenaAllocator),
+        Method("createPoolAllocator", CreatePoolAllocator),
+    };
+    NAPI_CALL(env, napi_define_properties(env, exports, sizeof(functions) / sizeof(functions[0]), functions));
+
+    const napi_property_descriptor vector_methods[] = {
+        Method("resize", VectorResize),
+        Method("size", VectorSize),
+        Method("get", VectorGet),
+        Method("set", VectorSet),
+        Method("push_back", VectorPushBack),
+        Method("delete", Delete<Vec<u8>>),
+    };
+    DefineClass(env, exports, "VectorU8", Construct<Vec<u8>>, vector_methods, sizeof(vector_methods) / sizeof(vector_methods[0]));
+
+    const napi_property_descriptor cdict_methods[] = {
+        Method("memoryUsage", CompressionDictMemoryUsage),
+        StaticMethod("estimateMemory", CompressionDictEstimateMemory),
+        Method("delete", Delete<ZstdCompressionDict>),
+    };
+    auto cdict_class = DefineClass(env, exports, "ZstdCompressionDict", ConstructByFactoryOnly<ZstdCompressionDict>,
+                                   cdict_methods, sizeof(cdict_methods) / sizeof(cdict_methods[0]));
+
+    const napi_property_descriptor ddict_methods[] = {
+        Method("memoryUsage", DecompressionDictMemoryUsage),
+        StaticMethod("estimateMemory", DecompressionDictEstimateMemory),
+        Method("delete", Delete<ZstdDecompressionDict>),
+    };
+    auto ddict_class = DefineClass(env, exports, "ZstdDecompressionDict", ConstructByFactoryOnly<ZstdDecompressionDict>,
+                                   ddict_methods, sizeof(ddict_methods) / sizeof(ddict_methods[0]));
+
+    const napi_property_descriptor allocator_methods[] = {
+        Method("currentBytes", AllocatorCurrentBytes),
+        Method("peakBytes", AllocatorPeakBytes),
+        Method("reservedBytes", AllocatorReservedBytes),
+        Method("resetPeak", AllocatorResetPeak),
+        Method("trim", AllocatorTrim),
+        Method("delete", Delete<ZstdAllocatorBinding>),
+    };
+    auto allocator_class = DefineClass(env, exports, "ZstdAllocator", ConstructByFactoryOnly<ZstdAllocatorBinding>,
+                                       allocator_methods, sizeof(allocator_methods) / sizeof(allocator_methods[0]));
+
+    Vec<napi_property_descriptor> params_properties;
+    AddParamProperties(params_properties, COMPRESSION_INT_PARAMS);
+    AddParamProperties(params_properties, COMPRESSION_BOOL_PARAMS);
+    params_properties.push_back(Method("delete", Delete<ZstdCompressionParams>));
+    DefineClass(env, exports, "ZstdCompressionParams", Construct<ZstdCompressionParams>, params_properties.data(), params_properties.size());
+
+    Vec<napi_property_descriptor> training_params_properties;
+    AddParamProperties(training_params_properties, TRAINING_INT_PARAMS);
+    AddParamProperties(training_params_properties, TRAINING_DOUBLE_PARAMS);
+    training_params_properties.push_back(Method("delete", Delete<ZstdDictTrainingParams>));
+    DefineClass(env, exports, "ZstdDictTrainingParams", Construct<ZstdDictTrainingParams>,
+                training_params_properties.data(), training_params_properties.size());
+
+    const napi_property_descriptor trainer_methods[] = {
+        Method("addSample", DictTrainerAddSample),
+        Method("clear", DictTrainerClear),
+        Method("sampleCount", DictTrainerSampleCount),
+        Method("samplesSize", DictTrainerSamplesSize),
+        Method("train", DictTrainerTrain),
+        Method("trainCover", DictTrainerTrainCover),
+        Method("trainFastCover", DictTrainerTrainFastCover),
+        StaticMethod("dictID", DictTrainerDictID),
+        Method("delete", Delete<ZstdDictTrainer>),
+    };
+    DefineClass(env, exports, "ZstdDictTrainer", Construct<ZstdDictTrainer>, trainer_methods, sizeof(trainer_methods) / sizeof(trainer_methods[0]));
+
+    const napi_property_descriptor registry_methods[] = {
+        Method("add", DictRegistryAdd),
+        Method("remove", DictRegistryRemove),
+        Method("clear", DictRegistryClear),
+        Method("count", DictRegistryCount),
+        Method("contains", DictRegistryContains),
+        Method("delete", Delete<ZstdDictRegistry>),
+    };
+    DefineClass(env, exports, "ZstdDictRegistry", Construct<ZstdDictRegistry>, registry_methods, sizeof(registry_methods) / sizeof(registry_methods[0]));
+
+    const napi_property_descriptor cdict_cache_methods[] = {
+        Method("addDict", CDictCacheAddDict),
+        Method("removeDict", CDictCacheRemoveDict),
+        Method("containsDict", CDictCacheContainsDict),
+        Method("clear", CDictCacheClear),
+        Method("digestedCount", CDictCacheDigestedCount),
+        Method("memoryUsage", CDictCacheMemoryUsage),
+        Method("memoryBudget", CDictCacheMemoryBudget),
+        Method("setMemoryBudget", CDictCacheSetMemoryBudget),
+        Method("delete", Delete<ZstdCDictCache>),
+    };
+    DefineClass(env, exports, "ZstdCDictCache", Construct<ZstdCDictCache>, cdict_cache_methods, sizeof(cdict_cache_methods) / sizeof(cdict_cache_methods[0]));
+
+    const napi_property_descriptor codec_methods[] = {
+        Method("compressBound", CodecCompressBound),
+        Method("contentSize", CodecContentSize),
+        Method("framesContentSize", CodecFramesContentSize),
+        Method("compress", CodecCompress),
+        Method("compressUsingParams", CodecCompressUsingParams),
+        Method("compressParallel", CodecCompressParallel),
+        Method("compressParallelUsingParams", CodecCompressParallelUsingParams),
+        Method("decompress", CodecDecompress),
+        Method("decompressParallel", CodecDecompressParallel),
+        Method("compressUsingDict", CodecCompressUsingDict),
+        Method("compressUsingCache", CodecCompressUsingCache),
+        Method("decompressUsingDict", CodecDecompressUsingDict),
+        Method("decompressUsingRegistry", CodecDecompressUsingRegistry),
+        Method("compressBatch", CodecCompressBatch),
+        Method("decompressBatch", CodecDecompressBatch),
+        Method("releaseContexts", CodecReleaseContexts),
+        StaticMethod("maxWorkers", CodecMaxWorkers),
+        StaticMethod("staticCompressWorkspaceSize", CodecStaticCompressWorkspaceSize),
+        StaticMethod("staticDecompressWorkspaceSize", CodecStaticDecompressWorkspaceSize),
+        StaticMethod("estimateCompressMemory", CodecEstimateCompressMemory),
+        StaticMethod("estimateCompressMemoryUsingParams", CodecEstimateCompressMemoryUsingParams),
+        StaticMethod("estimateDecompressMemory", CodecEstimateDecompressMemory),
+        Method("memoryUsage", CodecMemoryUsage),
+        Method("delete", Delete<ZstdCodec>),
+    };
+    DefineClass(env, exports, "ZstdCodec", ConstructCodec, codec_methods, sizeof(codec_methods) / sizeof(codec_methods[0]));
+
+    const napi_property_descriptor compress_stream_methods[] = {
+        Method("begin", CompressStreamBegin),
+        Method("beginUsingParams", CompressStreamBeginUsingParams),
+        Method("beginUsingDict", CompressStreamBeginUsingDict),
+        Method("beginUsingCache", CompressStreamBeginUsingCache),
+        Method("transform", CompressStreamTransform),
+        Method("flush", CompressStreamFlush),
+        Method("end", CompressStreamEnd),
+        StaticMethod("staticWorkspaceSize", CompressStreamStaticWorkspaceSize),
+        StaticMethod("estimateMemory", CompressStreamEstimateMemory),
+        StaticMethod("estimateMemoryUsingParams", CompressStreamEstimateMemoryUsingParams),
+        Method("memoryUsage", CompressStreamMemoryUsage),
+        Method("delete", Delete<ZstdCompressStreamBinding>),
+    };
+    DefineClass(env, exports, "ZstdCompressStreamBinding", ConstructStream<ZstdCompressStreamBinding>,
+                compress_stream_methods, sizeof(compress_stream_methods) / sizeof(compress_stream_methods[0]));
+
+    const napi_property_descriptor decompress_stream_methods[] = {
+        Method("begin", DecompressStreamBegin),
+        Method("beginUsingDict", DecompressStreamBeginUsingDict),
+        Method("beginUsingRegistry", DecompressStreamBeginUsingRegistry),
+        Method("transform", DecompressStreamTransform),
+        Method("flush", DecompressStreamFlush),
+        Method("end", DecompressStreamEnd),
+        StaticMethod("staticWorkspaceSize", DecompressStreamStaticWorkspaceSize),
+        StaticMethod("estimateMemory", DecompressStreamEstimateMemory),
+        Method("memoryUsage", DecompressStreamMemoryUsage),
+        Method("delete", Delete<ZstdDecompressStreamBinding>),
+    };
+    DefineClass(env, exports, "ZstdDecompressStreamBinding", ConstructStream<ZstdDecompressStreamBinding>,
+                decompress_stream_methods, sizeof(decompress_stream_methods) / sizeof(decompress_stream_methods[0]));
+
+    const napi_property_descriptor decompress_read_methods[] = {
+        Method("begin", DecompressReadBegin),
+        Method("beginUsingDict", DecompressReadBeginUsingDict),
+        Method("beginUsingRegistry", DecompressReadBeginUsingRegistry),
+        Method("load", DecompressReadLoad),
+        Method("read", DecompressReadRead),
+        Method("readInto", DecompressReadReadInto),
+        Method("hasInput", DecompressReadHasInput),
+        Method("flush", DecompressReadFlush),
+        Method("end", DecompressReadEnd),
+        StaticMethod("staticWorkspaceSize", DecompressReadStaticWorkspaceSize),
+        StaticMethod("estimateMemory", DecompressReadEstimateMemory),
+        Method("memoryUsage", DecompressReadMemoryUsage),
+        Method("delete", Delete<ZstdDecompressReadBinding>),
+    };
+    DefineClass(env, exports, "ZstdDecompressReadBinding", ConstructStream<ZstdDecompressReadBinding>,
+                decompress_read_methods, sizeof(decompress_read_methods) / sizeof(decompress_read_methods[0]));
+
+    const napi_property_descriptor seekable_compress_stream_methods[] = {
+        Method("begin", SeekableCompressStreamBegin),
+        Method("beginUsingParams", SeekableCompressStreamBeginUsingParams),
+        Method("transform", SeekableCompressStreamTransform),
+        Method("endFrame", SeekableCompressStreamEndFrame),
+        Method("end", SeekableCompressStreamEnd),
+        Method("frameCount", SeekableCompressStreamFrameCount),
+        Method("delete", Delete<ZstdSeekableCompressStreamBinding>),
+    };
+    DefineClass(env, exports, "ZstdSeekableCompressStreamBinding", Construct<ZstdSeekableCompressStreamBinding>,
+                seekable_compress_stream_methods, sizeof(seekable_compress_stream_methods) / sizeof(seekable_compress_stream_methods[0]));
+
+    const napi_property_descriptor seekable_reader_methods[] = {
+        Method("open", SeekableReaderOpen),
+        Method("openUsingSource", SeekableReaderOpenUsingSource),
+        Method("close", SeekableReaderClose),
+        Method("frameCount", SeekableReaderFrameCount),
+        Method("contentSize", SeekableReaderContentSize),
+        Method("read", SeekableReaderRead),
+        Method("delete", Delete<ZstdSeekableReaderBinding>),
+    };
+    DefineClass(env, exports, "ZstdSeekableReaderBinding", Construct<ZstdSeekableReaderBinding>,
+                seekable_reader_methods, sizeof(seekable_reader_methods) / sizeof(seekable_reader_methods[0]));
+
+    if (cdict_class == nullptr || ddict_class == nullptr || allocator_class == nullptr) return nullptr;
+
+    auto addon = new AddonData();
+    napi_create_reference(env, cdict_class, 1, &addon->compression_dict_class);
+    napi_create_reference(env, ddict_class, 1, &addon->decompression_dict_class);
+    napi_create_reference(env, allocator_class, 1, &addon->allocator_class);
+    NAPI_CALL(env, napi_set_instance_data(env, addon, FinalizeAddonData, nullptr));
+
+    return exports;
+}
+
+
+NAPI_MODULE(zstd_codec_binding, Init)
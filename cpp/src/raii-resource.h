@@ -1,36 +1,41 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <type_traits>
 
 
-template <typename T>
+/*
+Resource owns `T*`, and closes it with `Deleter` when destroyed (or closed).
+
+`Deleter` is a stateless function object when the close function is known at compile time,
+closing is a direct call then, and the deleter takes no space in the object (same as std::unique_ptr).
+the default std::function takes a close handler at run time, for callers that pick it dynamically.
+*/
+template <typename T, typename Deleter = std::function<void(T*)>>
 class Resource
 {
 public:
-    using CloseHandler = std::function<void(T*)>;
+    using CloseHandler = Deleter;
 
-    Resource(T* resource, CloseHandler close_handler)
+    explicit Resource(T* resource)
         : resource_(resource)
-        , close_handler_(close_handler)
     {
+        static_assert(std::is_empty<Deleter>::value, "pass a close handler, unless the deleter is stateless");
     }
 
-    ~Resource()
+    Resource(T* resource, CloseHandler close_handler)
+        : resource_(resource, std::move(close_handler))
     {
-        Close();
     }
 
-    T* get() const { return resource_; }
+    T* get() const { return resource_.get(); }
 
     void Close()
     {
-        if (resource_ != nullptr) {
-            close_handler_(resource_);
-            resource_ = nullptr;
-        }
+        resource_.reset();
     }
 
 private:
-    T*  resource_;
-    CloseHandler close_handler_;
+    std::unique_ptr<T, Deleter> resource_;
 };
@@ -0,0 +1,357 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+
+#include "zstd.h"
+#include "zstd-allocator.h"
+
+
+// NOTE: header keeps blocks aligned as malloc does, it records the size requested by zstd.
+static const usize HEADER_SIZE = alignof(std::max_align_t);
+static_assert(sizeof(usize) <= HEADER_SIZE, "allocation header is too small");
+
+
+static usize AlignUp(usize size)
+{
+    return (size + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+}
+
+
+static void* AllocateThunk(void* opaque, size_t size)
+{
+    return static_cast<ZstdAllocator*>(opaque)->Allocate(size);
+}
+
+
+static void FreeThunk(void* opaque, void* address)
+{
+    static_cast<ZstdAllocator*>(opaque)->Free(address);
+}
+
+
+static ZSTD_customMem ToCustomMem(ZstdAllocator* allocator)
+{
+    return ZSTD_customMem { AllocateThunk, FreeThunk, allocator };
+}
+
+
+ZSTD_CCtx* CreateCCtx(ZstdAllocator* allocator)
+{
+    return allocator != nullptr
+        ? ZSTD_createCCtx_advanced(ToCustomMem(allocator))
+        : ZSTD_createCCtx();
+}
+
+
+ZSTD_DCtx* CreateDCtx(ZstdAllocator* allocator)
+{
+    return allocator != nullptr
+        ? ZSTD_createDCtx_advanced(ToCustomMem(allocator))
+        : ZSTD_createDCtx();
+}
+
+
+//
+// ZstdAllocator
+//
+////////////////////////////////////////////////////////////////////////////////
+
+ZstdAllocator::ZstdAllocator()
+    : mutex_()
+    , current_bytes_(0)
+    , peak_bytes_(0)
+{
+}
+
+
+ZstdAllocator::~ZstdAllocator()
+{
+}
+
+
+void* ZstdAllocator::Allocate(usize size)
+{
+    if (size > std::numeric_limits<usize>::max() - HEADER_SIZE) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto block = static_cast<u8*>(AllocateBlock(size + HEADER_SIZE));
+    if (block == nullptr) return nullptr;
+
+    std::memcpy(block, &size, sizeof(size));
+    current_bytes_ += size;
+    peak_bytes_ = std::max(peak_bytes_, current_bytes_);
+
+    return block + HEADER_SIZE;
+}
+
+
+void ZstdAllocator::Free(void* address)
+{
+    if (address == nullptr) return;
+
+    const auto block = static_cast<u8*>(address) - HEADER_SIZE;
+    usize size = 0;
+    std::memcpy(&size, block, sizeof(size));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_bytes_ -= size;
+    FreeBlock(block, size + HEADER_SIZE);
+}
+
+
+usize ZstdAllocator::CurrentBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_bytes_;
+}
+
+
+usize ZstdAllocator::PeakBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return peak_bytes_;
+}
+
+
+void ZstdAllocator::ResetPeak()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    peak_bytes_ = current_bytes_;
+}
+
+
+void ZstdAllocator::Trim()
+{
+}
+
+
+//
+// ZstdMallocAllocator
+//
+////////////////////////////////////////////////////////////////////////////////
+
+ZstdMallocAllocator::ZstdMallocAllocator()
+    : reserved_bytes_(0)
+{
+}
+
+
+ZstdMallocAllocator::~ZstdMallocAllocator()
+{
+}
+
+
+usize ZstdMallocAllocator::ReservedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reserved_bytes_;
+}
+
+
+void* ZstdMallocAllocator::AllocateBlock(usize size)
+{
+    const auto block = std::malloc(size);
+    if (block != nullptr) reserved_bytes_ += size;
+    return block;
+}
+
+
+void ZstdMallocAllocator::FreeBlock(void* block, usize size)
+{
+    reserved_bytes_ -= size;
+    std::free(block);
+}
+
+
+//
+// ZstdArenaAllocator
+//
+////////////////////////////////////////////////////////////////////////////////
+
+ZstdArenaAllocator::ZstdArenaAllocator(usize capacity)
+    : buffer_(new (std::nothrow) u8[capacity])
+    , capacity_(buffer_ != nullptr ? capacity : 0u)
+    , offset_(0)
+    , live_blocks_(0)
+{
+}
+
+
+ZstdArenaAllocator::~ZstdArenaAllocator()
+{
+}
+
+
+usize ZstdArenaAllocator::Capacity() const
+{
+    return capacity_;
+}
+
+
+usize ZstdArenaAllocator::ReservedBytes() const
+{
+    return capacity_;
+}
+
+
+void* ZstdArenaAllocator::AllocateBlock(usize size)
+{
+    const auto block_size = AlignUp(size);
+    if (block_size < size || block_size > capacity_ - offset_) return nullptr;
+
+    const auto block = buffer_.get() + offset_;
+    offset_ += block_size;
+    ++live_blocks_;
+
+    return block;
+}
+
+
+void ZstdArenaAllocator::FreeBlock(void* block, usize size)
+{
+    --live_blocks_;
+
+    // NOTE: rewinds the last block too, zstd frees temporary buffers in reverse order.
+    const auto block_size = AlignUp(size);
+    if (live_blocks_ == 0u) {
+        offset_ = 0;
+    }
+    else if (static_cast<u8*>(block) + block_size == buffer_.get() + offset_) {
+        offset_ -= block_size;
+    }
+}
+
+
+//
+// ZstdPoolAllocator
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// NOTE: class 0 takes everything up to MIN_CLASS_SIZE, then 4 classes per power of 2.
+static const usize MIN_CLASS_SIZE = 256;
+static const usize MIN_CLASS_LOG = 8;
+
+
+static usize FloorLog2(usize value)
+{
+    usize log = 0;
+    while (value >>= 1) ++log;
+    return log;
+}
+
+
+ZstdPoolAllocator::ZstdPoolAllocator(usize max_cached_bytes)
+    : max_cached_bytes_(max_cached_bytes)
+    , cached_bytes_(0)
+    , used_bytes_(0)
+    , free_blocks_()
+{
+}
+
+
+ZstdPoolAllocator::~ZstdPoolAllocator()
+{
+    Trim();
+}
+
+
+usize ZstdPoolAllocator::CachedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cached_bytes_;
+}
+
+
+usize ZstdPoolAllocator::ReservedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_bytes_ + cached_bytes_;
+}
+
+
+void ZstdPoolAllocator::Trim()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    TrimLocked();
+}
+
+
+usize ZstdPoolAllocator::ClassSize(usize size)
+{
+    if (size <= MIN_CLASS_SIZE) return MIN_CLASS_SIZE;
+
+    const auto log = FloorLog2(size - 1);
+    const auto step_log = log - 2;
+    return (((size - 1) >> step_log) + 1) << step_log;
+}
+
+
+usize ZstdPoolAllocator::ClassIndex(usize size)
+{
+    if (size <= MIN_CLASS_SIZE) return 0;
+
+    // NOTE: ((size - 1) >> step_log) is 4..7, one of the 4 classes of this power of 2.
+    const auto log = FloorLog2(size - 1);
+    const auto step_log = log - 2;
+    return 1 + (log - MIN_CLASS_LOG) * 4 + (((size - 1) >> step_log) - 4);
+}
+
+
+void* ZstdPoolAllocator::AllocateBlock(usize size)
+{
+    const auto class_size = ClassSize(size);
+    if (class_size < size) return nullptr;
+
+    const auto index = ClassIndex(size);
+    if (index < free_blocks_.size() && !free_blocks_[index].empty()) {
+        const auto block = free_blocks_[index].back();
+        free_blocks_[index].pop_back();
+        cached_bytes_ -= class_size;
+        used_bytes_ += class_size;
+        return block;
+    }
+
+    // NOTE: cached blocks of other classes may be what the heap lacks.
+    auto block = std::malloc(class_size);
+    if (block == nullptr && cached_bytes_ > 0u) {
+        TrimLocked();
+        block = std::malloc(class_size);
+    }
+    if (block == nullptr) return nullptr;
+
+    used_bytes_ += class_size;
+    return block;
+}
+
+
+void ZstdPoolAllocator::FreeBlock(void* block, usize size)
+{
+    const auto class_size = ClassSize(size);
+    used_bytes_ -= class_size;
+
+    if (class_size > max_cached_bytes_ - std::min(cached_bytes_, max_cached_bytes_)) {
+        std::free(block);
+        return;
+    }
+
+    const auto index = ClassIndex(size);
+    if (free_blocks_.size() <= index) free_blocks_.resize(index + 1);
+    free_blocks_[index].push_back(block);
+    cached_bytes_ += class_size;
+}
+
+
+void ZstdPoolAllocator::TrimLocked()
+{
+    for (auto& blocks : free_blocks_) {
+        for (const auto block : blocks) {
+            std::free(block);
+        }
+        blocks.clear();
+    }
+
+    cached_bytes_ = 0;
+}
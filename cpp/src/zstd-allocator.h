@@ -0,0 +1,138 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "common-types.h"
+
+
+extern "C" {
+struct ZSTD_CCtx_s;     // orginal struct of ZSTD_CCtx
+struct ZSTD_DCtx_s;     // orginal struct of ZSTD_DCtx
+}
+
+
+/*
+ZstdAllocator serves zstd allocations of contexts created with it (ZSTD_customMem),
+and reports current and peak bytes of them.
+
+each allocation carries a small header recording its size, so implementations are told the size on free too.
+contexts hold the allocator with shared_ptr, give each context its own allocator to measure it alone.
+*/
+class ZstdAllocator
+{
+public:
+    ZstdAllocator();
+    virtual ~ZstdAllocator();
+
+    ZstdAllocator(const ZstdAllocator&) = delete;
+    ZstdAllocator& operator=(const ZstdAllocator&) = delete;
+
+    void* Allocate(usize size);
+    void Free(void* address);
+
+    usize CurrentBytes() const;     // bytes requested by zstd and not freed yet
+    usize PeakBytes() const;
+    void ResetPeak();
+
+    virtual usize ReservedBytes() const = 0;    // bytes taken from the system heap
+    virtual void Trim();                        // returns unused memory to the system heap, if any
+
+protected:
+    // called with the allocator locked.
+    virtual void* AllocateBlock(usize size) = 0;
+    virtual void FreeBlock(void* block, usize size) = 0;
+
+    mutable std::mutex  mutex_;
+
+private:
+    usize   current_bytes_;
+    usize   peak_bytes_;
+};
+
+
+// malloc/free, only to report bytes.
+class ZstdMallocAllocator : public ZstdAllocator
+{
+public:
+    ZstdMallocAllocator();
+    ~ZstdMallocAllocator() override;
+
+    usize ReservedBytes() const override;
+
+protected:
+    void* AllocateBlock(usize size) override;
+    void FreeBlock(void* block, usize size) override;
+
+private:
+    usize   reserved_bytes_;
+};
+
+
+/*
+ZstdArenaAllocator bumps allocations out of one buffer of `capacity` bytes, reserved up front.
+frees are no-op until all blocks are freed, then it starts over from the beginning.
+
+suited to a single context, whose workspace is allocated once and reused until the context is freed.
+allocations fail when the arena is full, zstd reports them as memory allocation errors.
+*/
+class ZstdArenaAllocator : public ZstdAllocator
+{
+public:
+    explicit ZstdArenaAllocator(usize capacity);
+    ~ZstdArenaAllocator() override;
+
+    usize Capacity() const;
+    usize ReservedBytes() const override;
+
+protected:
+    void* AllocateBlock(usize size) override;
+    void FreeBlock(void* block, usize size) override;
+
+private:
+    std::unique_ptr<u8[]>   buffer_;
+    usize                   capacity_;
+    usize                   offset_;
+    usize                   live_blocks_;
+};
+
+
+/*
+ZstdPoolAllocator rounds allocations up to size classes, and keeps freed blocks for reuse.
+classes step by a quarter of each power of 2, so a block is 25% larger than requested at most.
+
+contexts come and go with the same few workspace sizes, reusing their blocks avoids heap fragmentation.
+freed blocks are cached up to `max_cached_bytes`, beyond that they go back to the system heap.
+*/
+class ZstdPoolAllocator : public ZstdAllocator
+{
+public:
+    static const usize DEFAULT_MAX_CACHED_BYTES = 64 * 1024 * 1024;
+
+    explicit ZstdPoolAllocator(usize max_cached_bytes = DEFAULT_MAX_CACHED_BYTES);
+    ~ZstdPoolAllocator() override;
+
+    usize CachedBytes() const;
+    usize ReservedBytes() const override;
+    void Trim() override;
+
+    static usize ClassSize(usize size);
+
+protected:
+    void* AllocateBlock(usize size) override;
+    void FreeBlock(void* block, usize size) override;
+
+private:
+    static usize ClassIndex(usize size);
+    void TrimLocked();
+
+    usize           max_cached_bytes_;
+    usize           cached_bytes_;
+    usize           used_bytes_;            // class sizes of blocks in use
+    Vec<Vec<void*>> free_blocks_;           // by class index
+};
+
+
+// creates a context allocating through `allocator`, or malloc if null. free it with ZSTD_freeCCtx/ZSTD_freeDCtx.
+ZSTD_CCtx_s* CreateCCtx(ZstdAllocator* allocator);
+ZSTD_DCtx_s* CreateDCtx(ZstdAllocator* allocator);
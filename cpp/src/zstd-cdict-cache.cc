@@ -0,0 +1,254 @@
+#include <tuple>
+
+#include "zstd.h"
+#include "zstd-cdict-cache.h"
+#include "zstd-codec.h"
+#include "zstd-dict.h"
+#include "zstd-trace.h"
+
+
+// CDict referencing content, shared with the other CDicts of the same dictionary.
+struct DigestedDict
+{
+    DigestedDict(std::shared_ptr<const Vec<u8>> content, const ZstdCompressionParams& params)
+        : content(std::move(content))
+        , cdict(this->content->data(), this->content->size(), params)
+    {
+    }
+
+    std::shared_ptr<const Vec<u8>>  content;
+    ZstdCompressionDict             cdict;
+};
+
+
+static ZstdCDictCache::CDictPtr Digest(const std::shared_ptr<const Vec<u8>>& content, const ZstdCompressionParams& params)
+{
+    auto digested = std::make_shared<const DigestedDict>(content, params);
+    if (digested->cdict.fail()) {
+        TRACE_ERROR("cdict cache: failed to digest dictionary at level %d", params.compression_level);
+        return nullptr;
+    }
+
+    // NOTE: aliasing constructor, the CDict keeps its content alive.
+    return ZstdCDictCache::CDictPtr(digested, &digested->cdict);
+}
+
+
+//
+// ZstdCDictCache::Key
+//
+///////////////////////////////////////////////////////////////////////////////
+
+ZstdCDictCache::Key::Key(unsigned dict_id, const ZstdCompressionParams& params)
+    : dict_id(dict_id)
+    , compression_level(params.compression_level)
+    , window_log(params.window_log)
+    , hash_log(params.hash_log)
+    , chain_log(params.chain_log)
+    , search_log(params.search_log)
+    , min_match(params.min_match)
+    , target_length(params.target_length)
+    , strategy(params.strategy)
+{
+}
+
+
+bool ZstdCDictCache::Key::operator<(const Key& other) const
+{
+    return std::tie(dict_id, compression_level, window_log, hash_log, chain_log,
+                    search_log, min_match, target_length, strategy)
+         < std::tie(other.dict_id, other.compression_level, other.window_log, other.hash_log, other.chain_log,
+                    other.search_log, other.min_match, other.target_length, other.strategy);
+}
+
+
+//
+// ZstdCDictCache
+//
+///////////////////////////////////////////////////////////////////////////////
+
+ZstdCDictCache::ZstdCDictCache(usize memory_budget)
+    : mutex_()
+    , memory_budget_(memory_budget)
+    , memory_usage_(0)
+    , dicts_()
+    , entries_()
+    , index_()
+{
+}
+
+
+ZstdCDictCache::~ZstdCDictCache()
+{
+}
+
+
+i64 ZstdCDictCache::AddDict(const Vec<u8>& dict_bytes)
+{
+    return AddDict(Vec<u8>(dict_bytes));
+}
+
+
+i64 ZstdCDictCache::AddDict(Vec<u8>&& dict_bytes)
+{
+    // NOTE: raw content dictionaries have no ID to look them up.
+    const auto dict_id = ZSTD_getDictID_fromDict(dict_bytes.data(), dict_bytes.size());
+    if (dict_id == 0u) {
+        TRACE_ERROR("cdict cache: dictionary has no ID");
+        return ERR_LOAD_CDICT;
+    }
+
+    auto content = std::make_shared<const Vec<u8>>(std::move(dict_bytes));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    RemoveDictLocked(dict_id);
+    dicts_[dict_id] = std::move(content);
+
+    return static_cast<i64>(dict_id);
+}
+
+
+bool ZstdCDictCache::RemoveDict(unsigned dict_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return RemoveDictLocked(dict_id);
+}
+
+
+bool ZstdCDictCache::ContainsDict(unsigned dict_id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dicts_.find(dict_id) != std::end(dicts_);
+}
+
+
+void ZstdCDictCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    dicts_.clear();
+    entries_.clear();
+    index_.clear();
+    memory_usage_ = 0;
+}
+
+
+ZstdCDictCache::CDictPtr ZstdCDictCache::Get(unsigned dict_id, int compression_level)
+{
+    ZstdCompressionParams params;
+    params.compression_level = compression_level;
+
+    return Get(dict_id, params);
+}
+
+
+ZstdCDictCache::CDictPtr ZstdCDictCache::Get(unsigned dict_id, const ZstdCompressionParams& params)
+{
+    const Key key(dict_id, params);
+    Content content;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto cached = FindLocked(key);
+        if (cached != nullptr) return cached;
+
+        const auto dict = dicts_.find(dict_id);
+        if (dict == std::end(dicts_)) return nullptr;
+        content = dict->second;
+    }
+
+    // NOTE: digest without the lock, it takes a while on high levels.
+    auto cdict = Digest(content, params);
+    if (cdict == nullptr) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // another thread may have digested it meanwhile.
+    const auto cached = FindLocked(key);
+    if (cached != nullptr) return cached;
+
+    // dictionary was removed or replaced meanwhile, hand it out without caching.
+    const auto dict = dicts_.find(dict_id);
+    if (dict == std::end(dicts_) || dict->second != content) return cdict;
+
+    const auto memory = ZSTD_sizeof_CDict(cdict->get());
+    entries_.push_front(Entry { key, cdict, memory });
+    index_.emplace(key, std::begin(entries_));
+    memory_usage_ += memory;
+
+    EvictOverBudget();
+    return cdict;
+}
+
+
+usize ZstdCDictCache::DigestedCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+
+usize ZstdCDictCache::MemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memory_usage_;
+}
+
+
+usize ZstdCDictCache::MemoryBudget() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memory_budget_;
+}
+
+
+void ZstdCDictCache::SetMemoryBudget(usize memory_budget)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    memory_budget_ = memory_budget;
+    EvictOverBudget();
+}
+
+
+ZstdCDictCache::CDictPtr ZstdCDictCache::FindLocked(const Key& key)
+{
+    const auto found = index_.find(key);
+    if (found == std::end(index_)) return nullptr;
+
+    // move to front as the most recently used.
+    entries_.splice(std::begin(entries_), entries_, found->second);
+    return found->second->cdict;
+}
+
+
+bool ZstdCDictCache::RemoveDictLocked(unsigned dict_id)
+{
+    if (dicts_.erase(dict_id) == 0u) return false;
+
+    for (auto it = std::begin(entries_); it != std::end(entries_);) {
+        if (it->key.dict_id == dict_id) {
+            memory_usage_ -= it->memory;
+            index_.erase(it->key);
+            it = entries_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    return true;
+}
+
+
+void ZstdCDictCache::EvictOverBudget()
+{
+    while (memory_usage_ > memory_budget_ && entries_.size() > 1) {
+        const auto& lru = entries_.back();
+        TRACE_DEBUG("cdict cache: evict dictionary %u at level %d", lru.key.dict_id, lru.key.compression_level);
+
+        memory_usage_ -= lru.memory;
+        index_.erase(lru.key);
+        entries_.pop_back();
+    }
+}
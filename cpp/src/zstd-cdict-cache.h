@@ -0,0 +1,91 @@
+#pragma once
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "common-types.h"
+#include "zstd-params.h"
+
+
+class ZstdCompressionDict;
+
+
+/*
+ZstdCDictCache digests registered dictionaries on demand, for each
+(dictionary ID, compression level, compression parameters) they are used with.
+
+dictionary content is stored once and referenced by every digested CDict.
+digested CDicts are evicted in LRU order once their total size (ZSTD_sizeof_CDict)
+exceeds the memory budget, the most recently used one is always kept.
+returned CDicts stay valid while the caller holds them, even if evicted or removed meanwhile.
+*/
+class ZstdCDictCache
+{
+public:
+    using CDictPtr = std::shared_ptr<const ZstdCompressionDict>;
+
+    static const usize DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+    explicit ZstdCDictCache(usize memory_budget = DEFAULT_MEMORY_BUDGET);
+    ~ZstdCDictCache();
+
+    ZstdCDictCache(const ZstdCDictCache&) = delete;
+    ZstdCDictCache& operator=(const ZstdCDictCache&) = delete;
+
+    // returns dictionary ID, or a negative error code (ERR_* in zstd-codec.h).
+    i64 AddDict(const Vec<u8>& dict_bytes);
+    i64 AddDict(Vec<u8>&& dict_bytes);
+    bool RemoveDict(unsigned dict_id);
+    bool ContainsDict(unsigned dict_id) const;
+    void Clear();
+
+    // returns null if the dictionary is not registered or fails to be digested.
+    CDictPtr Get(unsigned dict_id, int compression_level);
+    CDictPtr Get(unsigned dict_id, const ZstdCompressionParams& params);
+
+    usize DigestedCount() const;
+    usize MemoryUsage() const;
+    usize MemoryBudget() const;
+    void SetMemoryBudget(usize memory_budget);
+
+private:
+    using Content = std::shared_ptr<const Vec<u8>>;
+
+    struct Key
+    {
+        unsigned    dict_id;
+        int         compression_level;
+        int         window_log;
+        int         hash_log;
+        int         chain_log;
+        int         search_log;
+        int         min_match;
+        int         target_length;
+        int         strategy;
+
+        Key(unsigned dict_id, const ZstdCompressionParams& params);
+        bool operator<(const Key& other) const;
+    };
+
+    struct Entry
+    {
+        Key         key;
+        CDictPtr    cdict;
+        usize       memory;
+    };
+
+    using Entries = std::list<Entry>;   // most recently used first
+
+    CDictPtr FindLocked(const Key& key);
+    bool RemoveDictLocked(unsigned dict_id);
+    void EvictOverBudget();
+
+    mutable std::mutex                          mutex_;
+    usize                                       memory_budget_;
+    usize                                       memory_usage_;
+    std::map<unsigned, Content>                 dicts_;
+    Entries                                     entries_;
+    std::map<Key, Entries::iterator>            index_;
+};
@@ -1,31 +1,25 @@
-#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <functional>
+#include <limits>
 
 #include "zstd.h"
 #include "zstd-codec.h"
 #include "zstd-dict.h"
-#include "raii-resource.h"
+#include "zstd-dict-registry.h"
+#include "zstd-trace.h"
 
-#if DEBUG
+#if ZSTD_CODEC_TRACE_LEVEL >= 1
 # define USE_DEBUG_ERROR_HANDLER (1)
 #endif
 
 
-static const int ERR_UNKNOWN = -1;
-static const int ERR_SIZE_TOO_LARGE = -2;
-
-static const int ERR_ALLOCATE_CCTX = -3;
-static const int ERR_ALLOCATE_DCTX = -4;
-
-static const int ERR_LOAD_CDICT = -5;
-static const int ERR_LOAD_DDICT = -6;
-
-
 class IErrorHandler
 {
 public:
     virtual void OnZstdError(size_t rc) = 0;
-    virtual void OnSizeError(size_t rc) = 0;
+    virtual void OnSizeError(u64 size) = 0;
 };
 
 
@@ -35,12 +29,12 @@ class DebugErrorHandler : public IErrorHandler
 public:
     virtual void OnZstdError(size_t rc)
     {
-        printf("## zstd error: %s\n", ZSTD_getErrorName(rc));
+        TRACE_ERROR("zstd error: %s", ZSTD_getErrorName(rc));
     }
 
-    virtual void OnSizeError(size_t rc)
+    virtual void OnSizeError(u64 size)
     {
-        printf("## size error: %s\n", ZSTD_getErrorName(rc));
+        TRACE_ERROR("size error: %llu", static_cast<unsigned long long>(size));
     }
 };
 
@@ -50,49 +44,29 @@ static DebugErrorHandler s_debug_handler;
 #endif // USE_DEBUG_ERROR_HANDLER
 
 
-class CompressContext : public Resource<ZSTD_CCtx>
+static i64 ToResult(size_t rc, IErrorHandler* error_handler = nullptr)
 {
-public:
-    CompressContext()
-        : Resource(ZSTD_createCCtx(), CloseContext)
-    {
-    }
-
-    bool fail() const
-    {
-        return get() == nullptr;
-    }
-
-private:
-    static void CloseContext(ZSTD_CCtx* cctx)
-    {
-        ZSTD_freeCCtx(cctx);
+#if USE_DEBUG_ERROR_HANDLER
+    if (error_handler == nullptr) {
+        error_handler = &s_debug_handler;
     }
-};
-
+#endif
 
-class DecompressContext : public Resource<ZSTD_DCtx>
-{
-public:
-    DecompressContext()
-        : Resource(ZSTD_createDCtx(), CloseContext)
-    {
+    if (ZSTD_isError(rc)) {
+        if (error_handler != nullptr) error_handler->OnZstdError(rc);
+        return ERR_UNKNOWN;
     }
-
-    bool fail() const
-    {
-        return get() == nullptr;
+    else if (static_cast<u64>(rc) > static_cast<u64>(MAX_RESULT_SIZE)) {
+        if (error_handler != nullptr) error_handler->OnSizeError(rc);
+        return ERR_SIZE_TOO_LARGE;
     }
 
-private:
-    static void CloseContext(ZSTD_DCtx* dctx)
-    {
-        ZSTD_freeDCtx(dctx);
-    }
-};
+    return static_cast<i64>(rc);
+}
 
 
-static int ToResult(size_t rc, IErrorHandler* error_handler = nullptr)
+// NOTE: content size is 64-bit even if size_t is 32-bit (wasm32), don't pass it through ToResult.
+static i64 ToContentSizeResult(unsigned long long content_size, IErrorHandler* error_handler = nullptr)
 {
 #if USE_DEBUG_ERROR_HANDLER
     if (error_handler == nullptr) {
@@ -100,52 +74,188 @@ static int ToResult(size_t rc, IErrorHandler* error_handler = nullptr)
     }
 #endif
 
-    if (ZSTD_isError(rc)) {
-        if (error_handler != nullptr) error_handler->OnZstdError(rc);
+    if (content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+        return ERR_CONTENT_SIZE_UNKNOWN;
+    }
+    else if (content_size == ZSTD_CONTENTSIZE_ERROR) {
         return ERR_UNKNOWN;
     }
-    else if (rc >= static_cast<size_t>(INT_MAX)) {
-        if (error_handler != nullptr) error_handler->OnSizeError(rc);
+    else if (content_size > static_cast<u64>(MAX_RESULT_SIZE)) {
+        if (error_handler != nullptr) error_handler->OnSizeError(content_size);
         return ERR_SIZE_TOO_LARGE;
     }
 
-    return static_cast<int>(rc);
+    return static_cast<i64>(content_size);
+}
+
+
+// NOTE: offsets are item_count + 1 boundaries, ascending and within `size`.
+static bool IsValidBatch(const Vec<usize>& offsets, usize size)
+{
+    if (offsets.empty() || offsets.back() > size) {
+        TRACE_ERROR("batch: offsets are out of range");
+        return false;
+    }
+    else if (!std::is_sorted(std::begin(offsets), std::end(offsets))) {
+        TRACE_ERROR("batch: offsets are not ascending");
+        return false;
+    }
+
+    return true;
+}
+
+
+ZstdCodec::ZstdCodec()
+    : context_pool_()
+    , thread_pool_()
+{
+}
+
+
+ZstdCodec::ZstdCodec(std::shared_ptr<ZstdAllocator> allocator)
+    : context_pool_(4, std::move(allocator))
+    , thread_pool_()
+{
+}
+
+
+ZstdCodec::ZstdCodec(ZstdWorkspace cctx_workspace, ZstdWorkspace dctx_workspace)
+    : context_pool_(std::move(cctx_workspace), std::move(dctx_workspace))
+    , thread_pool_()
+{
 }
 
 
-int ZstdCodec::CompressBound(usize src_size) const
+usize ZstdCodec::StaticCompressWorkspaceSize(int compression_level)
+{
+    return ZSTD_estimateCCtxSize(compression_level);
+}
+
+
+usize ZstdCodec::StaticDecompressWorkspaceSize()
+{
+    return ZSTD_estimateDCtxSize();
+}
+
+
+i64 ZstdCodec::CompressBound(usize src_size) const
 {
     const auto rc = ZSTD_compressBound(src_size);
     return ToResult(rc);
 }
 
 
-int ZstdCodec::ContentSize(const Vec<u8>& src) const
+i64 ZstdCodec::ContentSize(const Vec<u8>& src) const
+{
+    const auto content_size = ZSTD_getFrameContentSize(src.data(), src.size());
+    return ToContentSizeResult(content_size);
+}
+
+
+i64 ZstdCodec::FramesContentSize(const Vec<u8>& src) const
+{
+    // NOTE: skippable frames are counted too, their content size is 0.
+    //       each size is at most MAX_RESULT_SIZE, so the sum checked per frame doesn't overflow.
+    usize src_pos = 0;
+    u64 content_size = 0;
+    while (src_pos < src.size()) {
+        const auto frame = src.data() + src_pos;
+        const auto frame_size = ZSTD_findFrameCompressedSize(frame, src.size() - src_pos);
+        if (ZSTD_isError(frame_size)) return ToResult(frame_size);
+
+        const auto rc = ToContentSizeResult(ZSTD_getFrameContentSize(frame, frame_size));
+        if (rc < 0) return rc;
+
+        src_pos += frame_size;
+        content_size += static_cast<u64>(rc);
+        if (content_size > static_cast<u64>(MAX_RESULT_SIZE)) return ERR_SIZE_TOO_LARGE;
+    }
+
+    return static_cast<i64>(content_size);
+}
+
+
+i64 ZstdCodec::EstimateCompressMemory(int compression_level, usize src_size)
+{
+    ZstdCompressionParams params;
+    params.compression_level = compression_level;
+    return EstimateCompressMemory(params, src_size);
+}
+
+
+i64 ZstdCodec::EstimateCompressMemory(const ZstdCompressionParams& params, usize src_size)
 {
-    const auto rc = ZSTD_getFrameContentSize(&src[0], src.size());
+    const auto rc = params.EstimateCCtxSize(src_size);
+    if (ZSTD_isError(rc)) return ERR_UNKNOWN;
+
+    return static_cast<i64>(rc);
+}
+
+
+i64 ZstdCodec::EstimateDecompressMemory()
+{
+    return static_cast<i64>(ZSTD_estimateDCtxSize());
+}
+
+
+usize ZstdCodec::MemoryUsage() const
+{
+    return context_pool_.MemoryUsage();
+}
+
+
+i64 ZstdCodec::Compress(Vec<u8>& dest, const Vec<u8>& src, int compression_level) const
+{
+    auto context = context_pool_.LeaseCompressContext();
+    if (context.fail()) return ERR_ALLOCATE_CCTX;
+
+    const auto rc = ZSTD_compressCCtx(context.get(),
+                                      &dest[0], dest.size(),
+                                      &src[0], src.size(), compression_level);
     return ToResult(rc);
 }
 
 
-int ZstdCodec::Compress(Vec<u8>& dest, const Vec<u8>& src, int compression_level) const
+i64 ZstdCodec::Compress(Vec<u8>& dest, const Vec<u8>& src, int compression_level, int nb_workers) const
 {
-    const auto rc = ZSTD_compress(&dest[0], dest.size(),
-                                  &src[0], src.size(), compression_level);
+    ZstdCompressionParams params;
+    params.compression_level = compression_level;
+    params.nb_workers = nb_workers;
+
+    return Compress(dest, src, params);
+}
+
+
+i64 ZstdCodec::Compress(Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionParams& params) const
+{
+    auto context = context_pool_.LeaseCompressContext();
+    if (context.fail()) return ERR_ALLOCATE_CCTX;
+
+    const auto param_rc = params.Apply(context.get());
+    if (ZSTD_isError(param_rc)) return ToResult(param_rc);
+
+    const auto rc = ZSTD_compress2(context.get(),
+                                   &dest[0], dest.size(),
+                                   &src[0], src.size());
     return ToResult(rc);
 }
 
 
-int ZstdCodec::Decompress(Vec<u8>& dest, const Vec<u8>& src) const
+i64 ZstdCodec::Decompress(Vec<u8>& dest, const Vec<u8>& src) const
 {
-    const auto rc = ZSTD_decompress(&dest[0], dest.size(),
-                                    &src[0], src.size());
+    auto context = context_pool_.LeaseDecompressContext();
+    if (context.fail()) return ERR_ALLOCATE_DCTX;
+
+    const auto rc = ZSTD_decompressDCtx(context.get(),
+                                        &dest[0], dest.size(),
+                                        &src[0], src.size());
     return ToResult(rc);
 }
 
 
-int ZstdCodec::CompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionDict& cdict) const
+i64 ZstdCodec::CompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionDict& cdict) const
 {
-    CompressContext context;
+    auto context = context_pool_.LeaseCompressContext();
     if (context.fail()) return ERR_ALLOCATE_CCTX;
 
     const auto rc = ZSTD_compress_usingCDict(context.get(),
@@ -156,9 +266,40 @@ int ZstdCodec::CompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdCo
 }
 
 
-int ZstdCodec::DecompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdDecompressionDict& ddict) const
+i64 ZstdCodec::CompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, ZstdCDictCache& cache, unsigned dict_id, int compression_level) const
+{
+    const auto cdict = cache.Get(dict_id, compression_level);
+    if (cdict == nullptr) return cache.ContainsDict(dict_id) ? ERR_LOAD_CDICT : ERR_DICT_NOT_FOUND;
+
+    return CompressUsingDict(dest, src, *cdict);
+}
+
+
+// NOTE: CDict supersedes compression parameters, the others (checksum, workers, ...) apply.
+i64 ZstdCodec::CompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, ZstdCDictCache& cache, unsigned dict_id, const ZstdCompressionParams& params) const
+{
+    const auto cdict = cache.Get(dict_id, params);
+    if (cdict == nullptr) return cache.ContainsDict(dict_id) ? ERR_LOAD_CDICT : ERR_DICT_NOT_FOUND;
+
+    auto context = context_pool_.LeaseCompressContext();
+    if (context.fail()) return ERR_ALLOCATE_CCTX;
+
+    const auto param_rc = params.Apply(context.get());
+    if (ZSTD_isError(param_rc)) return ToResult(param_rc);
+
+    const auto ref_rc = ZSTD_CCtx_refCDict(context.get(), cdict->get());
+    if (ZSTD_isError(ref_rc)) return ToResult(ref_rc);
+
+    const auto rc = ZSTD_compress2(context.get(),
+                                   &dest[0], dest.size(),
+                                   &src[0], src.size());
+    return ToResult(rc);
+}
+
+
+i64 ZstdCodec::DecompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdDecompressionDict& ddict) const
 {
-    DecompressContext context;
+    auto context = context_pool_.LeaseDecompressContext();
     if (context.fail()) return ERR_ALLOCATE_DCTX;
 
     const auto rc = ZSTD_decompress_usingDDict(context.get(),
@@ -168,3 +309,241 @@ int ZstdCodec::DecompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const Zstd
     return ToResult(rc);
 }
 
+
+// NOTE: dictionary is picked by each frame, concatenated frames may use different ones (or none).
+i64 ZstdCodec::DecompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdDictRegistry& registry) const
+{
+    auto context = context_pool_.LeaseDecompressContext();
+    if (context.fail()) return ERR_ALLOCATE_DCTX;
+
+    usize src_pos = 0;
+    usize dest_pos = 0;
+    while (src_pos < src.size()) {
+        const auto frame = src.data() + src_pos;
+        const auto frame_size = ZSTD_findFrameCompressedSize(frame, src.size() - src_pos);
+        if (ZSTD_isError(frame_size)) return ToResult(frame_size);
+
+        ZstdDictRegistry::DDictPtr ddict;
+        const auto dict_id = ZSTD_getDictID_fromFrame(frame, frame_size);
+        if (dict_id != 0u) {
+            ddict = registry.Find(dict_id);
+            if (ddict == nullptr) {
+                TRACE_ERROR("decompress: dictionary %u is not registered", dict_id);
+                return ERR_DICT_NOT_FOUND;
+            }
+        }
+
+        // NOTE: null DDict decompresses without dictionary.
+        const auto rc = ZSTD_decompress_usingDDict(context.get(),
+                                                   dest.data() + dest_pos, dest.size() - dest_pos,
+                                                   frame, frame_size,
+                                                   ddict != nullptr ? ddict->get() : nullptr);
+        if (ZSTD_isError(rc)) return ToResult(rc);
+
+        src_pos += frame_size;
+        dest_pos += rc;
+    }
+
+    return ToResult(dest_pos);
+}
+
+
+i64 ZstdCodec::CompressBatch(Vec<u8>& dest, Vec<usize>& dest_offsets, const Vec<u8>& src, const Vec<usize>& src_offsets, int compression_level) const
+{
+    if (!IsValidBatch(src_offsets, src.size())) return ERR_UNKNOWN;
+    const auto item_count = src_offsets.size() - 1;
+
+    // NOTE: allocate the bound of the whole batch once, items are compressed in place.
+    usize dest_capacity = 0;
+    for (usize i = 0; i < item_count; ++i) {
+        const auto bound = ZSTD_compressBound(src_offsets[i + 1] - src_offsets[i]);
+        if (bound == 0u || bound > std::numeric_limits<usize>::max() - dest_capacity) return ERR_SIZE_TOO_LARGE;
+        dest_capacity += bound;
+    }
+
+    auto context = context_pool_.LeaseCompressContext();
+    if (context.fail()) return ERR_ALLOCATE_CCTX;
+
+    dest.resize(dest_capacity);
+    dest_offsets.resize(src_offsets.size());
+    dest_offsets[0] = 0;
+
+    usize dest_pos = 0;
+    for (usize i = 0; i < item_count; ++i) {
+        const auto rc = ZSTD_compressCCtx(context.get(),
+                                          dest.data() + dest_pos, dest_capacity - dest_pos,
+                                          src.data() + src_offsets[i], src_offsets[i + 1] - src_offsets[i],
+                                          compression_level);
+        if (ZSTD_isError(rc)) return ToResult(rc);
+
+        dest_pos += rc;
+        dest_offsets[i + 1] = dest_pos;
+    }
+
+    dest.resize(dest_pos);
+    return ToResult(dest_pos);
+}
+
+
+i64 ZstdCodec::DecompressBatch(Vec<u8>& dest, Vec<usize>& dest_offsets, const Vec<u8>& src, const Vec<usize>& src_offsets) const
+{
+    if (!IsValidBatch(src_offsets, src.size())) return ERR_UNKNOWN;
+
+    return DecompressFrames(dest, dest_offsets, src, src_offsets, 1);
+}
+
+
+i64 ZstdCodec::CompressParallel(Vec<u8>& dest, const Vec<u8>& src, int compression_level, int nb_threads, usize block_size) const
+{
+    ZstdCompressionParams params;
+    params.compression_level = compression_level;
+
+    return CompressParallel(dest, src, params, nb_threads, block_size);
+}
+
+
+i64 ZstdCodec::CompressParallel(Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionParams& params, int nb_threads, usize block_size) const
+{
+    if (block_size == 0u) block_size = PARALLEL_DEFAULT_BLOCK_SIZE;
+    if (nb_threads <= 0) nb_threads = ZstdThreadPool::HardwareThreads();
+    if (context_pool_.IsStatic()) nb_threads = 1;   // one context to lease
+
+    // NOTE: empty input still makes one (empty) frame.
+    const auto block_count = std::max<usize>(1u, src.size() / block_size + (src.size() % block_size != 0u ? 1u : 0u));
+    const auto block_bound = ZSTD_compressBound(std::min(block_size, src.size()));
+    if (ZSTD_isError(block_bound) || block_count > std::numeric_limits<usize>::max() / block_bound) return ERR_SIZE_TOO_LARGE;
+
+    // each block is compressed into its own slot of `dest`, then slots are packed in order.
+    dest.resize(block_count * block_bound);
+    Vec<i64> block_results(block_count, 0);
+
+    thread_pool_.ParallelFor(block_count, nb_threads, [&](usize i) {
+        auto context = context_pool_.LeaseCompressContext();
+        if (context.fail()) {
+            block_results[i] = ERR_ALLOCATE_CCTX;
+            return;
+        }
+
+        const auto param_rc = params.Apply(context.get());
+        if (ZSTD_isError(param_rc)) {
+            block_results[i] = ToResult(param_rc);
+            return;
+        }
+
+        const auto src_pos = i * block_size;
+        const auto rc = ZSTD_compress2(context.get(),
+                                       dest.data() + i * block_bound, block_bound,
+                                       src.data() + src_pos, std::min(block_size, src.size() - src_pos));
+        block_results[i] = ToResult(rc);
+    });
+
+    usize dest_pos = 0;
+    for (usize i = 0; i < block_count; ++i) {
+        const auto block_result = block_results[i];
+        if (block_result < 0) return block_result;
+
+        std::memmove(dest.data() + dest_pos, dest.data() + i * block_bound, static_cast<usize>(block_result));
+        dest_pos += static_cast<usize>(block_result);
+    }
+
+    dest.resize(dest_pos);
+    return ToResult(dest_pos);
+}
+
+
+i64 ZstdCodec::DecompressParallel(Vec<u8>& dest, const Vec<u8>& src, int nb_threads) const
+{
+    if (nb_threads <= 0) nb_threads = ZstdThreadPool::HardwareThreads();
+
+    // NOTE: skippable frames are indexed too, their content size is 0.
+    Vec<usize> src_offsets(1, 0u);
+    while (src_offsets.back() < src.size()) {
+        const auto frame_pos = src_offsets.back();
+        const auto frame_size = ZSTD_findFrameCompressedSize(src.data() + frame_pos, src.size() - frame_pos);
+        if (ZSTD_isError(frame_size)) return ToResult(frame_size);
+
+        src_offsets.push_back(frame_pos + frame_size);
+    }
+
+    Vec<usize> dest_offsets;
+    return DecompressFrames(dest, dest_offsets, src, src_offsets, nb_threads);
+}
+
+
+void ZstdCodec::ReleaseContexts()
+{
+    context_pool_.Clear();
+}
+
+
+int ZstdCodec::MaxWorkers()
+{
+    const auto bounds = ZSTD_cParam_getBounds(ZSTD_c_nbWorkers);
+    if (ZSTD_isError(bounds.error)) return 0;
+
+    return bounds.upperBound;
+}
+
+
+int ZstdCodec::ClampWorkers(int nb_workers)
+{
+    // NOTE: single-threaded zstd rejects nbWorkers >= 1, fall back to in-thread compression.
+    return std::max(0, std::min(nb_workers, MaxWorkers()));
+}
+
+
+// NOTE: output offsets come from the frame headers, so frames are decompressed into place concurrently.
+i64 ZstdCodec::DecompressFrames(Vec<u8>& dest, Vec<usize>& dest_offsets, const Vec<u8>& src, const Vec<usize>& src_offsets, int nb_threads) const
+{
+    const auto frame_count = src_offsets.size() - 1;
+
+    dest_offsets.resize(src_offsets.size());
+    dest_offsets[0] = 0;
+
+    for (usize i = 0; i < frame_count; ++i) {
+        const auto content_size = ToContentSizeResult(ZSTD_getFrameContentSize(src.data() + src_offsets[i],
+                                                                               src_offsets[i + 1] - src_offsets[i]));
+        if (content_size < 0) return content_size;
+        if (static_cast<u64>(content_size) > std::numeric_limits<usize>::max() - dest_offsets[i]) return ERR_SIZE_TOO_LARGE;
+
+        dest_offsets[i + 1] = dest_offsets[i] + static_cast<usize>(content_size);
+    }
+
+    dest.resize(dest_offsets.back());
+
+    // each thread leases one context, and takes the next frame until all of them are taken.
+    Vec<i64> frame_results(frame_count, 0);
+    std::atomic<usize> next_frame(0);
+    if (context_pool_.IsStatic()) nb_threads = 1;   // one context to lease
+    const auto nb_tasks = std::min(frame_count, static_cast<usize>(std::max(nb_threads, 1)));
+
+    thread_pool_.ParallelFor(nb_tasks, nb_threads, [&](usize) {
+        auto context = context_pool_.LeaseDecompressContext();
+
+        for (auto i = next_frame++; i < frame_count; i = next_frame++) {
+            if (context.fail()) {
+                frame_results[i] = ERR_ALLOCATE_DCTX;
+                continue;
+            }
+
+            const auto content_size = dest_offsets[i + 1] - dest_offsets[i];
+            const auto rc = ZSTD_decompressDCtx(context.get(),
+                                                dest.data() + dest_offsets[i], content_size,
+                                                src.data() + src_offsets[i], src_offsets[i + 1] - src_offsets[i]);
+            if (ZSTD_isError(rc)) {
+                frame_results[i] = ToResult(rc);
+            }
+            else if (rc != content_size) {
+                TRACE_ERROR("frame %u is %u bytes, frame header says %u",
+                            static_cast<unsigned>(i), static_cast<unsigned>(rc), static_cast<unsigned>(content_size));
+                frame_results[i] = ERR_UNKNOWN;
+            }
+        }
+    });
+
+    for (const auto frame_result : frame_results) {
+        if (frame_result < 0) return frame_result;
+    }
+
+    return ToResult(dest.size());
+}
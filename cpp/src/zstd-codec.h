@@ -2,21 +2,107 @@
 
 
 #include "common-types.h"
+#include "zstd-cdict-cache.h"
+#include "zstd-context-pool.h"
 #include "zstd-dict.h"
+#include "zstd-dict-registry.h"
+#include "zstd-params.h"
+#include "zstd-thread-pool.h"
+
+
+// NOTE: size-returning apis return a negative error code on failure.
+static const int ERR_UNKNOWN = -1;
+static const int ERR_SIZE_TOO_LARGE = -2;
+
+static const int ERR_ALLOCATE_CCTX = -3;
+static const int ERR_ALLOCATE_DCTX = -4;
+
+static const int ERR_LOAD_CDICT = -5;
+static const int ERR_LOAD_DDICT = -6;
+
+// frame header is valid, but it does not record the content size.
+static const int ERR_CONTENT_SIZE_UNKNOWN = -7;
+
+static const int ERR_TRAIN_DICT = -8;
+
+// dictionary ID is not in the registry (or CDict cache).
+static const int ERR_DICT_NOT_FOUND = -9;
+
+// sizes are exact on JavaScript numbers up to 2^53 - 1 (Number.MAX_SAFE_INTEGER).
+static const i64 MAX_RESULT_SIZE = (static_cast<i64>(1) << 53) - 1;
 
 
 class ZstdCodec
 {
 public:
+    static const usize PARALLEL_DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
+    ZstdCodec();
+    explicit ZstdCodec(std::shared_ptr<ZstdAllocator> allocator);   // contexts allocate through `allocator`
+
+    // static contexts, one compression and one decompression context initialized into workspaces (see ZstdWorkspace).
+    // calls never allocate a context, and fail when a workspace is too small or its context is in use by another call.
+    // parallel calls run on the calling thread, and zstd worker threads (`nb_workers`) are not available.
+    ZstdCodec(ZstdWorkspace cctx_workspace, ZstdWorkspace dctx_workspace);
+
+    // workspace sizes of static contexts: one-shot compression at `compression_level`, and decompression.
+    static usize StaticCompressWorkspaceSize(int compression_level);
+    static usize StaticDecompressWorkspaceSize();
+
     // information api
-    int CompressBound(usize src_size) const;
-    int ContentSize(const Vec<u8>& src) const;
+    i64 CompressBound(usize src_size) const;
+    i64 ContentSize(const Vec<u8>& src) const;
+    i64 FramesContentSize(const Vec<u8>& src) const;     // of all concatenated frames, unknown if any frame doesn't record it
+
+    // memory api, heap a context of one call needs (parallel calls need one per thread, zstd worker threads are not counted).
+    // `src_size` tunes parameters as zstd does for a known content size, 0 if unknown.
+    // compression estimates return a negative error code on invalid parameters.
+    static i64 EstimateCompressMemory(int compression_level, usize src_size = 0);
+    static i64 EstimateCompressMemory(const ZstdCompressionParams& params, usize src_size = 0);
+    static i64 EstimateDecompressMemory();
+    usize MemoryUsage() const;      // contexts kept for reuse, not the ones in use
 
     // simple api
-    int Compress(Vec<u8>& dest, const Vec<u8>& src, int compression_level) const;
-    int Decompress(Vec<u8>& dest, const Vec<u8>& src) const;
+    i64 Compress(Vec<u8>& dest, const Vec<u8>& src, int compression_level) const;
+    i64 Compress(Vec<u8>& dest, const Vec<u8>& src, int compression_level, int nb_workers) const;
+    i64 Compress(Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionParams& params) const;
+    i64 Decompress(Vec<u8>& dest, const Vec<u8>& src) const;
 
     // dictionary api
-    int CompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionDict& cdict) const;
-    int DecompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdDecompressionDict& ddict) const;
+    i64 CompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionDict& cdict) const;
+    i64 CompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, ZstdCDictCache& cache, unsigned dict_id, int compression_level) const;
+    i64 CompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, ZstdCDictCache& cache, unsigned dict_id, const ZstdCompressionParams& params) const;
+    i64 DecompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdDecompressionDict& ddict) const;
+    i64 DecompressUsingDict(Vec<u8>& dest, const Vec<u8>& src, const ZstdDictRegistry& registry) const;   // picks dictionary of each frame
+
+    // batch api, items are packed back to back: item i is [src_offsets[i], src_offsets[i + 1]) of `src`.
+    // outputs are packed the same way into `dest` and `dest_offsets`, one context serves the whole batch.
+    // returns packed output size. DecompressBatch needs the content size of every frame.
+    i64 CompressBatch(Vec<u8>& dest, Vec<usize>& dest_offsets, const Vec<u8>& src, const Vec<usize>& src_offsets, int compression_level) const;
+    i64 DecompressBatch(Vec<u8>& dest, Vec<usize>& dest_offsets, const Vec<u8>& src, const Vec<usize>& src_offsets) const;
+
+    // parallel api, `src` is split into `block_size` blocks compressed as independent frames,
+    // on `nb_threads` threads (0: hardware threads), and concatenated in order.
+    // any decompressor reads the output, smaller blocks scale better but compress worse.
+    // resizes `dest` to fit, returns compressed size.
+    i64 CompressParallel(Vec<u8>& dest, const Vec<u8>& src, int compression_level, int nb_threads, usize block_size = PARALLEL_DEFAULT_BLOCK_SIZE) const;
+    i64 CompressParallel(Vec<u8>& dest, const Vec<u8>& src, const ZstdCompressionParams& params, int nb_threads, usize block_size = PARALLEL_DEFAULT_BLOCK_SIZE) const;
+
+    // decompresses concatenated frames concurrently, each one into its offset from the frame headers.
+    // needs the content size of every frame (ERR_CONTENT_SIZE_UNKNOWN). resizes `dest` to fit, returns decompressed size.
+    i64 DecompressParallel(Vec<u8>& dest, const Vec<u8>& src, int nb_threads) const;
+
+    // context api
+    void ReleaseContexts();
+
+    // multi-threading api, returns 0 if zstd is built without ZSTD_MULTITHREAD.
+    static int MaxWorkers();
+    static int ClampWorkers(int nb_workers);
+
+private:
+    i64 DecompressFrames(Vec<u8>& dest, Vec<usize>& dest_offsets, const Vec<u8>& src, const Vec<usize>& src_offsets, int nb_threads) const;
+
+    // NOTE: contexts are reused across calls, to skip workspace allocations.
+    mutable ZstdContextPool context_pool_;
+    mutable ZstdThreadPool thread_pool_;
 };
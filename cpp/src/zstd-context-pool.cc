@@ -0,0 +1,169 @@
+#include "zstd.h"
+#include "zstd-context-pool.h"
+
+
+static void FreeCCtx(ZSTD_CCtx* cctx)
+{
+    ZSTD_freeCCtx(cctx);
+}
+
+
+static void FreeDCtx(ZSTD_DCtx* dctx)
+{
+    ZSTD_freeDCtx(dctx);
+}
+
+
+// NOTE: static contexts live in their workspaces, nothing to free.
+static void KeepCCtx(ZSTD_CCtx*)
+{
+}
+
+
+static void KeepDCtx(ZSTD_DCtx*)
+{
+}
+
+
+//
+// ZstdContextPool
+//
+////////////////////////////////////////////////////////////////////////////////
+
+ZstdContextPool::ZstdContextPool(usize max_idle_contexts, std::shared_ptr<ZstdAllocator> allocator)
+    : allocator_(std::move(allocator))
+    , cctx_workspace_()
+    , dctx_workspace_()
+    , static_(false)
+    , mutex_()
+    , max_idle_contexts_(max_idle_contexts)
+    , idle_cctxs_()
+    , idle_dctxs_()
+{
+}
+
+
+ZstdContextPool::ZstdContextPool(ZstdWorkspace cctx_workspace, ZstdWorkspace dctx_workspace)
+    : allocator_()
+    , cctx_workspace_(std::move(cctx_workspace))
+    , dctx_workspace_(std::move(dctx_workspace))
+    , static_(true)
+    , mutex_()
+    , max_idle_contexts_(1)
+    , idle_cctxs_()
+    , idle_dctxs_()
+{
+    // NOTE: null when the workspace is too small (or misaligned), leases fail then.
+    const auto cctx = ZSTD_initStaticCCtx(cctx_workspace_.data(), cctx_workspace_.size());
+    if (cctx != nullptr) idle_cctxs_.push_back(CCtxPtr(cctx, KeepCCtx));
+
+    const auto dctx = ZSTD_initStaticDCtx(dctx_workspace_.data(), dctx_workspace_.size());
+    if (dctx != nullptr) idle_dctxs_.push_back(DCtxPtr(dctx, KeepDCtx));
+}
+
+
+ZstdContextPool::~ZstdContextPool()
+{
+}
+
+
+ZstdContextPool::CompressLease ZstdContextPool::LeaseCompressContext()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_cctxs_.empty()) {
+            auto cctx = idle_cctxs_.back().release();
+            idle_cctxs_.pop_back();
+            return CompressLease(this, cctx);
+        }
+    }
+
+    if (static_) return CompressLease(this, nullptr);
+    return CompressLease(this, CreateCCtx(allocator_.get()));
+}
+
+
+ZstdContextPool::DecompressLease ZstdContextPool::LeaseDecompressContext()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!idle_dctxs_.empty()) {
+            auto dctx = idle_dctxs_.back().release();
+            idle_dctxs_.pop_back();
+            return DecompressLease(this, dctx);
+        }
+    }
+
+    if (static_) return DecompressLease(this, nullptr);
+    return DecompressLease(this, CreateDCtx(allocator_.get()));
+}
+
+
+usize ZstdContextPool::IdleCompressContexts() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_cctxs_.size();
+}
+
+
+usize ZstdContextPool::IdleDecompressContexts() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_dctxs_.size();
+}
+
+
+usize ZstdContextPool::MemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    usize memory = 0;
+    for (const auto& cctx : idle_cctxs_) memory += ZSTD_sizeof_CCtx(cctx.get());
+    for (const auto& dctx : idle_dctxs_) memory += ZSTD_sizeof_DCtx(dctx.get());
+
+    return memory;
+}
+
+
+bool ZstdContextPool::IsStatic() const
+{
+    return static_;
+}
+
+
+void ZstdContextPool::Clear()
+{
+    if (static_) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_cctxs_.clear();
+    idle_dctxs_.clear();
+}
+
+
+void ZstdContextPool::Release(ZSTD_CCtx* cctx)
+{
+    // reset here, so that a leased context never carries parameters or a
+    // dictionary over from the previous user.
+    CCtxPtr context(cctx, static_ ? KeepCCtx : FreeCCtx);
+    const auto rc = ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+    if (ZSTD_isError(rc) && !static_) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_cctxs_.size() < max_idle_contexts_) {
+        idle_cctxs_.push_back(std::move(context));
+    }
+}
+
+
+void ZstdContextPool::Release(ZSTD_DCtx* dctx)
+{
+    DCtxPtr context(dctx, static_ ? KeepDCtx : FreeDCtx);
+    const auto rc = ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters);
+    if (ZSTD_isError(rc) && !static_) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_dctxs_.size() < max_idle_contexts_) {
+        idle_dctxs_.push_back(std::move(context));
+    }
+}
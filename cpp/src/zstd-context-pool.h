@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "common-types.h"
+#include "zstd-allocator.h"
+#include "zstd-workspace.h"
+
+
+/*
+ZstdContextPool keeps released compression/decompression contexts alive,
+so that repeated calls reuse them instead of allocating new workspaces.
+
+a context goes back to the pool when its lease is destroyed, reset (session and parameters) on the way,
+so that the next lease never carries parameters or a dictionary over.
+a context whose reset fails is freed instead, as are contexts over `max_idle_contexts`.
+
+contexts allocate through `allocator` when given, the pool keeps it alive while they do.
+
+static pool holds one context of each kind initialized into workspaces, and never allocates one.
+a lease fails while the context is leased, and Clear() (or a failed reset) keeps them.
+*/
+class ZstdContextPool
+{
+public:
+    template <typename T>
+    class Lease
+    {
+    public:
+        Lease(ZstdContextPool* pool, T* context)
+            : pool_(pool)
+            , context_(context)
+        {
+        }
+
+        Lease(Lease&& other)
+            : pool_(other.pool_)
+            , context_(other.context_)
+        {
+            other.context_ = nullptr;
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        ~Lease()
+        {
+            if (context_ != nullptr) pool_->Release(context_);
+        }
+
+        T* get() const { return context_; }
+        bool fail() const { return context_ == nullptr; }
+
+    private:
+        ZstdContextPool*    pool_;
+        T*                  context_;
+    };
+
+    using CompressLease = Lease<ZSTD_CCtx_s>;
+    using DecompressLease = Lease<ZSTD_DCtx_s>;
+
+    explicit ZstdContextPool(usize max_idle_contexts = 4, std::shared_ptr<ZstdAllocator> allocator = nullptr);
+    ZstdContextPool(ZstdWorkspace cctx_workspace, ZstdWorkspace dctx_workspace);
+    ~ZstdContextPool();
+
+    ZstdContextPool(const ZstdContextPool&) = delete;
+    ZstdContextPool& operator=(const ZstdContextPool&) = delete;
+
+    CompressLease LeaseCompressContext();
+    DecompressLease LeaseDecompressContext();
+
+    usize IdleCompressContexts() const;
+    usize IdleDecompressContexts() const;
+    usize MemoryUsage() const;      // ZSTD_sizeof_CCtx/DCtx of idle contexts
+    bool IsStatic() const;
+
+    // free all idle contexts, leased contexts are not affected.
+    void Clear();
+
+private:
+    using CCtxPtr = std::unique_ptr<ZSTD_CCtx_s, void(*)(ZSTD_CCtx_s*)>;
+    using DCtxPtr = std::unique_ptr<ZSTD_DCtx_s, void(*)(ZSTD_DCtx_s*)>;
+
+    void Release(ZSTD_CCtx_s* cctx);
+    void Release(ZSTD_DCtx_s* dctx);
+
+    std::shared_ptr<ZstdAllocator>  allocator_;     // outlives idle contexts
+    ZstdWorkspace                   cctx_workspace_;
+    ZstdWorkspace                   dctx_workspace_;
+    bool                            static_;
+
+    mutable std::mutex  mutex_;
+    usize               max_idle_contexts_;
+    Vec<CCtxPtr>        idle_cctxs_;
+    Vec<DCtxPtr>        idle_dctxs_;
+};
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <atomic>
+
+#include "zstd-codec.h"
+#include "zstd-dict.h"
+#include "zstd-dict-registry.h"
+#include "zstd-trace.h"
+
+
+//
+// ZstdDictRegistry
+//
+///////////////////////////////////////////////////////////////////////////////
+
+ZstdDictRegistry::ZstdDictRegistry()
+    : write_mutex_()
+    , table_(std::make_shared<Table>())
+{
+}
+
+
+ZstdDictRegistry::~ZstdDictRegistry()
+{
+}
+
+
+i64 ZstdDictRegistry::Add(const Vec<u8>& dict_bytes)
+{
+    return Add(std::make_shared<const ZstdDecompressionDict>(dict_bytes));
+}
+
+
+i64 ZstdDictRegistry::Add(Vec<u8>&& dict_bytes)
+{
+    return Add(std::make_shared<const ZstdDecompressionDict>(std::move(dict_bytes)));
+}
+
+
+i64 ZstdDictRegistry::Add(const u8* dict_bytes, usize dict_size)
+{
+    return Add(std::make_shared<const ZstdDecompressionDict>(dict_bytes, dict_size));
+}
+
+
+i64 ZstdDictRegistry::Add(DDictPtr ddict)
+{
+    if (ddict->fail()) return ERR_LOAD_DDICT;
+
+    // NOTE: raw content dictionaries have no ID, frames can't tell they need them.
+    const auto dict_id = ZSTD_getDictID_fromDDict(ddict->get());
+    if (dict_id == 0u) {
+        TRACE_ERROR("dict registry: dictionary has no ID");
+        return ERR_LOAD_DDICT;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    auto table = std::make_shared<Table>(*Snapshot());
+    const auto it = std::lower_bound(std::begin(*table), std::end(*table), dict_id, [](const Entry& entry, unsigned id) {
+        return entry.dict_id < id;
+    });
+
+    if (it != std::end(*table) && it->dict_id == dict_id) {
+        it->ddict = std::move(ddict);
+    }
+    else {
+        table->insert(it, Entry { dict_id, std::move(ddict) });
+    }
+
+    Publish(std::move(table));
+    return static_cast<i64>(dict_id);
+}
+
+
+bool ZstdDictRegistry::Remove(unsigned dict_id)
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    auto table = std::make_shared<Table>(*Snapshot());
+    const auto it = std::find_if(std::begin(*table), std::end(*table), [dict_id](const Entry& entry) {
+        return entry.dict_id == dict_id;
+    });
+    if (it == std::end(*table)) return false;
+
+    table->erase(it);
+    Publish(std::move(table));
+    return true;
+}
+
+
+void ZstdDictRegistry::Clear()
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    Publish(std::make_shared<Table>());
+}
+
+
+usize ZstdDictRegistry::Count() const
+{
+    return Snapshot()->size();
+}
+
+
+bool ZstdDictRegistry::Contains(unsigned dict_id) const
+{
+    return Find(dict_id) != nullptr;
+}
+
+
+ZstdDictRegistry::DDictPtr ZstdDictRegistry::Find(unsigned dict_id) const
+{
+    const auto table = Snapshot();
+    const auto it = std::lower_bound(std::begin(*table), std::end(*table), dict_id, [](const Entry& entry, unsigned id) {
+        return entry.dict_id < id;
+    });
+
+    if (it == std::end(*table) || it->dict_id != dict_id) return nullptr;
+    return it->ddict;
+}
+
+
+ZstdDictRegistry::TablePtr ZstdDictRegistry::Snapshot() const
+{
+    return std::atomic_load(&table_);
+}
+
+
+void ZstdDictRegistry::Publish(TablePtr table)
+{
+    std::atomic_store(&table_, std::move(table));
+}
+
+
+//
+// ZstdFrameDictSelector
+//
+///////////////////////////////////////////////////////////////////////////////
+
+ZstdFrameDictSelector::ZstdFrameDictSelector(const ZstdDictRegistry& registry)
+    : registry_(registry)
+    , ddict_()
+    , header_bytes_()
+{
+}
+
+
+ZstdFrameDictSelector::Result ZstdFrameDictSelector::Select(ZSTD_DStream* dstream, ZSTD_inBuffer& input)
+{
+    const auto src = static_cast<const u8*>(input.src);
+
+    // most frames start within a chunk, peek the header in place.
+    if (header_bytes_.empty()) {
+        ZSTD_frameHeader header;
+        const auto rc = ZSTD_getFrameHeader(&header, src + input.pos, input.size - input.pos);
+        if (ZSTD_isError(rc)) {
+            TRACE_ERROR("dict selector: %s", ZSTD_getErrorName(rc));
+            return Result::Error;
+        }
+        else if (rc == 0u) {
+            return Reference(dstream, header.dictID) ? Result::Selected : Result::Error;
+        }
+    }
+
+    // otherwise stage bytes until the header is complete, it's 18 bytes at most.
+    for (;;) {
+        ZSTD_frameHeader header;
+        const auto rc = ZSTD_getFrameHeader(&header, header_bytes_.data(), header_bytes_.size());
+        if (ZSTD_isError(rc)) {
+            TRACE_ERROR("dict selector: %s", ZSTD_getErrorName(rc));
+            return Result::Error;
+        }
+        else if (rc == 0u) {
+            if (!Reference(dstream, header.dictID)) return Result::Error;
+
+            // NOTE: header only, zstd doesn't write any output yet.
+            ZSTD_inBuffer staged { header_bytes_.data(), header_bytes_.size(), 0 };
+            ZSTD_outBuffer output { nullptr, 0, 0 };
+            const auto decompress_rc = ZSTD_decompressStream(dstream, &output, &staged);
+            header_bytes_.clear();
+
+            if (ZSTD_isError(decompress_rc)) {
+                TRACE_ERROR("ZSTD_decompressStream: %s", ZSTD_getErrorName(decompress_rc));
+                return Result::Error;
+            }
+
+            return Result::Selected;
+        }
+        else if (input.pos == input.size) {
+            return Result::NeedMoreInput;
+        }
+
+        const auto copy_size = std::min(rc - header_bytes_.size(), input.size - input.pos);
+        header_bytes_.insert(std::end(header_bytes_), src + input.pos, src + input.pos + copy_size);
+        input.pos += copy_size;
+    }
+}
+
+
+bool ZstdFrameDictSelector::HasStagedHeader() const
+{
+    return !header_bytes_.empty();
+}
+
+
+bool ZstdFrameDictSelector::Reference(ZSTD_DStream* dstream, unsigned dict_id)
+{
+    ddict_.reset();
+
+    if (dict_id != 0u) {
+        ddict_ = registry_.Find(dict_id);
+        if (ddict_ == nullptr) {
+            TRACE_ERROR("dict selector: dictionary %u is not registered", dict_id);
+            return false;
+        }
+    }
+
+    const auto rc = ZSTD_DCtx_refDDict(dstream, ddict_ != nullptr ? ddict_->get() : nullptr);
+    if (ZSTD_isError(rc)) {
+        TRACE_ERROR("ZSTD_DCtx_refDDict: %s", ZSTD_getErrorName(rc));
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "common-types.h"
+#include "zstd.h"
+
+
+class ZstdDecompressionDict;
+
+
+/*
+ZstdDictRegistry holds decompression dictionaries keyed by dictionary ID,
+to pick the dictionary of a frame from its header (ZSTD_getDictID_fromFrame).
+
+lookups read an immutable snapshot of the table and never wait on the writers' lock,
+Add/Remove/Clear copy the table under the lock and publish a new snapshot.
+found dictionaries stay alive while the caller holds them, even if removed meanwhile.
+
+NOTE: not lock-free, snapshots are loaded with std::atomic_load of shared_ptr,
+      which standard libraries guard with a short internal (spin)lock, and share the refcount of the table.
+*/
+class ZstdDictRegistry
+{
+public:
+    using DDictPtr = std::shared_ptr<const ZstdDecompressionDict>;
+
+    ZstdDictRegistry();
+    ~ZstdDictRegistry();
+
+    // returns dictionary ID, or a negative error code (ERR_* in zstd-codec.h).
+    // a dictionary replaces the registered one with the same ID.
+    // loading ways are the same as ZstdDecompressionDict, see zstd-dict.h
+    i64 Add(const Vec<u8>& dict_bytes);
+    i64 Add(Vec<u8>&& dict_bytes);
+    i64 Add(const u8* dict_bytes, usize dict_size);
+    bool Remove(unsigned dict_id);
+    void Clear();
+
+    usize Count() const;
+    bool Contains(unsigned dict_id) const;
+    DDictPtr Find(unsigned dict_id) const;
+
+private:
+    struct Entry
+    {
+        unsigned    dict_id;
+        DDictPtr    ddict;
+    };
+
+    using Table = Vec<Entry>;   // sorted by dict_id
+    using TablePtr = std::shared_ptr<const Table>;
+
+    i64 Add(DDictPtr ddict);
+    TablePtr Snapshot() const;
+    void Publish(TablePtr table);
+
+    std::mutex  write_mutex_;
+    TablePtr    table_;
+};
+
+
+/*
+ZstdFrameDictSelector references the registered dictionary of each frame on a DStream.
+
+call Select() at the start of every frame, before feeding the frame to ZSTD_decompressStream.
+a frame header split across chunks is staged, and fed to the DStream once it is complete.
+
+frames without dictionary ID are decompressed without dictionary.
+*/
+class ZstdFrameDictSelector
+{
+public:
+    enum class Result
+    {
+        Selected,       // rest of `input` belongs to the frame
+        NeedMoreInput,  // `input` is consumed, header is incomplete
+        Error,
+    };
+
+    explicit ZstdFrameDictSelector(const ZstdDictRegistry& registry);
+
+    Result Select(ZSTD_DStream* dstream, ZSTD_inBuffer& input);
+    bool HasStagedHeader() const;
+
+private:
+    bool Reference(ZSTD_DStream* dstream, unsigned dict_id);
+
+    const ZstdDictRegistry&     registry_;
+    ZstdDictRegistry::DDictPtr  ddict_;         // dictionary of the current frame
+    Vec<u8>                     header_bytes_;
+};
@@ -0,0 +1,143 @@
+#include <cstring>
+
+#define ZDICT_STATIC_LINKING_ONLY
+#include "zdict.h"
+#include "zstd-codec.h"
+#include "zstd-dict-trainer.h"
+#include "zstd-trace.h"
+
+
+template <typename T>
+static void ApplyTrainingParams(T& zdict_params, const ZstdDictTrainingParams& params)
+{
+    std::memset(&zdict_params, 0, sizeof(zdict_params));
+
+    zdict_params.k = static_cast<unsigned>(params.k);
+    zdict_params.d = static_cast<unsigned>(params.d);
+    zdict_params.steps = static_cast<unsigned>(params.steps);
+    zdict_params.nbThreads = static_cast<unsigned>(params.nb_threads);
+    zdict_params.splitPoint = params.split_point;
+    zdict_params.zParams.compressionLevel = params.compression_level;
+}
+
+
+static i64 ToTrainResult(size_t rc, Vec<u8>& dict)
+{
+    if (ZDICT_isError(rc)) {
+        TRACE_ERROR("dictionary training: %s", ZDICT_getErrorName(rc));
+        dict.clear();
+        return ERR_TRAIN_DICT;
+    }
+
+    dict.resize(rc);
+    return static_cast<i64>(rc);
+}
+
+
+//
+// ZstdDictTrainingParams
+//
+///////////////////////////////////////////////////////////////////////////////
+
+ZstdDictTrainingParams::ZstdDictTrainingParams()
+    : k(0)
+    , d(0)
+    , f(0)
+    , steps(0)
+    , accel(0)
+    , nb_threads(0)
+    , split_point(0.0)
+    , compression_level(0)
+{
+}
+
+
+//
+// ZstdDictTrainer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+ZstdDictTrainer::ZstdDictTrainer()
+    : samples_()
+    , sample_sizes_()
+{
+}
+
+
+void ZstdDictTrainer::AddSample(const Vec<u8>& sample)
+{
+    AddSample(sample.data(), sample.size());
+}
+
+
+void ZstdDictTrainer::AddSample(const u8* sample, usize sample_size)
+{
+    // NOTE: ZDICT takes samples as one concatenated buffer and their sizes.
+    samples_.insert(samples_.end(), sample, sample + sample_size);
+    sample_sizes_.push_back(sample_size);
+}
+
+
+void ZstdDictTrainer::Clear()
+{
+    samples_.clear();
+    sample_sizes_.clear();
+}
+
+
+usize ZstdDictTrainer::SampleCount() const
+{
+    return sample_sizes_.size();
+}
+
+
+usize ZstdDictTrainer::SamplesSize() const
+{
+    return samples_.size();
+}
+
+
+i64 ZstdDictTrainer::Train(Vec<u8>& dict, usize dict_capacity) const
+{
+    dict.resize(dict_capacity);
+    const auto rc = ZDICT_trainFromBuffer(dict.data(), dict.size(),
+                                          samples_.data(), sample_sizes_.data(),
+                                          static_cast<unsigned>(sample_sizes_.size()));
+    return ToTrainResult(rc, dict);
+}
+
+
+i64 ZstdDictTrainer::TrainCover(Vec<u8>& dict, usize dict_capacity, const ZstdDictTrainingParams& params) const
+{
+    ZDICT_cover_params_t cover_params;
+    ApplyTrainingParams(cover_params, params);
+
+    dict.resize(dict_capacity);
+    const auto rc = ZDICT_optimizeTrainFromBuffer_cover(dict.data(), dict.size(),
+                                                        samples_.data(), sample_sizes_.data(),
+                                                        static_cast<unsigned>(sample_sizes_.size()),
+                                                        &cover_params);
+    return ToTrainResult(rc, dict);
+}
+
+
+i64 ZstdDictTrainer::TrainFastCover(Vec<u8>& dict, usize dict_capacity, const ZstdDictTrainingParams& params) const
+{
+    ZDICT_fastCover_params_t fast_cover_params;
+    ApplyTrainingParams(fast_cover_params, params);
+    fast_cover_params.f = static_cast<unsigned>(params.f);
+    fast_cover_params.accel = static_cast<unsigned>(params.accel);
+
+    dict.resize(dict_capacity);
+    const auto rc = ZDICT_optimizeTrainFromBuffer_fastCover(dict.data(), dict.size(),
+                                                            samples_.data(), sample_sizes_.data(),
+                                                            static_cast<unsigned>(sample_sizes_.size()),
+                                                            &fast_cover_params);
+    return ToTrainResult(rc, dict);
+}
+
+
+unsigned ZstdDictTrainer::DictID(const Vec<u8>& dict)
+{
+    return ZDICT_getDictID(dict.data(), dict.size());
+}
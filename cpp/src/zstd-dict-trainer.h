@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common-types.h"
+
+
+/*
+ZstdDictTrainingParams holds parameters of cover/fastCover training.
+
+0 means "let zstd optimize it" for k, d, f and steps,
+the same convention as ZDICT_optimizeTrainFromBuffer_cover.
+*/
+struct ZstdDictTrainingParams
+{
+    ZstdDictTrainingParams();
+
+    int     k;                  // segment size
+    int     d;                  // dmer size
+    int     f;                  // log of frequency array size, fastCover only
+    int     steps;              // number of k tried while optimizing
+    int     accel;              // fastCover only, 1 (default) .. 10
+    int     nb_threads;         // effective on multi-threaded zstd builds only
+    double  split_point;        // ratio of samples used for training, the rest for testing. 0 means 1.0
+    int     compression_level;  // level the dictionary is optimized for, 0 means default
+};
+
+
+/*
+ZstdDictTrainer collects samples, then trains a dictionary from them
+with ZDICT_trainFromBuffer, ZDICT_optimizeTrainFromBuffer_cover or
+ZDICT_optimizeTrainFromBuffer_fastCover.
+
+Train* resizes `dict` to the trained dictionary and returns its size,
+or a negative error code (ERR_* in zstd-codec.h).
+*/
+class ZstdDictTrainer
+{
+public:
+    ZstdDictTrainer();
+
+    void AddSample(const Vec<u8>& sample);
+    void AddSample(const u8* sample, usize sample_size);
+    void Clear();
+
+    usize SampleCount() const;
+    usize SamplesSize() const;
+
+    i64 Train(Vec<u8>& dict, usize dict_capacity) const;
+    i64 TrainCover(Vec<u8>& dict, usize dict_capacity, const ZstdDictTrainingParams& params) const;
+    i64 TrainFastCover(Vec<u8>& dict, usize dict_capacity, const ZstdDictTrainingParams& params) const;
+
+    // returns 0 if `dict` is not a zstd dictionary (e.g. raw content).
+    static unsigned DictID(const Vec<u8>& dict);
+
+private:
+    Vec<u8>     samples_;
+    Vec<size_t> sample_sizes_;
+};
@@ -1,49 +1,150 @@
 #include "zstd.h"
 #include "zstd-dict.h"
+#include "zstd-params.h"
 
 
-static void CloseCDict(ZSTD_CDict_s* cdict)
+void ZstdCDictDeleter::operator()(ZSTD_CDict_s* cdict) const
 {
     ZSTD_freeCDict(cdict);
 }
 
 
-static void CloseDDict(ZSTD_DDict_s* ddict)
+void ZstdDDictDeleter::operator()(ZSTD_DDict_s* ddict) const
 {
     ZSTD_freeDDict(ddict);
 }
 
 
+// NOTE: level only parameters keep zstd's per-input tuning of the level (ZSTD_createCDict_byReference).
+static ZSTD_CDict* CreateCDictByReference(const u8* dict_bytes, usize dict_size, const ZstdCompressionParams& params)
+{
+    if (!params.HasCompressionParams()) {
+        return ZSTD_createCDict_byReference(dict_bytes, dict_size, params.compression_level);
+    }
+
+    auto cparams = ZSTD_getCParams(params.compression_level, 0, dict_size);
+    if (params.window_log != 0) cparams.windowLog = params.window_log;
+    if (params.hash_log != 0) cparams.hashLog = params.hash_log;
+    if (params.chain_log != 0) cparams.chainLog = params.chain_log;
+    if (params.search_log != 0) cparams.searchLog = params.search_log;
+    if (params.min_match != 0) cparams.minMatch = params.min_match;
+    if (params.target_length != 0) cparams.targetLength = params.target_length;
+    if (params.strategy != 0) cparams.strategy = static_cast<ZSTD_strategy>(params.strategy);
+
+    if (ZSTD_isError(ZSTD_checkCParams(cparams))) return nullptr;
+
+    return ZSTD_createCDict_advanced(dict_bytes, dict_size, ZSTD_dlm_byRef, ZSTD_dct_auto, cparams, ZSTD_defaultCMem);
+}
+
+
 //
 // ZstdCompressionDict
 //
 ////////////////////////////////////////////////////////////////////////////////
 
 ZstdCompressionDict::ZstdCompressionDict(const Vec<u8>& dict_bytes, int compression_level)
-    : Resource(ZSTD_createCDict(&dict_bytes[0], dict_bytes.size(), compression_level), CloseCDict)
+    : Resource(ZSTD_createCDict(&dict_bytes[0], dict_bytes.size(), compression_level))
+    , owned_bytes_()
 {
 }
 
 
+// NOTE: moving a vector keeps its buffer, so the content referenced by zstd stays in place.
+ZstdCompressionDict::ZstdCompressionDict(Vec<u8>&& dict_bytes, int compression_level)
+    : Resource(ZSTD_createCDict_byReference(dict_bytes.data(), dict_bytes.size(), compression_level))
+    , owned_bytes_(std::move(dict_bytes))
+{
+}
+
+
+ZstdCompressionDict::ZstdCompressionDict(const u8* dict_bytes, usize dict_size, int compression_level)
+    : Resource(ZSTD_createCDict_byReference(dict_bytes, dict_size, compression_level))
+    , owned_bytes_()
+{
+}
+
+
+ZstdCompressionDict::ZstdCompressionDict(const u8* dict_bytes, usize dict_size, const ZstdCompressionParams& params)
+    : Resource(CreateCDictByReference(dict_bytes, dict_size, params))
+    , owned_bytes_()
+{
+}
+
+
+ZstdCompressionDict::~ZstdCompressionDict()
+{
+    // free CDict before the content it references.
+    Close();
+}
+
+
 bool ZstdCompressionDict::fail() const
 {
     return get() == nullptr;
 }
 
 
+usize ZstdCompressionDict::MemoryUsage() const
+{
+    return ZSTD_sizeof_CDict(get()) + owned_bytes_.capacity();
+}
+
+
+// NOTE: content is copied or referenced depending on how it is loaded, the estimate counts it either way.
+usize ZstdCompressionDict::EstimateMemory(usize dict_size, int compression_level)
+{
+    return ZSTD_estimateCDictSize(dict_size, compression_level);
+}
+
+
 //
 // ZstdDecompressionDict
 //
 ////////////////////////////////////////////////////////////////////////////////
 
 ZstdDecompressionDict ::ZstdDecompressionDict(const Vec<u8>& dict_bytes)
-    : Resource(ZSTD_createDDict(&dict_bytes[0], dict_bytes.size()), CloseDDict)
+    : Resource(ZSTD_createDDict(&dict_bytes[0], dict_bytes.size()))
+    , owned_bytes_()
 {
 }
 
 
+// NOTE: moving a vector keeps its buffer, so the content referenced by zstd stays in place.
+ZstdDecompressionDict::ZstdDecompressionDict(Vec<u8>&& dict_bytes)
+    : Resource(ZSTD_createDDict_byReference(dict_bytes.data(), dict_bytes.size()))
+    , owned_bytes_(std::move(dict_bytes))
+{
+}
+
+
+ZstdDecompressionDict::ZstdDecompressionDict(const u8* dict_bytes, usize dict_size)
+    : Resource(ZSTD_createDDict_byReference(dict_bytes, dict_size))
+    , owned_bytes_()
+{
+}
+
+
+ZstdDecompressionDict::~ZstdDecompressionDict()
+{
+    // free DDict before the content it references.
+    Close();
+}
+
+
 bool ZstdDecompressionDict::fail() const
 {
     return get() == nullptr;
 }
 
+
+usize ZstdDecompressionDict::MemoryUsage() const
+{
+    return ZSTD_sizeof_DDict(get()) + owned_bytes_.capacity();
+}
+
+
+// NOTE: content is copied or referenced depending on how it is loaded, the estimate counts it either way.
+usize ZstdDecompressionDict::EstimateMemory(usize dict_size)
+{
+    return ZSTD_estimateDDictSize(dict_size, ZSTD_dlm_byCopy);
+}
@@ -9,21 +9,68 @@ struct ZSTD_CDict_s;    // orginal struct of ZSTD_CDict
 struct ZSTD_DDict_s;    // orginal struct of ZSTD_DDict
 }
 
+struct ZstdCompressionParams;
 
-class ZstdCompressionDict : public Resource<ZSTD_CDict_s>
+
+// NOTE: compile-time deleters, dictionaries close with a direct call.
+struct ZstdCDictDeleter
+{
+    void operator()(ZSTD_CDict_s* cdict) const;
+};
+
+
+struct ZstdDDictDeleter
+{
+    void operator()(ZSTD_DDict_s* ddict) const;
+};
+
+
+/*
+dictionaries are loaded in one of the following ways:
+
+- `const Vec<u8>&`: zstd copies the content.
+- `Vec<u8>&&`: the dictionary takes the vector, zstd references it (ZSTD_dlm_byRef).
+- `const u8*, usize`: zstd references caller-owned memory (e.g. memory-mapped file).
+  the dictionary neither copies nor frees it, the caller keeps it valid and unmodified
+  until the dictionary is destroyed (streams and caches holding the dictionary included).
+  frames don't reference dictionary memory, compressed data outlives both.
+
+a compression dictionary is digested for the compression level (or parameters) it is created with.
+*/
+class ZstdCompressionDict : public Resource<ZSTD_CDict_s, ZstdCDictDeleter>
 {
 public:
     ZstdCompressionDict(const Vec<u8>& dict_bytes, int compression_level);
+    ZstdCompressionDict(Vec<u8>&& dict_bytes, int compression_level);
+    ZstdCompressionDict(const u8* dict_bytes, usize dict_size, int compression_level);
+    ZstdCompressionDict(const u8* dict_bytes, usize dict_size, const ZstdCompressionParams& params);
+    ~ZstdCompressionDict();
 
     bool fail() const;
+    usize MemoryUsage() const;      // ZSTD_sizeof_CDict and the content it owns
+
+    // heap a dictionary of `dict_size` bytes digested for `compression_level` needs.
+    static usize EstimateMemory(usize dict_size, int compression_level);
+
+private:
+    Vec<u8> owned_bytes_;   // empty unless loaded from `Vec<u8>&&`
 };
 
 
-class ZstdDecompressionDict : public Resource<ZSTD_DDict_s>
+class ZstdDecompressionDict : public Resource<ZSTD_DDict_s, ZstdDDictDeleter>
 {
 public:
     ZstdDecompressionDict(const Vec<u8>& dict_bytes);
+    ZstdDecompressionDict(Vec<u8>&& dict_bytes);
+    ZstdDecompressionDict(const u8* dict_bytes, usize dict_size);
+    ~ZstdDecompressionDict();
 
     bool fail() const;
-};
+    usize MemoryUsage() const;      // ZSTD_sizeof_DDict and the content it owns
 
+    // heap a dictionary of `dict_size` bytes needs.
+    static usize EstimateMemory(usize dict_size);
+
+private:
+    Vec<u8> owned_bytes_;   // empty unless loaded from `Vec<u8>&&`
+};
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "zstd.h"
+#include "zstd_errors.h"
+#include "zstd-codec.h"
+#include "zstd-params.h"
+
+
+// NOTE: zstd estimates take long distance matching parameters as they are set, not derived from the strategy.
+//       same values as ZSTD_ldm_adjustParameters derives when compressing.
+static size_t SetLdmParams(ZSTD_CCtx_params* cctx_params, const ZSTD_compressionParameters& cparams)
+{
+    const auto strategy = static_cast<int>(cparams.strategy);
+    const auto hash_rate_log = 7 - strategy / 3;
+    const auto window_log = static_cast<int>(cparams.windowLog);
+    const std::pair<ZSTD_cParameter, int> params[] = {
+        { ZSTD_c_enableLongDistanceMatching, 1 },
+        { ZSTD_c_ldmHashRateLog, hash_rate_log },
+        { ZSTD_c_ldmHashLog, std::min(std::max(window_log - hash_rate_log, ZSTD_HASHLOG_MIN), ZSTD_HASHLOG_MAX) },
+        { ZSTD_c_ldmMinMatch, strategy >= ZSTD_btultra ? 32 : 64 },
+        { ZSTD_c_ldmBucketSizeLog, std::min(std::max(strategy, 4), ZSTD_LDM_BUCKETSIZELOG_MAX) },
+    };
+
+    for (const auto& param : params) {
+        const auto rc = ZSTD_CCtxParams_setParameter(cctx_params, param.first, param.second);
+        if (ZSTD_isError(rc)) return rc;
+    }
+
+    return 0;
+}
+
+
+// NOTE: parameters tuned for `src_size` are set explicitly, estimates take the content size as unknown.
+//       long distance matching is not in ZSTD_compressionParameters, so estimates go through ZSTD_CCtx_params.
+static size_t Estimate(const ZstdCompressionParams& params, usize src_size, size_t (*estimate)(const ZSTD_CCtx_params*))
+{
+    auto cparams = ZSTD_getCParams(params.compression_level, src_size != 0u ? src_size : ZSTD_CONTENTSIZE_UNKNOWN, 0);
+    if (params.window_log != 0) cparams.windowLog = params.window_log;
+    if (params.hash_log != 0) cparams.hashLog = params.hash_log;
+    if (params.chain_log != 0) cparams.chainLog = params.chain_log;
+    if (params.search_log != 0) cparams.searchLog = params.search_log;
+    if (params.min_match != 0) cparams.minMatch = params.min_match;
+    if (params.target_length != 0) cparams.targetLength = params.target_length;
+    if (params.strategy != 0) cparams.strategy = static_cast<ZSTD_strategy>(params.strategy);
+
+    const auto check_rc = ZSTD_checkCParams(cparams);
+    if (ZSTD_isError(check_rc)) return check_rc;
+
+    using CCtxParamsPtr = std::unique_ptr<ZSTD_CCtx_params, decltype(&ZSTD_freeCCtxParams)>;
+    CCtxParamsPtr cctx_params(ZSTD_createCCtxParams(), ZSTD_freeCCtxParams);
+    if (cctx_params == nullptr) return static_cast<size_t>(-ZSTD_error_memory_allocation);
+
+    ZSTD_parameters zparams;
+    zparams.cParams = cparams;
+    zparams.fParams = ZSTD_frameParameters { params.content_size_flag ? 1 : 0, params.checksum_flag ? 1 : 0, 0 };
+
+    auto rc = ZSTD_CCtxParams_init_advanced(cctx_params.get(), zparams);
+    if (ZSTD_isError(rc)) return rc;
+
+    if (params.enable_long_distance_matching) {
+        rc = SetLdmParams(cctx_params.get(), cparams);
+        if (ZSTD_isError(rc)) return rc;
+    }
+
+    return estimate(cctx_params.get());
+}
+
+
+//
+// ZstdCompressionParams
+//
+////////////////////////////////////////////////////////////////////////////////
+
+ZstdCompressionParams::ZstdCompressionParams()
+    : compression_level(0)
+    , window_log(0)
+    , hash_log(0)
+    , chain_log(0)
+    , search_log(0)
+    , min_match(0)
+    , target_length(0)
+    , strategy(0)
+    , enable_long_distance_matching(false)
+    , checksum_flag(false)
+    , content_size_flag(true)
+    , nb_workers(0)
+{
+}
+
+
+bool ZstdCompressionParams::HasCompressionParams() const
+{
+    return window_log != 0
+        || hash_log != 0
+        || chain_log != 0
+        || search_log != 0
+        || min_match != 0
+        || target_length != 0
+        || strategy != 0;
+}
+
+
+size_t ZstdCompressionParams::Apply(ZSTD_CCtx* cctx) const
+{
+    const std::pair<ZSTD_cParameter, int> params[] = {
+        // NOTE: set level first, it overrides other compression parameters.
+        { ZSTD_c_compressionLevel, compression_level },
+        { ZSTD_c_windowLog, window_log },
+        { ZSTD_c_hashLog, hash_log },
+        { ZSTD_c_chainLog, chain_log },
+        { ZSTD_c_searchLog, search_log },
+        { ZSTD_c_minMatch, min_match },
+        { ZSTD_c_targetLength, target_length },
+        { ZSTD_c_strategy, strategy },
+        { ZSTD_c_enableLongDistanceMatching, enable_long_distance_matching ? 1 : 0 },
+        { ZSTD_c_checksumFlag, checksum_flag ? 1 : 0 },
+        { ZSTD_c_contentSizeFlag, content_size_flag ? 1 : 0 },
+        { ZSTD_c_nbWorkers, ZstdCodec::ClampWorkers(nb_workers) },
+    };
+
+    for (const auto& param : params) {
+        const auto rc = ZSTD_CCtx_setParameter(cctx, param.first, param.second);
+        if (ZSTD_isError(rc)) return rc;
+    }
+
+    return 0;
+}
+
+
+size_t ZstdCompressionParams::EstimateCCtxSize(usize src_size) const
+{
+    return Estimate(*this, src_size, ZSTD_estimateCCtxSize_usingCCtxParams);
+}
+
+
+size_t ZstdCompressionParams::EstimateCStreamSize(usize src_size) const
+{
+    return Estimate(*this, src_size, ZSTD_estimateCStreamSize_usingCCtxParams);
+}
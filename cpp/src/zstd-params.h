@@ -0,0 +1,46 @@
+#pragma once
+
+#include "common-types.h"
+
+
+extern "C" {
+struct ZSTD_CCtx_s;     // orginal struct of ZSTD_CCtx
+}
+
+
+/*
+ZstdCompressionParams holds advanced compression parameters,
+applied to a context with ZSTD_CCtx_setParameter.
+
+0 means "use zstd's default" for every integer parameter,
+the same convention as ZSTD_CCtx_setParameter.
+*/
+struct ZstdCompressionParams
+{
+    ZstdCompressionParams();
+
+    int     compression_level;
+    int     window_log;
+    int     hash_log;
+    int     chain_log;
+    int     search_log;
+    int     min_match;
+    int     target_length;
+    int     strategy;
+    bool    enable_long_distance_matching;
+    bool    checksum_flag;
+    bool    content_size_flag;
+    int     nb_workers;
+
+    // true if any of window_log .. strategy is set.
+    bool HasCompressionParams() const;
+
+    // returns zstd's error code on failure, check it with ZSTD_isError.
+    size_t Apply(ZSTD_CCtx_s* cctx) const;
+
+    // heap a context (or stream) compressing with these parameters needs, zstd worker threads are not counted.
+    // `src_size` tunes parameters as zstd does for a known content size, 0 if unknown.
+    // returns zstd's error code on invalid parameters, check it with ZSTD_isError.
+    size_t EstimateCCtxSize(usize src_size) const;
+    size_t EstimateCStreamSize(usize src_size) const;
+};
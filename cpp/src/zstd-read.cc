@@ -1,9 +1,19 @@
 #include <algorithm>
 #include <array>
-#include <emscripten.h>
 
+#include "zstd-codec.h"
 #include "zstd-dict.h"
+#include "zstd-dict-registry.h"
 #include "zstd-read.h"
+#include "zstd-trace.h"
+
+
+// NOTE: static stream lives in its workspace, nothing to free.
+static size_t KeepStaticDStream(ZSTD_DStream*)
+{
+    return 0;
+}
+
 
 //
 // ZstdDecompressRead
@@ -11,12 +21,49 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 ZstdDecompressRead::ZstdDecompressRead()
-    : stream_(nullptr, ZSTD_freeDStream)
-    , chunk_offset_()
+    : allocator_()
+    , workspace_()
+    , static_(false)
+    , stream_(nullptr, ZSTD_freeDStream)
+    , input_ { nullptr, 0, 0 }
+    , chunk_bytes_()
+    , dest_bytes_()
+    , output_pending_()
+    , next_read_size_()
+    , frame_start_()
+    , selector_()
+{
+}
+
+
+ZstdDecompressRead::ZstdDecompressRead(std::shared_ptr<ZstdAllocator> allocator)
+    : allocator_(std::move(allocator))
+    , workspace_()
+    , static_(false)
+    , stream_(nullptr, ZSTD_freeDStream)
+    , input_ { nullptr, 0, 0 }
+    , chunk_bytes_()
+    , dest_bytes_()
+    , output_pending_()
     , next_read_size_()
-    , src_offset_()
-    , src_bytes_()
+    , frame_start_()
+    , selector_()
+{
+}
+
+
+ZstdDecompressRead::ZstdDecompressRead(ZstdWorkspace workspace)
+    : allocator_()
+    , workspace_(std::move(workspace))
+    , static_(true)
+    , stream_(nullptr, ZSTD_freeDStream)
+    , input_ { nullptr, 0, 0 }
+    , chunk_bytes_()
     , dest_bytes_()
+    , output_pending_()
+    , next_read_size_()
+    , frame_start_()
+    , selector_()
 {
 }
 
@@ -41,9 +88,20 @@ bool ZstdDecompressRead::Begin(const ZstdDecompressionDict& ddict)
     });
 }
 
+
+bool ZstdDecompressRead::Begin(const ZstdDictRegistry& registry)
+{
+    if (HasStream()) return true;
+
+    selector_.reset(new ZstdFrameDictSelector(registry));
+    return Begin([](ZSTD_DStream* dstream) {
+        return ZSTD_initDStream(dstream);
+    });
+}
+
 /*
 return: 
-false, if you try to load another chunk while chunk_bytes_
+false, if you try to load another chunk while the loaded one
 has not been completely read
 
 true, if you successully copy chunk to chunk_bytes_
@@ -51,75 +109,93 @@ true, if you successully copy chunk to chunk_bytes_
 bool ZstdDecompressRead::Load(const Vec<u8>& chunk) {
 
     // cannot load chunk while there is still one
-    if (chunk_bytes_.size()) return false;
+    if (HasInput()) return false;
+
+    chunk_bytes_.assign(std::begin(chunk), std::end(chunk));
+    input_ = ZSTD_inBuffer { chunk_bytes_.data(), chunk_bytes_.size(), 0 };
+
+    return true;
+}
 
-    // load chunk into chunk_bytes_
-    const auto copy_begin = std::begin(chunk);
-    const auto copy_end = copy_begin + chunk.size();
+// same as Load(chunk), references `chunk` instead of copying it
+bool ZstdDecompressRead::Load(const u8* chunk, usize chunk_size) {
 
-    std::copy(copy_begin, copy_end, std::back_inserter(chunk_bytes_));
+    if (HasInput()) return false;
+
+    chunk_bytes_.clear();
+    input_ = ZSTD_inBuffer { chunk, chunk_size, 0 };
 
     return true;
 }
 
-/*
-returns:
-false, if all of chunk_bytes_ has been decompressed
-*/
+// NOTE: type-erased adapter of template overload, for bindings.
 bool ZstdDecompressRead::Read(StreamCallback callback) {
 
-    // returns false and clears chunk if there is nothing left to read
-    if (chunk_offset_ == chunk_bytes_.size()) {
-        chunk_bytes_.clear();
-        chunk_offset_ = 0;
-        return false;
-    }
+    return Read<StreamCallback&>(callback);
+}
 
-    // src_bytes_ is a section of chunk that is being decompressed
-    // if it is empty, read the next section of chunk and put that in src_bytes
-    if (src_bytes_.size() == 0) {
-        const auto src_available = src_bytes_.capacity() - src_bytes_.size();
-        const auto chunk_remains = chunk_bytes_.size() - chunk_offset_;
-        const auto copy_size = std::min(src_available, chunk_remains);
+/*
+returns:
+size written into dest, 0 if loaded chunk needs to be replaced with the next one
 
-        const auto copy_begin = std::begin(chunk_bytes_) + chunk_offset_;
-        const auto copy_end = copy_begin + copy_size;
+decompresses until some output is written, consumes input without output (e.g. frame headers)
+*/
+i64 ZstdDecompressRead::Read(u8* dest, usize dest_capacity) {
 
-        // append src bytes
-        std::copy(copy_begin, copy_end, std::back_inserter(src_bytes_));
+    if (!HasStream()) return ERR_UNKNOWN;
 
-        // compress if enough bytes ready
-        if (src_bytes_.size() >= next_read_size_ || src_available == 0u) {
-            const auto success = Decompress(callback);
-            if (!success) return false;
-        }
+    ZSTD_outBuffer output { dest, dest_capacity, 0 };
+    while (output.pos == 0u && output.size > 0u && (HasInput() || output_pending_)) {
+        if (!Decompress(output)) return ERR_UNKNOWN;
     }
-    else {
-        const auto success = Decompress(callback);
-        return success;
+
+    // release consumed chunk, zstd doesn't reference it after decompressing
+    if (!HasInput()) {
+        chunk_bytes_.clear();
+        input_ = ZSTD_inBuffer { nullptr, 0, 0 };
     }
-   
-    return true;
+
+    return static_cast<i64>(output.pos);
 }
 
 bool ZstdDecompressRead::Flush(StreamCallback callback)
 {
-    return Decompress(callback);
+    return Flush<StreamCallback&>(callback);
 }
 
 
 bool ZstdDecompressRead::End(StreamCallback callback)
 {
+    return End<StreamCallback&>(callback);
+}
 
-    if (!HasStream()) return true;
 
-    auto success = true;
-    if (!src_bytes_.empty()) {
-        success = Decompress(callback);
-    }
+usize ZstdDecompressRead::StaticWorkspaceSize(usize max_window_size)
+{
+    return ZSTD_estimateDStreamSize(max_window_size);
+}
 
-    stream_.reset();
-    return success;
+
+// NOTE: chunks loaded by copy add their size.
+i64 ZstdDecompressRead::EstimateMemory(const Vec<u8>& frame_header)
+{
+    const auto rc = ZSTD_estimateDStreamSize_fromFrame(frame_header.data(), frame_header.size());
+    if (ZSTD_isError(rc)) return ERR_UNKNOWN;
+
+    return static_cast<i64>(rc + ZSTD_DStreamOutSize());
+}
+
+
+usize ZstdDecompressRead::MemoryUsage() const
+{
+    const auto stream_size = HasStream() ? ZSTD_sizeof_DStream(stream_.get()) : 0u;
+    return stream_size + chunk_bytes_.capacity() + dest_bytes_.capacity();
+}
+
+
+bool ZstdDecompressRead::HasInput() const
+{
+    return input_.pos < input_.size;
 }
 
 
@@ -133,46 +209,73 @@ bool ZstdDecompressRead::Begin(DStreamInitializer initializer)
 {
     if (HasStream()) return true;
 
-    DStreamPtr stream(ZSTD_createDStream(), ZSTD_freeDStream);
+    // NOTE: null when the workspace is too small (or empty, misaligned), static stream never allocates.
+    DStreamPtr stream = static_
+        ? DStreamPtr(ZSTD_initStaticDStream(workspace_.data(), workspace_.size()), KeepStaticDStream)
+        : DStreamPtr(CreateDCtx(allocator_.get()), ZSTD_freeDStream);
     if (stream == nullptr) return false;
 
     const auto init_rc = initializer(stream.get());
     if (ZSTD_isError(init_rc)) return false;
 
     stream_ = std::move(stream);
-    src_bytes_.reserve(ZSTD_DStreamInSize());
     dest_bytes_.resize(ZSTD_DStreamOutSize());  // resize
-    next_read_size_ = init_rc;
+    output_pending_ = false;
+    next_read_size_ = 0u;   // no frame is started until input is decompressed, same as ZstdDecompressStream
+    frame_start_ = true;
 
     return true;
 }
 
-bool ZstdDecompressRead::Decompress(const StreamCallback& callback)
+bool ZstdDecompressRead::IsFrameComplete() const
 {
-    if (src_bytes_.empty()) return true;
+    const auto complete = next_read_size_ == 0u && (selector_ == nullptr || !selector_->HasStagedHeader());
+    if (!complete) TRACE_ERROR("decompress: truncated frame, %zu more bytes expected", next_read_size_);
 
-    // decompresses src_bytes until reach limit for dest_bytes_ size
-    ZSTD_inBuffer input { &src_bytes_[0], src_bytes_.size(), src_offset_};
-    int prev_src_offset = src_offset_;
-    if (input.pos < input.size) {
-        dest_bytes_.resize(dest_bytes_.capacity());
-        ZSTD_outBuffer output { &dest_bytes_[0], dest_bytes_.size(), 0};
-        next_read_size_ = ZSTD_decompressStream(stream_.get(), &output, &input);
-        if (ZSTD_isError(next_read_size_)) return false;
+    return complete;
+}
 
-        dest_bytes_.resize(output.pos);
-        callback(dest_bytes_);
-    }
 
-    src_offset_ = input.pos;
-    chunk_offset_ += src_offset_ - prev_src_offset;
+void ZstdDecompressRead::EndStream()
+{
+    stream_.reset();
+    selector_.reset();
+    chunk_bytes_.clear();
+    input_ = ZSTD_inBuffer { nullptr, 0, 0 };
+    output_pending_ = false;
+}
+
+bool ZstdDecompressRead::Decompress(ZSTD_outBuffer& output)
+{
+    if (!SelectFrameDict()) return false;
+    if (!HasInput() && !output_pending_) return true;
 
-    // if we have finished decompressing src_bytes_
-    // clear src_bytes_
-    if (src_offset_ == src_bytes_.size()) {
-        src_offset_ = 0;
-        src_bytes_.clear();
+    // decompresses loaded chunk in place, after output.pos
+    const auto rc = ZSTD_decompressStream(stream_.get(), &output, &input_);
+    if (ZSTD_isError(rc)) {
+        TRACE_ERROR("ZSTD_decompressStream: %s", ZSTD_getErrorName(rc));
+        return false;
     }
 
+    next_read_size_ = rc;
+    frame_start_ = rc == 0u;
+
+    // zstd may hold more output, flush it even if input is consumed.
+    // NOTE: 0 means the frame is flushed, decompressing further would start the next frame.
+    output_pending_ = rc != 0u && output.pos == output.size;
+
     return true;
-}
\ No newline at end of file
+}
+
+
+// NOTE: consumes `input_` if the frame header is split, it's decompressed on the next call.
+bool ZstdDecompressRead::SelectFrameDict()
+{
+    if (selector_ == nullptr || !frame_start_ || !HasInput()) return true;
+
+    const auto result = selector_->Select(stream_.get(), input_);
+    if (result == ZstdFrameDictSelector::Result::Error) return false;
+    if (result == ZstdFrameDictSelector::Result::Selected) frame_start_ = false;
+
+    return true;
+}
@@ -2,48 +2,141 @@
 
 #include <functional>
 #include <array>
+#include <memory>
 
 #include "common-types.h"
+#include "zstd-allocator.h"
+#include "zstd-workspace.h"
 #include "zstd.h"
 
 
+// NOTE: same as zstd-stream.h, template overloads take any `sink(const Vec<u8>&)`.
 using StreamCallback = std::function<void(const Vec<u8>&)>;
 
 class ZstdDecompressionDict;
+class ZstdDictRegistry;
+class ZstdFrameDictSelector;
 
 /*
 ZstdDecompressRead takes in a chunk of data at a time with Load(chunk)
 when read is called on it, it returns deompressed data to a callback
 
 when all of the chunk is decompressed, load a new chunk in
+
+pull style: Load(chunk, chunk_size) references the chunk without copying it,
+Read(dest, dest_capacity) decompresses into caller's buffer, no more than it can hold.
 */
 class ZstdDecompressRead
 {
 public:
     ZstdDecompressRead();
+    explicit ZstdDecompressRead(std::shared_ptr<ZstdAllocator> allocator);   // stream allocates through `allocator`
+    explicit ZstdDecompressRead(ZstdWorkspace workspace);       // static stream, frames with larger windows than it holds fail
     ~ZstdDecompressRead();
 
     bool Begin();
     bool Begin(const ZstdDecompressionDict& ddict);
-    bool Load(const Vec<u8>& chunk);
+    bool Begin(const ZstdDictRegistry& registry);   // picks dictionary of each frame
+    bool Load(const Vec<u8>& chunk);                // copies `chunk`
+    bool Load(const u8* chunk, usize chunk_size);   // `chunk` must outlive reads of it
     bool Read(StreamCallback callback);
+
+    // returns the size written into `dest`, 0 when the loaded chunk is consumed and all of its output is read,
+    // or a negative error code (ERR_* in zstd-codec.h).
+    i64 Read(u8* dest, usize dest_capacity);
+    bool HasInput() const;                          // true until the loaded chunk is consumed
     bool Flush(StreamCallback callback);
     bool End(StreamCallback callback);
 
+    template <typename Sink> bool Read(Sink&& sink);
+    template <typename Sink> bool Flush(Sink&& sink);
+    template <typename Sink> bool End(Sink&& sink);
+
+    // workspace size of static stream reading frames with window up to `max_window_size`
+    static usize StaticWorkspaceSize(usize max_window_size);
+
+    // heap a stream reading the frame starting with `frame_header` needs,
+    // a negative error code unless it holds a complete frame header.
+    static i64 EstimateMemory(const Vec<u8>& frame_header);
+    usize MemoryUsage() const;      // stream (ZSTD_sizeof_DStream) and its buffers
+
 private:
     using DStreamPtr = std::unique_ptr<ZSTD_DStream, decltype(&ZSTD_freeDStream)>;
     using DStreamInitializer = std::function<size_t(ZSTD_DStream*)>;
 
     bool HasStream() const;
     bool Begin(DStreamInitializer initializer);
-    bool Decompress(const StreamCallback& callback);
-
-    DStreamPtr  stream_;
-    size_t      chunk_offset_;
-    Vec<u8>     chunk_bytes_;
-    size_t      next_read_size_;
-    size_t      src_offset_;
-    Vec<u8>     src_bytes_;
-    Vec<u8>     dest_bytes_;
+    bool Decompress(ZSTD_outBuffer& output);
+    bool SelectFrameDict();
+    bool IsFrameComplete() const;
+    void EndStream();
+
+    template <typename Sink> i64 ReadToSink(Sink& sink);
+
+    std::shared_ptr<ZstdAllocator>  allocator_;     // null for malloc, outlives stream_
+    ZstdWorkspace                   workspace_;     // empty unless static, outlives stream_
+    bool                            static_;        // constructed with a workspace, stream fails rather than allocates
+
+    DStreamPtr      stream_;
+    ZSTD_inBuffer   input_;             // loaded chunk, in `chunk_bytes_` or caller's memory
+    Vec<u8>         chunk_bytes_;
+    Vec<u8>         dest_bytes_;
+    bool            output_pending_;    // last output buffer was filled up, zstd may hold more
+    size_t          next_read_size_;    // 0 when the last frame is complete
+    bool            frame_start_;
+
+    std::unique_ptr<ZstdFrameDictSelector>  selector_;  // null unless began with registry
 };
 
+
+//
+// ZstdDecompressRead (templates)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// returns false, if all of the loaded chunk has been decompressed
+template <typename Sink>
+bool ZstdDecompressRead::Read(Sink&& sink)
+{
+    return ReadToSink(sink) > 0;
+}
+
+
+template <typename Sink>
+bool ZstdDecompressRead::Flush(Sink&& sink)
+{
+    return ReadToSink(sink) >= 0;
+}
+
+
+template <typename Sink>
+bool ZstdDecompressRead::End(Sink&& sink)
+{
+    if (!HasStream()) return true;
+
+    // decompress rest of the loaded chunk
+    auto read_size = ReadToSink(sink);
+    while (read_size > 0) {
+        read_size = ReadToSink(sink);
+    }
+
+    // NOTE: frame is truncated if zstd still expects input.
+    const auto success = read_size == 0 && IsFrameComplete();
+    EndStream();
+    return success;
+}
+
+
+template <typename Sink>
+i64 ZstdDecompressRead::ReadToSink(Sink& sink)
+{
+    // decompresses into dest_bytes_, sink takes it only if anything is written
+    dest_bytes_.resize(dest_bytes_.capacity());
+    const auto read_size = Read(dest_bytes_.data(), dest_bytes_.size());
+    if (read_size <= 0) return read_size;
+
+    dest_bytes_.resize(static_cast<usize>(read_size));
+    sink(dest_bytes_);
+
+    return read_size;
+}
@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <cstring>
+
+#include "zstd-codec.h"
+#include "zstd-params.h"
+#include "zstd-seekable.h"
+#include "zstd-trace.h"
+
+
+// NOTE: seek table is a skippable frame: header, entries, then the footer.
+static const u32 SEEK_TABLE_MAGIC_NUMBER = ZSTD_MAGIC_SKIPPABLE_START | 0xE;
+static const u32 SEEKABLE_MAGIC_NUMBER = 0x8F92EAB1;
+
+static const usize SEEK_TABLE_FOOTER_SIZE = 9;      // frame count, descriptor, seekable magic number
+static const u8 SEEK_TABLE_CHECKSUM_FLAG = 0x80;
+static const u8 SEEK_TABLE_RESERVED_BITS = 0x7C;
+
+
+static void WriteLE32(Vec<u8>& dest, u32 value)
+{
+    dest.push_back(static_cast<u8>(value));
+    dest.push_back(static_cast<u8>(value >> 8));
+    dest.push_back(static_cast<u8>(value >> 16));
+    dest.push_back(static_cast<u8>(value >> 24));
+}
+
+
+static u32 ReadLE32(const u8* src)
+{
+    return static_cast<u32>(src[0])
+         | static_cast<u32>(src[1]) << 8
+         | static_cast<u32>(src[2]) << 16
+         | static_cast<u32>(src[3]) << 24;
+}
+
+
+//
+// ZstdSeekableCompressStream
+//
+///////////////////////////////////////////////////////////////////////////////
+
+ZstdSeekableCompressStream::ZstdSeekableCompressStream()
+    : context_(nullptr, ZSTD_freeCCtx)
+    , max_frame_size_(DEFAULT_MAX_FRAME_SIZE)
+    , checksum_flag_(false)
+    , frame_src_size_(0)
+    , frame_dest_size_(0)
+    , frame_tail_()
+    , dest_bytes_()
+    , entries_()
+{
+}
+
+
+ZstdSeekableCompressStream::~ZstdSeekableCompressStream()
+{
+}
+
+
+bool ZstdSeekableCompressStream::Begin(int compression_level, usize max_frame_size, bool checksum_flag)
+{
+    ZstdCompressionParams params;
+    params.compression_level = compression_level;
+    params.checksum_flag = checksum_flag;
+
+    return Begin(params, max_frame_size);
+}
+
+
+bool ZstdSeekableCompressStream::Begin(const ZstdCompressionParams& params, usize max_frame_size)
+{
+    if (context_ != nullptr) return true;
+
+    if (max_frame_size == 0u || max_frame_size > MAX_FRAME_SIZE) {
+        TRACE_ERROR("seekable: frame size %zu is out of range", max_frame_size);
+        return false;
+    }
+
+    CCtxPtr context(ZSTD_createCCtx(), ZSTD_freeCCtx);
+    if (context == nullptr) return false;
+
+    // NOTE: parameters stick to the context, every frame is compressed with them.
+    const auto rc = params.Apply(context.get());
+    if (ZSTD_isError(rc)) {
+        TRACE_ERROR("seekable init: %s", ZSTD_getErrorName(rc));
+        return false;
+    }
+
+    context_ = std::move(context);
+    max_frame_size_ = max_frame_size;
+    checksum_flag_ = params.checksum_flag;
+    frame_src_size_ = 0;
+    frame_dest_size_ = 0;
+    dest_bytes_.reserve(ZSTD_CStreamOutSize());
+    entries_.clear();
+
+    return true;
+}
+
+
+bool ZstdSeekableCompressStream::Transform(const Vec<u8>& chunk, StreamCallback callback)
+{
+    return Transform(chunk.data(), chunk.size(), std::move(callback));
+}
+
+
+bool ZstdSeekableCompressStream::Transform(const u8* chunk, usize chunk_size, StreamCallback callback)
+{
+    if (context_ == nullptr) return false;
+
+    while (chunk_size > 0u) {
+        // NOTE: cut the input at frame boundaries, each frame ends after `max_frame_size` bytes.
+        const auto input_size = std::min(chunk_size, max_frame_size_ - frame_src_size_);
+        ZSTD_inBuffer input { chunk, input_size, 0 };
+        if (!Compress(input, ZSTD_e_continue, callback)) return false;
+
+        frame_src_size_ += input_size;
+        chunk += input_size;
+        chunk_size -= input_size;
+
+        if (frame_src_size_ == max_frame_size_ && !EndFrame(callback)) return false;
+    }
+
+    return true;
+}
+
+
+bool ZstdSeekableCompressStream::EndFrame(StreamCallback callback)
+{
+    if (context_ == nullptr) return false;
+    if (frame_src_size_ == 0u) return true;
+
+    if (entries_.size() >= MAX_FRAMES) {
+        TRACE_ERROR("seekable: too many frames");
+        return false;
+    }
+
+    ZSTD_inBuffer input { nullptr, 0, 0 };
+    if (!Compress(input, ZSTD_e_end, callback)) return false;
+
+    // NOTE: frame checksum is the low 32 bits of XXH64, the same value as a seek table checksum.
+    const auto checksum = checksum_flag_ ? ReadLE32(frame_tail_) : 0u;
+    entries_.push_back(Entry { static_cast<u32>(frame_dest_size_), static_cast<u32>(frame_src_size_), checksum });
+
+    frame_src_size_ = 0;
+    frame_dest_size_ = 0;
+    return true;
+}
+
+
+bool ZstdSeekableCompressStream::End(StreamCallback callback)
+{
+    if (context_ == nullptr) return true;
+
+    const auto success = EndFrame(callback);
+    context_.reset();
+    if (!success) return false;
+
+    const auto entry_size = checksum_flag_ ? 12u : 8u;
+    const auto table_size = entries_.size() * entry_size + SEEK_TABLE_FOOTER_SIZE;
+
+    Vec<u8> seek_table;
+    seek_table.reserve(ZSTD_SKIPPABLEHEADERSIZE + table_size);
+
+    WriteLE32(seek_table, SEEK_TABLE_MAGIC_NUMBER);
+    WriteLE32(seek_table, static_cast<u32>(table_size));
+    for (const auto& entry : entries_) {
+        WriteLE32(seek_table, entry.compressed_size);
+        WriteLE32(seek_table, entry.decompressed_size);
+        if (checksum_flag_) WriteLE32(seek_table, entry.checksum);
+    }
+
+    WriteLE32(seek_table, static_cast<u32>(entries_.size()));
+    seek_table.push_back(checksum_flag_ ? SEEK_TABLE_CHECKSUM_FLAG : 0u);
+    WriteLE32(seek_table, SEEKABLE_MAGIC_NUMBER);
+
+    callback(seek_table);
+    return true;
+}
+
+
+usize ZstdSeekableCompressStream::FrameCount() const
+{
+    return entries_.size();
+}
+
+
+bool ZstdSeekableCompressStream::Compress(ZSTD_inBuffer& input, ZSTD_EndDirective directive, const StreamCallback& callback)
+{
+    for (;;) {
+        dest_bytes_.resize(dest_bytes_.capacity());
+        ZSTD_outBuffer output { dest_bytes_.data(), dest_bytes_.size(), 0 };
+        const auto rc = ZSTD_compressStream2(context_.get(), &output, &input, directive);
+        if (ZSTD_isError(rc)) {
+            TRACE_ERROR("ZSTD_compressStream2: %s", ZSTD_getErrorName(rc));
+            return false;
+        }
+
+        Emit(output.pos, callback);
+
+        // NOTE: ZSTD_e_end returns remaining bytes to flush, call it until the frame is completed.
+        const auto done = directive == ZSTD_e_end ? rc == 0u : input.pos == input.size;
+        if (done) return true;
+    }
+}
+
+
+void ZstdSeekableCompressStream::Emit(usize size, const StreamCallback& callback)
+{
+    if (size == 0u) return;
+
+    // keep the last 4 bytes of the frame, they are its checksum once the frame is ended.
+    const auto tail_size = sizeof(frame_tail_);
+    if (size >= tail_size) {
+        std::memcpy(frame_tail_, dest_bytes_.data() + size - tail_size, tail_size);
+    }
+    else {
+        std::memmove(frame_tail_, frame_tail_ + size, tail_size - size);
+        std::memcpy(frame_tail_ + tail_size - size, dest_bytes_.data(), size);
+    }
+
+    frame_dest_size_ += size;
+    dest_bytes_.resize(size);
+    callback(dest_bytes_);
+}
+
+
+//
+// ZstdSeekableReader
+//
+///////////////////////////////////////////////////////////////////////////////
+
+ZstdSeekableReader::ZstdSeekableReader()
+    : source_()
+    , context_(nullptr, ZSTD_freeDCtx)
+    , compressed_offsets_()
+    , decompressed_offsets_()
+    , src_bytes_()
+    , frame_bytes_()
+    , frame_index_(0)
+{
+}
+
+
+ZstdSeekableReader::~ZstdSeekableReader()
+{
+}
+
+
+bool ZstdSeekableReader::Open(u64 src_size, Source source)
+{
+    Close();
+
+    DCtxPtr context(ZSTD_createDCtx(), ZSTD_freeDCtx);
+    if (context == nullptr) return false;
+
+    source_ = std::move(source);
+    if (!LoadSeekTable(src_size)) {
+        Close();
+        return false;
+    }
+
+    context_ = std::move(context);
+    frame_index_ = FrameCount();
+    return true;
+}
+
+
+bool ZstdSeekableReader::Open(const u8* src, usize src_size)
+{
+    return Open(src_size, [src](u64 offset, usize size, Vec<u8>& dest) {
+        dest.assign(src + offset, src + offset + size);
+        return true;
+    });
+}
+
+
+void ZstdSeekableReader::Close()
+{
+    source_ = nullptr;
+    context_.reset();
+    compressed_offsets_.clear();
+    decompressed_offsets_.clear();
+    src_bytes_.clear();
+    frame_bytes_.clear();
+    frame_index_ = 0;
+}
+
+
+usize ZstdSeekableReader::FrameCount() const
+{
+    return compressed_offsets_.empty() ? 0u : compressed_offsets_.size() - 1u;
+}
+
+
+u64 ZstdSeekableReader::ContentSize() const
+{
+    return decompressed_offsets_.empty() ? 0u : decompressed_offsets_.back();
+}
+
+
+i64 ZstdSeekableReader::Read(Vec<u8>& dest, u64 offset, usize size)
+{
+    if (context_ == nullptr) return ERR_UNKNOWN;
+
+    const auto content_size = ContentSize();
+    const auto read_begin = std::min(offset, content_size);
+    const auto read_end = read_begin + std::min(static_cast<u64>(size), content_size - read_begin);
+    dest.resize(static_cast<usize>(read_end - read_begin));
+
+    auto pos = read_begin;
+    while (pos < read_end) {
+        // last frame starting at or before `pos`, skips empty frames.
+        const auto next_frame = std::upper_bound(std::begin(decompressed_offsets_), std::end(decompressed_offsets_), pos);
+        const auto frame_index = static_cast<usize>(next_frame - std::begin(decompressed_offsets_)) - 1u;
+
+        const auto rc = LoadFrame(frame_index);
+        if (rc < 0) return rc;
+
+        const auto frame_begin = decompressed_offsets_[frame_index];
+        const auto copy_size = static_cast<usize>(std::min(read_end, decompressed_offsets_[frame_index + 1]) - pos);
+        std::memcpy(dest.data() + (pos - read_begin), frame_bytes_.data() + (pos - frame_begin), copy_size);
+        pos += copy_size;
+    }
+
+    return static_cast<i64>(dest.size());
+}
+
+
+bool ZstdSeekableReader::LoadSeekTable(u64 src_size)
+{
+    if (src_size < ZSTD_SKIPPABLEHEADERSIZE + SEEK_TABLE_FOOTER_SIZE) {
+        TRACE_ERROR("seekable: data is too small for a seek table");
+        return false;
+    }
+
+    auto& footer = src_bytes_;
+    if (!source_(src_size - SEEK_TABLE_FOOTER_SIZE, SEEK_TABLE_FOOTER_SIZE, footer) || footer.size() != SEEK_TABLE_FOOTER_SIZE) {
+        TRACE_ERROR("seekable: failed to read the seek table footer");
+        return false;
+    }
+
+    const auto frame_count = ReadLE32(&footer[0]);
+    const auto descriptor = footer[4];
+    if (ReadLE32(&footer[5]) != SEEKABLE_MAGIC_NUMBER || (descriptor & SEEK_TABLE_RESERVED_BITS) != 0u || frame_count > ZstdSeekableCompressStream::MAX_FRAMES) {
+        TRACE_ERROR("seekable: seek table is not found");
+        return false;
+    }
+
+    const auto entry_size = (descriptor & SEEK_TABLE_CHECKSUM_FLAG) != 0u ? 12u : 8u;
+    const auto table_size = static_cast<u64>(frame_count) * entry_size + SEEK_TABLE_FOOTER_SIZE;
+    const auto frame_size = ZSTD_SKIPPABLEHEADERSIZE + table_size;
+    if (frame_size > src_size) {
+        TRACE_ERROR("seekable: seek table is truncated");
+        return false;
+    }
+
+    auto& table = src_bytes_;
+    if (!source_(src_size - frame_size, static_cast<usize>(frame_size), table) || table.size() != frame_size) {
+        TRACE_ERROR("seekable: failed to read the seek table");
+        return false;
+    }
+
+    if (ReadLE32(&table[0]) != SEEK_TABLE_MAGIC_NUMBER || ReadLE32(&table[4]) != table_size) {
+        TRACE_ERROR("seekable: seek table header is broken");
+        return false;
+    }
+
+    // NOTE: frames are not verified against seek table checksums, zstd verifies frame checksums instead.
+    compressed_offsets_.assign(1, 0u);
+    decompressed_offsets_.assign(1, 0u);
+    for (usize i = 0; i < frame_count; ++i) {
+        const auto entry = &table[ZSTD_SKIPPABLEHEADERSIZE + i * entry_size];
+        const auto compressed_size = ReadLE32(entry);
+        const auto decompressed_size = ReadLE32(entry + 4);
+
+        // NOTE: LoadFrame allocates the decompressed size, reject sizes no writer produces.
+        if (decompressed_size > ZstdSeekableCompressStream::MAX_FRAME_SIZE || (compressed_size == 0u && decompressed_size != 0u)) {
+            TRACE_ERROR("seekable: frame %zu sizes are broken in the seek table", i);
+            return false;
+        }
+
+        compressed_offsets_.push_back(compressed_offsets_.back() + compressed_size);
+        decompressed_offsets_.push_back(decompressed_offsets_.back() + decompressed_size);
+    }
+
+    if (compressed_offsets_.back() > src_size - frame_size) {
+        TRACE_ERROR("seekable: frames overrun the seek table");
+        return false;
+    }
+
+    src_bytes_.clear();
+    return true;
+}
+
+
+i64 ZstdSeekableReader::LoadFrame(usize frame_index)
+{
+    if (frame_index == frame_index_) return 0;
+    frame_index_ = FrameCount();
+
+    const auto compressed_size = static_cast<usize>(compressed_offsets_[frame_index + 1] - compressed_offsets_[frame_index]);
+    const auto decompressed_size = static_cast<usize>(decompressed_offsets_[frame_index + 1] - decompressed_offsets_[frame_index]);
+
+    if (!source_(compressed_offsets_[frame_index], compressed_size, src_bytes_) || src_bytes_.size() != compressed_size) {
+        TRACE_ERROR("seekable: failed to read frame %zu", frame_index);
+        return ERR_UNKNOWN;
+    }
+
+    // NOTE: check the size recorded in the frame header (if any) before allocating the seek table's one.
+    const auto content_size = ZSTD_getFrameContentSize(src_bytes_.data(), src_bytes_.size());
+    if (content_size != ZSTD_CONTENTSIZE_UNKNOWN && content_size != decompressed_size) {
+        TRACE_ERROR("seekable: frame %zu header doesn't match the seek table", frame_index);
+        return ERR_UNKNOWN;
+    }
+
+    frame_bytes_.resize(decompressed_size);
+    const auto rc = ZSTD_decompressDCtx(context_.get(),
+                                        frame_bytes_.data(), frame_bytes_.size(),
+                                        src_bytes_.data(), src_bytes_.size());
+    if (ZSTD_isError(rc)) {
+        TRACE_ERROR("ZSTD_decompressDCtx: %s", ZSTD_getErrorName(rc));
+        return ERR_UNKNOWN;
+    }
+    else if (rc != decompressed_size) {
+        TRACE_ERROR("seekable: frame %zu is %zu bytes, seek table says %zu", frame_index, rc, decompressed_size);
+        return ERR_UNKNOWN;
+    }
+
+    frame_index_ = frame_index;
+    return 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "common-types.h"
+#include "zstd.h"
+
+
+using StreamCallback = std::function<void(const Vec<u8>&)>;
+
+struct ZstdCompressionParams;
+
+
+/*
+zstd seekable format, see contrib/seekable_format in the zstd repository.
+
+content is split into independent frames of at most `max_frame_size` bytes,
+followed by a seek table (skippable frame) recording the compressed and decompressed size of each frame.
+regular decompressors read it as plain concatenated frames, and skip the seek table.
+*/
+class ZstdSeekableCompressStream
+{
+public:
+    static const usize DEFAULT_MAX_FRAME_SIZE = 1024 * 1024;
+    static const usize MAX_FRAME_SIZE = 0x40000000;    // ZSTD_SEEKABLE_MAX_FRAME_DECOMPRESSED_SIZE
+    static const usize MAX_FRAMES = 0x8000000;         // ZSTD_SEEKABLE_MAXFRAMES
+
+    ZstdSeekableCompressStream();
+    ~ZstdSeekableCompressStream();
+
+    // seek table records frame checksums when `checksum_flag` (params.checksum_flag) is set.
+    bool Begin(int compression_level, usize max_frame_size = DEFAULT_MAX_FRAME_SIZE, bool checksum_flag = true);
+    bool Begin(const ZstdCompressionParams& params, usize max_frame_size = DEFAULT_MAX_FRAME_SIZE);
+    bool Transform(const Vec<u8>& chunk, StreamCallback callback);
+    bool Transform(const u8* chunk, usize chunk_size, StreamCallback callback);
+    bool EndFrame(StreamCallback callback);     // ends current frame early, e.g. on a record boundary
+    bool End(StreamCallback callback);          // ends current frame and writes the seek table
+
+    usize FrameCount() const;
+
+private:
+    using CCtxPtr = std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)>;
+
+    struct Entry
+    {
+        u32     compressed_size;
+        u32     decompressed_size;
+        u32     checksum;
+    };
+
+    bool Compress(ZSTD_inBuffer& input, ZSTD_EndDirective directive, const StreamCallback& callback);
+    void Emit(usize size, const StreamCallback& callback);
+
+    CCtxPtr     context_;
+    usize       max_frame_size_;
+    bool        checksum_flag_;
+    usize       frame_src_size_;        // decompressed bytes of the current frame
+    usize       frame_dest_size_;       // compressed bytes of the current frame
+    u8          frame_tail_[4];         // last bytes of the current frame, its checksum at the end
+    Vec<u8>     dest_bytes_;
+    Vec<Entry>  entries_;
+};
+
+
+/*
+ZstdSeekableReader decompresses any range of seekable format data,
+only the frames covering the range are read from the source and decompressed.
+
+the last decompressed frame is kept, consecutive reads within a frame decompress it once.
+*/
+class ZstdSeekableReader
+{
+public:
+    // reads `size` compressed bytes at `offset` into `dest`, returns false on failure.
+    using Source = std::function<bool(u64 offset, usize size, Vec<u8>& dest)>;
+
+    ZstdSeekableReader();
+    ~ZstdSeekableReader();
+
+    bool Open(u64 src_size, Source source);
+    bool Open(const u8* src, usize src_size);   // `src` must outlive the reader
+    void Close();
+
+    usize FrameCount() const;
+    u64 ContentSize() const;
+
+    // decompresses [offset, offset + size) into `dest`, shorter at the end of content.
+    // returns the size read, or a negative error code (ERR_* in zstd-codec.h).
+    i64 Read(Vec<u8>& dest, u64 offset, usize size);
+
+private:
+    using DCtxPtr = std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)>;
+
+    bool LoadSeekTable(u64 src_size);
+    i64 LoadFrame(usize frame_index);
+
+    Source      source_;
+    DCtxPtr     context_;
+    Vec<u64>    compressed_offsets_;    // FrameCount() + 1 frame boundaries
+    Vec<u64>    decompressed_offsets_;
+    Vec<u8>     src_bytes_;
+    Vec<u8>     frame_bytes_;
+    usize       frame_index_;           // frame in `frame_bytes_`, FrameCount() if none
+};
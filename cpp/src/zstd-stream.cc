@@ -1,9 +1,27 @@
 #include <algorithm>
 #include <array>
-#include <emscripten.h>
 
+#include "zstd-cdict-cache.h"
+#include "zstd-codec.h"
 #include "zstd-dict.h"
+#include "zstd-dict-registry.h"
+#include "zstd-params.h"
 #include "zstd-stream.h"
+#include "zstd-trace.h"
+
+
+// NOTE: static stream lives in its workspace, nothing to free.
+static size_t KeepStaticCStream(ZSTD_CStream*)
+{
+    return 0;
+}
+
+
+static size_t KeepStaticDStream(ZSTD_DStream*)
+{
+    return 0;
+}
+
 
 //
 // ZstdCompressStream
@@ -12,10 +30,40 @@
 
 
 ZstdCompressStream::ZstdCompressStream()
-    : stream_(nullptr, ZSTD_freeCStream)
+    : allocator_()
+    , workspace_()
+    , static_(false)
+    , stream_(nullptr, ZSTD_freeCStream)
+    , next_read_size_()
+    , src_bytes_()
+    , dest_bytes_()
+    , cdict_()
+{
+}
+
+
+ZstdCompressStream::ZstdCompressStream(std::shared_ptr<ZstdAllocator> allocator)
+    : allocator_(std::move(allocator))
+    , workspace_()
+    , static_(false)
+    , stream_(nullptr, ZSTD_freeCStream)
+    , next_read_size_()
+    , src_bytes_()
+    , dest_bytes_()
+    , cdict_()
+{
+}
+
+
+ZstdCompressStream::ZstdCompressStream(ZstdWorkspace workspace)
+    : allocator_()
+    , workspace_(std::move(workspace))
+    , static_(true)
+    , stream_(nullptr, ZSTD_freeCStream)
     , next_read_size_()
     , src_bytes_()
     , dest_bytes_()
+    , cdict_()
 {
 }
 
@@ -33,6 +81,24 @@ bool ZstdCompressStream::Begin(int compression_level)
 }
 
 
+bool ZstdCompressStream::Begin(int compression_level, int nb_workers)
+{
+    ZstdCompressionParams params;
+    params.compression_level = compression_level;
+    params.nb_workers = nb_workers;
+
+    return Begin(params);
+}
+
+
+bool ZstdCompressStream::Begin(const ZstdCompressionParams& params)
+{
+    return Begin([&params](ZSTD_CStream* cstream) {
+        return params.Apply(cstream);
+    });
+}
+
+
 bool ZstdCompressStream::Begin(const ZstdCompressionDict& cdict)
 {
     return Begin([&cdict](ZSTD_CStream* cstream) {
@@ -41,62 +107,88 @@ bool ZstdCompressStream::Begin(const ZstdCompressionDict& cdict)
 }
 
 
-bool ZstdCompressStream::Transform(const Vec<u8>& chunk, StreamCallback callback)
+bool ZstdCompressStream::Begin(ZstdCDictCache& cache, unsigned dict_id, int compression_level)
 {
-    if (!HasStream()) return false;
+    if (HasStream()) return true;
 
-    auto chunk_offset = 0u;
-    while (chunk_offset < chunk.size()) {
-        const auto src_available = src_bytes_.capacity() - src_bytes_.size();
-        const auto chunk_remains = chunk.size() - chunk_offset;
-        const auto copy_size = std::min(src_available, chunk_remains);
+    cdict_ = cache.Get(dict_id, compression_level);
+    if (cdict_ == nullptr) return false;
 
-        const auto copy_begin = std::begin(chunk) + chunk_offset;
-        const auto copy_end = copy_begin + copy_size;
+    return Begin(*cdict_);
+}
 
-        chunk_offset += copy_size;
 
-        // append src bytes
-        std::copy(copy_begin, copy_end, std::back_inserter(src_bytes_));
+bool ZstdCompressStream::Begin(ZstdCDictCache& cache, unsigned dict_id, const ZstdCompressionParams& params)
+{
+    if (HasStream()) return true;
 
-        // compress if enough bytes ready
-        if (src_bytes_.size() >= next_read_size_ || src_available == 0u) {
-            const auto success = Compress(callback);
-            if (!success) return false;
-        }
-    }
+    cdict_ = cache.Get(dict_id, params);
+    if (cdict_ == nullptr) return false;
 
-    return true;
+    // NOTE: CDict supersedes compression parameters, the others (checksum, workers, ...) apply.
+    const auto cdict = cdict_->get();
+    return Begin([&params, cdict](ZSTD_CStream* cstream) {
+        const auto rc = params.Apply(cstream);
+        if (ZSTD_isError(rc)) return rc;
+
+        return ZSTD_CCtx_refCDict(cstream, cdict);
+    });
+}
+
+
+// NOTE: type-erased adapters of template overloads, for bindings.
+bool ZstdCompressStream::Transform(const Vec<u8>& chunk, StreamCallback callback)
+{
+    return Transform<StreamCallback&>(chunk, callback);
+}
+
+
+bool ZstdCompressStream::Transform(const u8* chunk, usize chunk_size, StreamCallback callback)
+{
+    return Transform<StreamCallback&>(chunk, chunk_size, callback);
 }
 
 
 bool ZstdCompressStream::Flush(StreamCallback callback)
 {
-    return Compress(callback);
+    return Flush<StreamCallback&>(callback);
 }
 
 
 bool ZstdCompressStream::End(StreamCallback callback)
 {
-    if (!HasStream()) return true;
+    return End<StreamCallback&>(callback);
+}
 
-    auto success = true;
-    if (!src_bytes_.empty()) {
-        success = Compress(callback);
-    }
 
-    if (success) {
-        dest_bytes_.resize(dest_bytes_.capacity());
-        ZSTD_outBuffer output { &dest_bytes_[0], dest_bytes_.size(), 0 };
-        const auto remaining = ZSTD_endStream(stream_.get(), &output);
-        if (remaining > 0u) return false;
+usize ZstdCompressStream::StaticWorkspaceSize(int compression_level)
+{
+    return ZSTD_estimateCStreamSize(compression_level);
+}
 
-        dest_bytes_.resize(output.pos);
-        callback(dest_bytes_);
-    }
 
-    stream_.reset();
-    return success;
+i64 ZstdCompressStream::EstimateMemory(int compression_level)
+{
+    ZstdCompressionParams params;
+    params.compression_level = compression_level;
+    return EstimateMemory(params);
+}
+
+
+// NOTE: streams never pledge the content size, parameters are the ones of unknown size.
+i64 ZstdCompressStream::EstimateMemory(const ZstdCompressionParams& params)
+{
+    const auto rc = params.EstimateCStreamSize(0);
+    if (ZSTD_isError(rc)) return ERR_UNKNOWN;
+
+    return static_cast<i64>(rc + ZSTD_CStreamInSize() + ZSTD_CStreamOutSize());
+}
+
+
+usize ZstdCompressStream::MemoryUsage() const
+{
+    const auto stream_size = HasStream() ? ZSTD_sizeof_CStream(stream_.get()) : 0u;
+    return stream_size + src_bytes_.capacity() + dest_bytes_.capacity();
 }
 
 
@@ -110,11 +202,17 @@ bool ZstdCompressStream::Begin(CStreamInitializer initializer)
 {
     if (HasStream()) return true;
 
-    CStreamPtr stream(ZSTD_createCStream(), ZSTD_freeCStream);
+    // NOTE: null when the workspace is too small (or empty, misaligned), static stream never allocates.
+    CStreamPtr stream = static_
+        ? CStreamPtr(ZSTD_initStaticCStream(workspace_.data(), workspace_.size()), KeepStaticCStream)
+        : CStreamPtr(CreateCCtx(allocator_.get()), ZSTD_freeCStream);
     if (stream == nullptr) return false;
 
     const auto init_rc = initializer(stream.get());
-    if (ZSTD_isError(init_rc)) return false;
+    if (ZSTD_isError(init_rc)) {
+        TRACE_ERROR("stream init: %s", ZSTD_getErrorName(init_rc));
+        return false;
+    }
 
     stream_ = std::move(stream);
     src_bytes_.reserve(ZSTD_CStreamInSize());
@@ -125,36 +223,88 @@ bool ZstdCompressStream::Begin(CStreamInitializer initializer)
 }
 
 
-bool ZstdCompressStream::Compress(const StreamCallback& callback)
+bool ZstdCompressStream::StageChunk(const Vec<u8>& chunk, usize& chunk_offset)
 {
-    if (src_bytes_.empty()) return true;
+    const auto src_available = src_bytes_.capacity() - src_bytes_.size();
+    const auto chunk_remains = chunk.size() - chunk_offset;
+    const auto copy_size = std::min(src_available, chunk_remains);
+
+    const auto copy_begin = std::begin(chunk) + chunk_offset;
+    const auto copy_end = copy_begin + copy_size;
+
+    chunk_offset += copy_size;
 
-    ZSTD_inBuffer input { &src_bytes_[0], src_bytes_.size(), 0 };
-    while (input.pos < input.size) {
-        dest_bytes_.resize(dest_bytes_.capacity());
-        ZSTD_outBuffer output { &dest_bytes_[0], dest_bytes_.size(), 0};
-        next_read_size_ = ZSTD_compressStream(stream_.get(), &output, &input);
-        if (ZSTD_isError(next_read_size_)) return false;
+    // append src bytes
+    std::copy(copy_begin, copy_end, std::back_inserter(src_bytes_));
 
-        dest_bytes_.resize(output.pos);
-        callback(dest_bytes_);
+    return src_bytes_.size() >= next_read_size_ || src_available == 0u;
+}
+
+
+bool ZstdCompressStream::CompressBlock(ZSTD_inBuffer& input, ZSTD_EndDirective directive, size_t& remaining)
+{
+    dest_bytes_.resize(dest_bytes_.capacity());
+    ZSTD_outBuffer output { &dest_bytes_[0], dest_bytes_.size(), 0 };
+    remaining = ZSTD_compressStream2(stream_.get(), &output, &input, directive);
+    if (ZSTD_isError(remaining)) {
+        TRACE_ERROR("ZSTD_compressStream2: %s", ZSTD_getErrorName(remaining));
+        return false;
     }
 
-    src_bytes_.clear();
+    TRACE_DEBUG("compress: input %zu/%zu, output %zu", input.pos, input.size, output.pos);
+    dest_bytes_.resize(output.pos);
+
     return true;
 }
 
 
+void ZstdCompressStream::EndStream()
+{
+    stream_.reset();
+    cdict_.reset();
+}
+
+
 //
 // ZstdDecompressStream
 //
 ///////////////////////////////////////////////////////////////////////////////
 
 ZstdDecompressStream::ZstdDecompressStream()
-    : stream_(nullptr, ZSTD_freeDStream)
+    : allocator_()
+    , workspace_()
+    , static_(false)
+    , stream_(nullptr, ZSTD_freeDStream)
     , next_read_size_()
-    , src_bytes_()
+    , frame_start_()
+    , dest_bytes_()
+    , selector_()
+{
+}
+
+
+ZstdDecompressStream::ZstdDecompressStream(std::shared_ptr<ZstdAllocator> allocator)
+    : allocator_(std::move(allocator))
+    , workspace_()
+    , static_(false)
+    , stream_(nullptr, ZSTD_freeDStream)
+    , next_read_size_()
+    , frame_start_()
     , dest_bytes_()
+    , selector_()
+{
+}
+
+
+ZstdDecompressStream::ZstdDecompressStream(ZstdWorkspace workspace)
+    : allocator_()
+    , workspace_(std::move(workspace))
+    , static_(true)
+    , stream_(nullptr, ZSTD_freeDStream)
+    , next_read_size_()
+    , frame_start_()
+    , dest_bytes_()
+    , selector_()
 {
 }
 
@@ -180,85 +330,71 @@ bool ZstdDecompressStream::Begin(const ZstdDecompressionDict& ddict)
 }
 
 
-int ZstdDecompressStream::Transform(const Vec<u8>& chunk, int chunk_offset, int pos, StreamCallback callback)
+bool ZstdDecompressStream::Begin(const ZstdDictRegistry& registry)
 {
-    // returns the position (in the current src_bytes) that we had last finished decompressing from
-    // in other words, just for Decompress function to start reading from
-
-    EM_ASM({
-        console.log($0);
-    }, chunk_offset);
-
-    EM_ASM(
-        console.log("here, transform"); 
-    );
+    if (HasStream()) return true;
 
-    if (!HasStream()) return -1;
+    selector_.reset(new ZstdFrameDictSelector(registry));
+    return Begin([](ZSTD_DStream* dstream) {
+        return ZSTD_initDStream(dstream);
+    });
+}
 
-    if (src_bytes_.size()==0) {
-        // read a new src_bytes because you just finished processing the last one
-        // auto chunk_offset = 0u;
 
-        if (chunk_offset < chunk.size()) {
-            const auto src_available = src_bytes_.capacity() - src_bytes_.size();
-            const auto chunk_remains = chunk.size() - chunk_offset;
-            const auto copy_size = std::min(src_available, chunk_remains);
+// NOTE: type-erased adapters of template overloads, for bindings.
+bool ZstdDecompressStream::Transform(const Vec<u8>& chunk, StreamCallback callback)
+{
+    return Transform<StreamCallback&>(chunk, callback);
+}
 
-            const auto copy_begin = std::begin(chunk) + chunk_offset;
-            const auto copy_end = copy_begin + copy_size;
 
-            // append src bytes
-            std::copy(copy_begin, copy_end, std::back_inserter(src_bytes_));
+bool ZstdDecompressStream::Transform(const u8* chunk, usize chunk_size, StreamCallback callback)
+{
+    return Transform<StreamCallback&>(chunk, chunk_size, callback);
+}
 
-            // compress if enough bytes ready
-            if (src_bytes_.size() >= next_read_size_ || src_available == 0u) {
-                const auto pos = Decompress(0, callback);
-                if (pos == -1) return -1;
-                return pos;
-            }
 
-            // chunk_offset += copy_size;
+// NOTE: Transform drains all decoded bytes, nothing is left to flush here.
+bool ZstdDecompressStream::Flush(StreamCallback /*callback*/)
+{
+    return true;
+}
 
-            // if chunk is processed, but not enough for a src_bytes!!!
-            // returning 0
-            return 0;
-        }
 
-    }
-    else {
-        // continue with decompress with same src bytes
+// NOTE: Transform drains all decoded bytes, nothing is left to write here.
+bool ZstdDecompressStream::End(StreamCallback /*callback*/)
+{
+    if (!HasStream()) return true;
 
-        EM_ASM(
-            console.log('src_bytes_ has some stuff');
-        );
+    // NOTE: frame is truncated if zstd still expects input, a stream without input ends successfully.
+    const auto success = next_read_size_ == 0u && (selector_ == nullptr || !selector_->HasStagedHeader());
+    if (!success) TRACE_ERROR("decompress: truncated frame, %zu more bytes expected", next_read_size_);
 
-        int new_pos = Decompress(pos, callback);
-        return new_pos;
-    }
+    stream_.reset();
+    selector_.reset();
+    return success;
 }
 
 
-bool ZstdDecompressStream::Flush(StreamCallback callback)
+usize ZstdDecompressStream::StaticWorkspaceSize(usize max_window_size)
 {
-    EM_ASM({
-        console.log("stream flush?");
-    });
-    
-    return Decompress(0, callback);
+    return ZSTD_estimateDStreamSize(max_window_size);
 }
 
 
-bool ZstdDecompressStream::End(int pos, StreamCallback callback)
+i64 ZstdDecompressStream::EstimateMemory(const Vec<u8>& frame_header)
 {
-    if (!HasStream()) return true;
+    const auto rc = ZSTD_estimateDStreamSize_fromFrame(frame_header.data(), frame_header.size());
+    if (ZSTD_isError(rc)) return ERR_UNKNOWN;
 
-    auto success = true;
-    if (!src_bytes_.empty()) {
-        success = Decompress(pos, callback);
-    }
+    return static_cast<i64>(rc + ZSTD_DStreamOutSize());
+}
 
-    stream_.reset();
-    return success;
+
+usize ZstdDecompressStream::MemoryUsage() const
+{
+    const auto stream_size = HasStream() ? ZSTD_sizeof_DStream(stream_.get()) : 0u;
+    return stream_size + dest_bytes_.capacity();
 }
 
 
@@ -269,67 +405,54 @@ bool ZstdDecompressStream::HasStream() const
 
 
 bool ZstdDecompressStream::Begin(DStreamInitializer initializer)
-{   
-    EM_ASM(
-    console.log("here, begin");
-  );
-
+{
     if (HasStream()) return true;
 
-    DStreamPtr stream(ZSTD_createDStream(), ZSTD_freeDStream);
+    // NOTE: null when the workspace is too small (or empty, misaligned), static stream never allocates.
+    DStreamPtr stream = static_
+        ? DStreamPtr(ZSTD_initStaticDStream(workspace_.data(), workspace_.size()), KeepStaticDStream)
+        : DStreamPtr(CreateDCtx(allocator_.get()), ZSTD_freeDStream);
     if (stream == nullptr) return false;
 
     const auto init_rc = initializer(stream.get());
-    if (ZSTD_isError(init_rc)) return false;
+    if (ZSTD_isError(init_rc)) {
+        TRACE_ERROR("stream init: %s", ZSTD_getErrorName(init_rc));
+        return false;
+    }
 
     stream_ = std::move(stream);
-    src_bytes_.reserve(ZSTD_DStreamInSize());
     dest_bytes_.resize(ZSTD_DStreamOutSize());  // resize
-    next_read_size_ = init_rc;
+    next_read_size_ = 0u;   // no frame is started until input is decompressed
+    frame_start_ = true;
 
     return true;
 }
 
 
-int ZstdDecompressStream::Decompress(int pos, const StreamCallback& callback)
-{   
-    // return pos in current src_bytes_
-    if (pos==src_bytes_.size()){
-        src_bytes_.clear();
-        return 0;
+// NOTE: zstd stops at the end of each frame, so the next header is seen here.
+ZstdDecompressStream::BlockResult ZstdDecompressStream::DecompressBlock(ZSTD_inBuffer& input, bool& output_full)
+{
+    if (selector_ != nullptr && frame_start_) {
+        const auto result = selector_->Select(stream_.get(), input);
+        if (result == ZstdFrameDictSelector::Result::Error) return BlockResult::Error;
+        if (result == ZstdFrameDictSelector::Result::NeedMoreInput) return BlockResult::NeedMoreInput;
+        frame_start_ = false;
     }
 
-    EM_ASM(
-        console.log("here, decompress");
-    );
-
-    EM_ASM({
-        console.log("src_bytes_ size", $0);
-    }, src_bytes_.size());
-
-    if (src_bytes_.empty()) return true;
-
-    ZSTD_inBuffer input { &src_bytes_[0], src_bytes_.size(), static_cast<size_t>(pos)};
-
-    EM_ASM({
-        console.log("input.pos before read", $0);
-    }, input.pos);
-
-    if (input.pos < input.size) {
-        dest_bytes_.resize(dest_bytes_.capacity());
-        ZSTD_outBuffer output { &dest_bytes_[0], dest_bytes_.size(), 0};
-        next_read_size_ = ZSTD_decompressStream(stream_.get(), &output, &input);
-        if (ZSTD_isError(next_read_size_)) return -1;
-
-        EM_ASM({
-            console.log("input.pos after read", $0);
-        }, input.pos);
-        
-        dest_bytes_.resize(output.pos);
-        callback(dest_bytes_);
+    dest_bytes_.resize(dest_bytes_.capacity());
+    ZSTD_outBuffer output { &dest_bytes_[0], dest_bytes_.size(), 0 };
+    next_read_size_ = ZSTD_decompressStream(stream_.get(), &output, &input);
+    if (ZSTD_isError(next_read_size_)) {
+        TRACE_ERROR("ZSTD_decompressStream: %s", ZSTD_getErrorName(next_read_size_));
+        return BlockResult::Error;
     }
 
-    // if finished, 
+    TRACE_DEBUG("decompress: input %zu/%zu, output %zu", input.pos, input.size, output.pos);
+
+    // NOTE: 0 means the frame is fully flushed, even if output happens to be full.
+    frame_start_ = next_read_size_ == 0u;
+    output_full = output.pos == output.size && !frame_start_;
+    dest_bytes_.resize(output.pos);
 
-    return input.pos;
+    return BlockResult::Decoded;
 }
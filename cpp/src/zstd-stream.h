@@ -2,42 +2,82 @@
 
 #include <functional>
 #include <array>
+#include <memory>
 
 #include "common-types.h"
+#include "zstd-allocator.h"
+#include "zstd-workspace.h"
 #include "zstd.h"
 
 
+// NOTE: type-erased callback for bindings, compiled callers pass any `sink(const Vec<u8>&)` to template overloads,
+//       which inline it in the loop emitting blocks.
 using StreamCallback = std::function<void(const Vec<u8>&)>;
 
 
+class ZstdCDictCache;
 class ZstdCompressionDict;
 class ZstdDecompressionDict;
+class ZstdDictRegistry;
+class ZstdFrameDictSelector;
+struct ZstdCompressionParams;
 
 
 class ZstdCompressStream
 {
 public:
     ZstdCompressStream();
+    explicit ZstdCompressStream(std::shared_ptr<ZstdAllocator> allocator);   // stream allocates through `allocator`
+    explicit ZstdCompressStream(ZstdWorkspace workspace);       // static stream, zstd worker threads (`nb_workers`) are not available
     ~ZstdCompressStream();
 
     bool Begin(int compression_level);
+    bool Begin(int compression_level, int nb_workers);
+    bool Begin(const ZstdCompressionParams& params);
     bool Begin(const ZstdCompressionDict& cdict);
+    bool Begin(ZstdCDictCache& cache, unsigned dict_id, int compression_level);
+    bool Begin(ZstdCDictCache& cache, unsigned dict_id, const ZstdCompressionParams& params);
     bool Transform(const Vec<u8>& chunk, StreamCallback callback);
+    bool Transform(const u8* chunk, usize chunk_size, StreamCallback callback);
     bool Flush(StreamCallback callback);
     bool End(StreamCallback callback);
 
+    template <typename Sink> bool Transform(const Vec<u8>& chunk, Sink&& sink);
+    template <typename Sink> bool Transform(const u8* chunk, usize chunk_size, Sink&& sink);
+    template <typename Sink> bool Flush(Sink&& sink);
+    template <typename Sink> bool End(Sink&& sink);
+
+    // workspace size of static stream compressing at `compression_level`
+    static usize StaticWorkspaceSize(int compression_level);
+
+    // heap a stream compressing at `compression_level` (or `params`) needs, a negative error code on invalid parameters.
+    static i64 EstimateMemory(int compression_level);
+    static i64 EstimateMemory(const ZstdCompressionParams& params);
+    usize MemoryUsage() const;      // stream (ZSTD_sizeof_CStream) and its buffers
+
 private:
     using CStreamPtr = std::unique_ptr<ZSTD_CStream, decltype(&ZSTD_freeCStream)>;
     using CStreamInitializer = std::function<size_t(ZSTD_CStream*)>;
 
     bool HasStream() const;
     bool Begin(CStreamInitializer initializer);
-    bool Compress(const StreamCallback& callback);
+    bool StageChunk(const Vec<u8>& chunk, usize& chunk_offset);     // true when staged bytes are ready to compress
+    bool CompressBlock(ZSTD_inBuffer& input, ZSTD_EndDirective directive, size_t& remaining);   // output in dest_bytes_
+    void EndStream();
+
+    template <typename Sink> bool Compress(Sink& sink);
+    template <typename Sink> bool Compress(ZSTD_inBuffer& input, Sink& sink);
+
+    std::shared_ptr<ZstdAllocator>  allocator_;     // null for malloc, outlives stream_
+    ZstdWorkspace                   workspace_;     // empty unless static, outlives stream_
+    bool                            static_;        // constructed with a workspace, stream fails rather than allocates
 
     CStreamPtr  stream_;
     size_t      next_read_size_;
     Vec<u8>     src_bytes_;
     Vec<u8>     dest_bytes_;
+
+    std::shared_ptr<const ZstdCompressionDict>  cdict_;     // held while began with cache
 };
 
 
@@ -45,28 +85,178 @@ class ZstdDecompressStream
 {
 public:
     ZstdDecompressStream();
+    explicit ZstdDecompressStream(std::shared_ptr<ZstdAllocator> allocator);   // stream allocates through `allocator`
+    explicit ZstdDecompressStream(ZstdWorkspace workspace);     // static stream, frames with larger windows than it holds fail
     ~ZstdDecompressStream();
 
     bool Begin();
     bool Begin(const ZstdDecompressionDict& ddict);
-    int Transform(const Vec<u8>& chunk, int chunk_offset, int pos, StreamCallback callback);
+    bool Begin(const ZstdDictRegistry& registry);   // picks dictionary of each frame
+    bool Transform(const Vec<u8>& chunk, StreamCallback callback);
+    bool Transform(const u8* chunk, usize chunk_size, StreamCallback callback);
     bool Flush(StreamCallback callback);
-    bool End(int pos, StreamCallback callback);
+    bool End(StreamCallback callback);
+
+    template <typename Sink> bool Transform(const Vec<u8>& chunk, Sink&& sink);
+    template <typename Sink> bool Transform(const u8* chunk, usize chunk_size, Sink&& sink);
 
-    
+    // workspace size of static stream decompressing frames with window up to `max_window_size`
+    static usize StaticWorkspaceSize(usize max_window_size);
+
+    // heap a stream decompressing the frame starting with `frame_header` needs,
+    // a negative error code unless it holds a complete frame header.
+    static i64 EstimateMemory(const Vec<u8>& frame_header);
+    usize MemoryUsage() const;      // stream (ZSTD_sizeof_DStream) and its buffers
 
 private:
     using DStreamPtr = std::unique_ptr<ZSTD_DStream, decltype(&ZSTD_freeDStream)>;
     using DStreamInitializer = std::function<size_t(ZSTD_DStream*)>;
 
+    enum class BlockResult { Decoded, NeedMoreInput, Error };
+
     bool HasStream() const;
     bool Begin(DStreamInitializer initializer);
-    int Decompress(int pos, const StreamCallback& callback);
+    BlockResult DecompressBlock(ZSTD_inBuffer& input, bool& output_full);     // output in dest_bytes_
+
+    template <typename Sink> bool Decompress(ZSTD_inBuffer& input, Sink& sink);
+
+    std::shared_ptr<ZstdAllocator>  allocator_;     // null for malloc, outlives stream_
+    ZstdWorkspace                   workspace_;     // empty unless static, outlives stream_
+    bool                            static_;        // constructed with a workspace, stream fails rather than allocates
 
     DStreamPtr  stream_;
-    size_t      next_read_size_;
-    size_t      src_offset_;
-    Vec<u8>     src_bytes_;
+    size_t      next_read_size_;    // 0 when the last frame is complete
+    bool        frame_start_;
     Vec<u8>     dest_bytes_;
+
+    std::unique_ptr<ZstdFrameDictSelector>  selector_;  // null unless began with registry
 };
 
+
+//
+// ZstdCompressStream (templates)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename Sink>
+bool ZstdCompressStream::Transform(const Vec<u8>& chunk, Sink&& sink)
+{
+    if (!HasStream()) return false;
+
+    auto chunk_offset = static_cast<usize>(0u);
+    while (chunk_offset < chunk.size()) {
+        // compress if enough bytes ready
+        if (StageChunk(chunk, chunk_offset) && !Compress(sink)) return false;
+    }
+
+    return true;
+}
+
+
+// NOTE: zero-copy path, feeds caller's buffer to zstd directly.
+template <typename Sink>
+bool ZstdCompressStream::Transform(const u8* chunk, usize chunk_size, Sink&& sink)
+{
+    if (!HasStream()) return false;
+
+    // keep byte order, compress bytes staged by the buffered path first.
+    if (!Compress(sink)) return false;
+
+    // zstd consumes the whole input as long as output space is drained,
+    // so there is no unconsumed tail to stage after this call.
+    ZSTD_inBuffer input { chunk, chunk_size, 0 };
+    return Compress(input, sink);
+}
+
+
+template <typename Sink>
+bool ZstdCompressStream::Flush(Sink&& sink)
+{
+    return Compress(sink);
+}
+
+
+template <typename Sink>
+bool ZstdCompressStream::End(Sink&& sink)
+{
+    if (!HasStream()) return true;
+
+    auto success = Compress(sink);
+
+    // NOTE: ZSTD_e_end returns remaining bytes to flush, call it until the frame is completed.
+    auto remaining = static_cast<size_t>(1u);
+    while (success && remaining > 0u) {
+        ZSTD_inBuffer input { nullptr, 0, 0 };
+        success = CompressBlock(input, ZSTD_e_end, remaining);
+        if (success) sink(dest_bytes_);
+    }
+
+    EndStream();
+    return success;
+}
+
+
+template <typename Sink>
+bool ZstdCompressStream::Compress(Sink& sink)
+{
+    if (src_bytes_.empty()) return true;
+
+    ZSTD_inBuffer input { &src_bytes_[0], src_bytes_.size(), 0 };
+    if (!Compress(input, sink)) return false;
+
+    src_bytes_.clear();
+    return true;
+}
+
+
+template <typename Sink>
+bool ZstdCompressStream::Compress(ZSTD_inBuffer& input, Sink& sink)
+{
+    auto remaining = static_cast<size_t>(0u);
+    while (input.pos < input.size) {
+        if (!CompressBlock(input, ZSTD_e_continue, remaining)) return false;
+        if (!dest_bytes_.empty()) sink(dest_bytes_);
+    }
+
+    return true;
+}
+
+
+//
+// ZstdDecompressStream (templates)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename Sink>
+bool ZstdDecompressStream::Transform(const Vec<u8>& chunk, Sink&& sink)
+{
+    return Transform<Sink&>(chunk.data(), chunk.size(), sink);
+}
+
+
+// NOTE: zstd keeps its own input window, so chunks are fed directly without staging.
+template <typename Sink>
+bool ZstdDecompressStream::Transform(const u8* chunk, usize chunk_size, Sink&& sink)
+{
+    if (!HasStream()) return false;
+
+    ZSTD_inBuffer input { chunk, chunk_size, 0 };
+    return Decompress(input, sink);
+}
+
+
+template <typename Sink>
+bool ZstdDecompressStream::Decompress(ZSTD_inBuffer& input, Sink& sink)
+{
+    // NOTE: zstd may hold decoded bytes while output is full, drain until it isn't.
+    //       nothing is held between calls, an empty chunk doesn't touch the stream (it would start a frame).
+    auto output_full = false;
+    while (input.pos < input.size || output_full) {
+        const auto result = DecompressBlock(input, output_full);
+        if (result == BlockResult::Error) return false;
+        if (result == BlockResult::NeedMoreInput) return true;
+        if (!dest_bytes_.empty()) sink(dest_bytes_);
+    }
+
+    return true;
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "zstd-thread-pool.h"
+
+
+// tasks of a ParallelFor call, shared by the calling thread and workers.
+struct ParallelForState
+{
+    ParallelForState(usize task_count, const std::function<void(usize)>& task)
+        : task(task)
+        , task_count(task_count)
+        , next_index(0)
+        , mutex()
+        , all_done()
+        , done_count(0)
+    {
+    }
+
+    // NOTE: `task` is only called before all tasks are done, while ParallelFor still waits.
+    const std::function<void(usize)>&   task;
+    const usize                         task_count;
+    std::atomic<usize>                  next_index;
+
+    std::mutex                          mutex;
+    std::condition_variable             all_done;
+    usize                               done_count;
+};
+
+
+static void RunTasks(ParallelForState& state)
+{
+    for (;;) {
+        const auto index = state.next_index.fetch_add(1);
+        if (index >= state.task_count) return;
+
+        state.task(index);
+
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (++state.done_count == state.task_count) state.all_done.notify_one();
+    }
+}
+
+
+//
+// ZstdThreadPool
+//
+////////////////////////////////////////////////////////////////////////////////
+
+ZstdThreadPool::ZstdThreadPool()
+    : mutex_()
+    , task_posted_()
+    , tasks_()
+    , workers_()
+    , stopping_(false)
+{
+}
+
+
+ZstdThreadPool::~ZstdThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    task_posted_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+
+void ZstdThreadPool::ParallelFor(usize task_count, int nb_threads, const std::function<void(usize)>& task)
+{
+    if (task_count == 0u) return;
+
+#if ZSTD_CODEC_USE_THREADS
+    const auto nb_workers = std::min(task_count, static_cast<usize>(std::max(nb_threads, 1))) - 1u;
+#else
+    const auto nb_workers = static_cast<usize>(0u);
+#endif
+
+    if (nb_workers == 0u) {
+        for (usize i = 0; i < task_count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    // NOTE: workers may pick up the state after all tasks are done, so they share its ownership.
+    const auto state = std::make_shared<ParallelForState>(task_count, task);
+
+    EnsureWorkers(nb_workers);
+    for (usize i = 0; i < nb_workers; ++i) {
+        Post([state]() { RunTasks(*state); });
+    }
+
+    RunTasks(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->all_done.wait(lock, [&state]() { return state->done_count == state->task_count; });
+}
+
+
+usize ZstdThreadPool::WorkerCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return workers_.size();
+}
+
+
+int ZstdThreadPool::HardwareThreads()
+{
+#if ZSTD_CODEC_USE_THREADS
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+#else
+    return 1;
+#endif
+}
+
+
+void ZstdThreadPool::Post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+
+    task_posted_.notify_one();
+}
+
+
+void ZstdThreadPool::EnsureWorkers(usize nb_workers)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    while (workers_.size() < nb_workers) {
+        workers_.emplace_back(&ZstdThreadPool::WorkerMain, this);
+    }
+}
+
+
+void ZstdThreadPool::WorkerMain()
+{
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_posted_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+
+        task();
+    }
+}
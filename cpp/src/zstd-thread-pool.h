@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "common-types.h"
+
+
+// NOTE: single-threaded Emscripten builds can't start threads, tasks run on the calling thread.
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+# define ZSTD_CODEC_USE_THREADS (0)
+#else
+# define ZSTD_CODEC_USE_THREADS (1)
+#endif
+
+
+/*
+ZstdThreadPool runs tasks on worker threads, started on demand and kept until the pool is destroyed.
+
+ParallelFor runs tasks on the calling thread too, so `nb_threads` threads take `nb_threads - 1` workers.
+on the pthreads build, workers come from PTHREAD_POOL_SIZE, don't ask for more on the browser main thread.
+*/
+class ZstdThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    ZstdThreadPool();
+    ~ZstdThreadPool();
+
+    ZstdThreadPool(const ZstdThreadPool&) = delete;
+    ZstdThreadPool& operator=(const ZstdThreadPool&) = delete;
+
+    // runs task(0) .. task(task_count - 1) on up to `nb_threads` threads, returns when all of them are done.
+    void ParallelFor(usize task_count, int nb_threads, const std::function<void(usize)>& task);
+
+    usize WorkerCount() const;
+
+    // returns 1 if threads are not available.
+    static int HardwareThreads();
+
+private:
+    void Post(Task task);
+    void EnsureWorkers(usize nb_workers);
+    void WorkerMain();
+
+    mutable std::mutex          mutex_;
+    std::condition_variable     task_posted_;
+    std::deque<Task>            tasks_;
+    Vec<std::thread>            workers_;
+    bool                        stopping_;
+};
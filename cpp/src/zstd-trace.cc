@@ -0,0 +1,54 @@
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+
+#if defined(__EMSCRIPTEN__)
+# include <emscripten.h>
+#endif
+
+#include "zstd-trace.h"
+
+
+static const char* LevelName(TraceLevel level)
+{
+    switch (level) {
+    case TraceLevel::Error: return "error";
+    case TraceLevel::Info:  return "info";
+    case TraceLevel::Debug: return "debug";
+    }
+
+    return "trace";
+}
+
+
+static void DefaultTraceSink(TraceLevel level, const char* message)
+{
+#if defined(__EMSCRIPTEN__)
+    const auto flags = level == TraceLevel::Error ? (EM_LOG_CONSOLE | EM_LOG_ERROR) : EM_LOG_CONSOLE;
+    emscripten_log(flags, "## zstd-codec %s: %s", LevelName(level), message);
+#else
+    fprintf(stderr, "## zstd-codec %s: %s\n", LevelName(level), message);
+#endif
+}
+
+
+static std::atomic<TraceSink> s_trace_sink { &DefaultTraceSink };
+
+
+void SetTraceSink(TraceSink sink)
+{
+    s_trace_sink.store(sink != nullptr ? sink : &DefaultTraceSink);
+}
+
+
+void Trace(TraceLevel level, const char* format, ...)
+{
+    char message[256];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    s_trace_sink.load()(level, message);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common-types.h"
+
+
+/*
+Compile-time tracing.
+
+ZSTD_CODEC_TRACE_LEVEL selects which TRACE_* macros are compiled in,
+the others expand to nothing (no call, no argument evaluation).
+
+    0: off (default on release builds)
+    1: errors (default on debug builds)
+    2: info
+    3: debug, per-call traces on streaming hot paths
+
+Enabled traces are formatted with printf-style arguments and written to the sink,
+stderr by default (browser console on Emscripten).
+*/
+#ifndef ZSTD_CODEC_TRACE_LEVEL
+# if DEBUG
+#  define ZSTD_CODEC_TRACE_LEVEL (1)
+# else
+#  define ZSTD_CODEC_TRACE_LEVEL (0)
+# endif
+#endif
+
+
+enum class TraceLevel
+{
+    Error = 1,
+    Info = 2,
+    Debug = 3,
+};
+
+
+using TraceSink = void (*)(TraceLevel level, const char* message);
+
+// replaces the sink, nullptr restores the default one.
+void SetTraceSink(TraceSink sink);
+
+void Trace(TraceLevel level, const char* format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+
+#if ZSTD_CODEC_TRACE_LEVEL >= 1
+# define TRACE_ERROR(...) Trace(TraceLevel::Error, __VA_ARGS__)
+#else
+# define TRACE_ERROR(...) ((void)0)
+#endif
+
+#if ZSTD_CODEC_TRACE_LEVEL >= 2
+# define TRACE_INFO(...) Trace(TraceLevel::Info, __VA_ARGS__)
+#else
+# define TRACE_INFO(...) ((void)0)
+#endif
+
+#if ZSTD_CODEC_TRACE_LEVEL >= 3
+# define TRACE_DEBUG(...) Trace(TraceLevel::Debug, __VA_ARGS__)
+#else
+# define TRACE_DEBUG(...) ((void)0)
+#endif
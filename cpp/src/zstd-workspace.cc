@@ -0,0 +1,30 @@
+#include "zstd-workspace.h"
+
+
+//
+// ZstdWorkspace
+//
+////////////////////////////////////////////////////////////////////////////////
+
+ZstdWorkspace::ZstdWorkspace()
+    : storage_()
+    , data_(nullptr)
+    , size_(0)
+{
+}
+
+
+ZstdWorkspace::ZstdWorkspace(void* data, usize size)
+    : storage_()
+    , data_(data)
+    , size_(data != nullptr ? size : 0u)
+{
+}
+
+
+ZstdWorkspace::ZstdWorkspace(usize size)
+    : storage_((size + sizeof(u64) - 1) / sizeof(u64))
+    , data_(storage_.data())
+    , size_(size)
+{
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "common-types.h"
+
+
+/*
+ZstdWorkspace is the memory a static context is initialized into (ZSTD_initStaticCCtx/ZSTD_initStaticDCtx).
+a static context never allocates, it fails when it needs more than its workspace holds.
+
+it references caller's memory (8-byte aligned, outliving the context), or owns memory reserved up front.
+a context given an empty workspace (e.g. ZstdWorkspace(0)) fails, it isn't allocated as usual.
+*/
+class ZstdWorkspace
+{
+public:
+    ZstdWorkspace();
+    ZstdWorkspace(void* data, usize size);
+    explicit ZstdWorkspace(usize size);
+
+    ZstdWorkspace(ZstdWorkspace&&) = default;
+    ZstdWorkspace& operator=(ZstdWorkspace&&) = default;
+    ZstdWorkspace(const ZstdWorkspace&) = delete;
+    ZstdWorkspace& operator=(const ZstdWorkspace&) = delete;
+
+    void* data() const { return data_; }
+    usize size() const { return size_; }
+    bool empty() const { return data_ == nullptr; }
+
+private:
+    Vec<u64>    storage_;   // empty unless reserved here, u64 keeps it 8-byte aligned
+    void*       data_;
+    usize       size_;
+};
@@ -6,7 +6,11 @@ if [ -z "${ZSTD_DIR}" ]; then
     ZSTD_DIR="${CPP_DIR}/zstd"
 fi
 
+if [ -z "${ZSTD_MT_DIR}" ]; then
+    ZSTD_MT_DIR="${ZSTD_DIR}"
+fi
+
 echo '------------------------------------------------------------'
 premake5 gmake2 --with-zstd-dir=${ZSTD_DIR}
 echo '------------------------------------------------------------'
-premake5 gmake2 --with-zstd-dir=${ZSTD_DIR} --with-emscripten
+premake5 gmake2 --with-zstd-dir=${ZSTD_DIR} --with-zstd-mt-dir=${ZSTD_MT_DIR} --with-emscripten
@@ -0,0 +1,232 @@
+// Benchmark runner of JS API, counterpart of cpp/bench/bench-zstd-codec.cc
+//
+// usage: node bench/bench.js [--quick] [--wasm] [output.json]
+//     --quick: run each case once
+//     --wasm:  use Emscripten binding even if native addon is available
+//
+// measures throughput (MB/s of uncompressed bytes) and memory usage of
+// Simple, Streaming, Dict and Read paths, then writes the results as JSON.
+
+const fs = require('fs');
+const path = require('path');
+
+const ZstdCodec = require('../lib/zstd-codec.js');
+const Module = require('../lib/module.js');
+
+const FIXTURES = [
+    'lorem.txt',
+    'sample-books.json',
+    'dance_yorokobi_mai_man.bmp',
+    'dance_yorokobi_mai_woman.bmp',
+];
+
+const LEVELS = [1, 3, 9];
+const CHUNK_SIZES = [1 * 1024, 32 * 1024, 512 * 1024];
+
+const DICT_FIXTURE = 'sample-books.json';
+const DICT_NAME = 'sample-dict';
+
+const fixtureBinary = (name) => {
+    const data = fs.readFileSync(path.join(__dirname, '..', 'lib', '__tests__', 'fixtures', name));
+    return new Uint8Array(data.buffer, data.byteOffset, data.length);
+};
+
+const splitChunks = (bytes, chunk_size) => {
+    const chunks = [];
+    for (let offset = 0; offset < bytes.length; offset += chunk_size) {
+        chunks.push(bytes.subarray(offset, offset + chunk_size));
+    }
+    return chunks;
+};
+
+const parseArgs = (argv) => {
+    const args = { quick: false, wasm: false, output: null };
+    for (const arg of argv) {
+        if (arg === '--quick') args.quick = true;
+        else if (arg === '--wasm') args.wasm = true;
+        else args.output = arg;
+    }
+    return args;
+};
+
+const args = parseArgs(process.argv.slice(2));
+const config = args.quick
+    ? { min_iterations: 1, min_seconds: 0 }
+    : { min_iterations: 5, min_seconds: 0.2 };
+
+// NOTE: `body` returns compressed size of the iteration.
+const measure = (label, content_size, body) => {
+    const compressed_size = body();     // warm up
+
+    const memory_before = process.memoryUsage();
+    const begin = process.hrtime.bigint();
+
+    let iterations = 0;
+    let elapsed = 0;
+    while (iterations < config.min_iterations || elapsed < config.min_seconds) {
+        body();
+        iterations += 1;
+        elapsed = Number(process.hrtime.bigint() - begin) / 1e9;
+    }
+
+    const memory_after = process.memoryUsage();
+    const total_mb = content_size * iterations / (1024 * 1024);
+
+    return Object.assign({}, label, {
+        content_size: content_size,
+        compressed_size: compressed_size,
+        iterations: iterations,
+        mb_per_sec: Number((total_mb / elapsed).toFixed(2)),
+        heap_used_delta: memory_after.heapUsed - memory_before.heapUsed,
+        array_buffers_delta: (memory_after.arrayBuffers || 0) - (memory_before.arrayBuffers || 0),
+    });
+};
+
+const benchSimple = (zstd, results) => {
+    const simple = new zstd.Simple();
+
+    for (const fixture of FIXTURES) {
+        const content = fixtureBinary(fixture);
+
+        for (const level of LEVELS) {
+            const label = { api: 'simple', variant: '', fixture: fixture, level: level, chunk_size: 0 };
+            const compressed = simple.compress(content, level);
+
+            results.push(measure(Object.assign({ operation: 'compress' }, label), content.length, () => {
+                return simple.compress(content, level).length;
+            }));
+            results.push(measure(Object.assign({ operation: 'decompress' }, label), content.length, () => {
+                simple.decompress(compressed);
+                return compressed.length;
+            }));
+        }
+    }
+};
+
+const benchStreaming = (zstd, results) => {
+    const simple = new zstd.Simple();
+    const streaming = new zstd.Streaming();
+
+    for (const fixture of FIXTURES) {
+        const content = fixtureBinary(fixture);
+
+        for (const level of LEVELS) {
+            const compressed = simple.compress(content, level);
+
+            for (const chunk_size of CHUNK_SIZES) {
+                const label = { api: 'streaming', variant: '', fixture: fixture, level: level, chunk_size: chunk_size };
+                const content_chunks = splitChunks(content, chunk_size);
+                const compressed_chunks = splitChunks(compressed, chunk_size);
+
+                results.push(measure(Object.assign({ operation: 'compress' }, label), content.length, () => {
+                    return streaming.compressChunks(content_chunks, content.length, level).length;
+                }));
+                results.push(measure(Object.assign({ operation: 'decompress' }, label), content.length, () => {
+                    streaming.decompressChunks(compressed_chunks, content.length);
+                    return compressed.length;
+                }));
+            }
+        }
+    }
+};
+
+const benchDict = (zstd, results) => {
+    const simple = new zstd.Simple();
+    const content = fixtureBinary(DICT_FIXTURE);
+    const dict_bytes = fixtureBinary(DICT_NAME);
+    const ddict = new zstd.Dict.Decompression(dict_bytes);
+
+    for (const level of LEVELS) {
+        const label = { api: 'dict', variant: '', fixture: DICT_FIXTURE, level: level, chunk_size: 0 };
+        const cdict = new zstd.Dict.Compression(dict_bytes, level);
+        const compressed = simple.compressUsingDict(content, cdict);
+
+        results.push(measure(Object.assign({ operation: 'compress' }, label), content.length, () => {
+            return simple.compressUsingDict(content, cdict).length;
+        }));
+        results.push(measure(Object.assign({ operation: 'decompress' }, label), content.length, () => {
+            simple.decompressUsingDict(compressed, ddict);
+            return compressed.length;
+        }));
+
+        cdict.delete();
+    }
+
+    ddict.delete();
+};
+
+// NOTE: Read path has no wrapper in zstd-codec.js yet, drive the binding directly.
+const benchRead = (zstd, binding, results) => {
+    const simple = new zstd.Simple();
+    const callback = () => {};
+
+    for (const fixture of FIXTURES) {
+        const content = fixtureBinary(fixture);
+        const compressed = simple.compress(content, 3);
+
+        for (const chunk_size of CHUNK_SIZES) {
+            const label = { api: 'read', operation: 'decompress', variant: '', fixture: fixture, level: 3, chunk_size: chunk_size };
+            const compressed_chunks = splitChunks(compressed, chunk_size);
+
+            results.push(measure(label, content.length, () => {
+                const stream = new binding.ZstdDecompressReadBinding();
+                try {
+                    stream.begin();
+                    for (const chunk of compressed_chunks) {
+                        stream.load(chunk);
+                        while (stream.read(callback)) {
+                        }
+                    }
+                    stream.end(callback);
+                }
+                finally {
+                    stream.delete();
+                }
+                return compressed.length;
+            }));
+
+            const dest = new Uint8Array(128 * 1024);
+            results.push(measure(Object.assign({}, label, { variant: 'pull' }), content.length, () => {
+                const stream = new binding.ZstdDecompressReadBinding();
+                try {
+                    stream.begin();
+                    for (const chunk of compressed_chunks) {
+                        stream.load(chunk);
+                        while (stream.readInto(dest) > 0) {
+                        }
+                    }
+                    stream.end(callback);
+                }
+                finally {
+                    stream.delete();
+                }
+                return compressed.length;
+            }));
+        }
+    }
+};
+
+const options = { native: !args.wasm };
+Module.run((binding) => {
+    ZstdCodec.run((zstd) => {
+        const results = [];
+        benchSimple(zstd, results);
+        benchStreaming(zstd, results);
+        benchDict(zstd, results);
+        benchRead(zstd, binding, results);
+
+        const report = {
+            binding: binding.HEAPU8 ? 'emscripten' : 'native',
+            node_version: process.version,
+            results: results,
+        };
+
+        const json = JSON.stringify(report, null, 2) + '\n';
+        if (args.output) {
+            fs.writeFileSync(args.output, json);
+        }
+        else {
+            process.stdout.write(json);
+        }
+    }, options);
+}, options);
@@ -1,2 +1,3 @@
 window.ZstdCodec = require('./lib/zstd-codec.js');
 window.ZstdStream = require('./lib/zstd-stream.js');
+window.ZstdWebStream = require('./lib/zstd-web-stream.js');
@@ -3,6 +3,7 @@ const path = require('path');
 const textEncoding = require('text-encoding');
 const TextEncoder = textEncoding.TextEncoder;
 const ZstdCodec = require('../zstd-codec.js');
+const ZstdModule = require('../module.js');
 
 const fixturePath = (name) => {
     return path.join(__dirname, 'fixtures', name);
@@ -17,6 +18,14 @@ const tempPath = (name) => {
     return path.join(__dirname, 'tmp', name);
 };
 
+// NOTE: prebuilt Emscripten bindings may predate apis under test, their tests are skipped there with a warning.
+//       the native addon has all of them, see `npm test`.
+const bindingLacks = (missing_symbols, symbols) => {
+    const missing = symbols.filter(symbol => (missing_symbols || []).includes(symbol));
+    if (missing.length > 0) console.warn(`skipped, the binding lacks ${missing.join(', ')}`);
+    return missing.length > 0;
+};
+
 const LOREM_TEXT = 'Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat. Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint occaecat cupidatat non proident, sunt in culpa qui officia deserunt mollit anim id est laborum.';
 
 
@@ -69,6 +78,42 @@ describe('ZstdCodec.Generic', () => {
                 done();
             });
         });
+
+        it('should distinguish unknown content size from invalid data', done => {
+            ZstdCodec.run((zstd) => {
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCompressionParams', 'ZstdCodec#compressUsingParams'])) return done();
+
+                const generic = new zstd.Generic();
+                const simple = new zstd.Simple();
+
+                const compressed_bytes = simple.compressUsingParams(fixtureBinary('lorem.txt'), { contentSizeFlag: false });
+                expect(generic.contentSize(compressed_bytes)).toBeUndefined();
+                expect(generic.contentSize(fixtureBinary('lorem.txt'))).toBeNull();
+
+                done();
+            });
+        });
+    });
+
+    describe('releaseContexts()', () => {
+        it('should keep codec usable after releasing pooled contexts', done => {
+            ZstdCodec.run((zstd) => {
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCodec#releaseContexts'])) return done();
+
+                const generic = new zstd.Generic();
+                const simple = new zstd.Simple();
+                const lorem_bytes = fixtureBinary('lorem.txt');
+
+                const first = simple.compress(lorem_bytes);
+                generic.releaseContexts();
+                const second = simple.compress(lorem_bytes);
+
+                expect(second).toEqual(first);
+                expect(simple.decompress(second)).toEqual(lorem_bytes);
+
+                done();
+            });
+        });
     });
 });
 
@@ -105,6 +150,58 @@ describe('ZstdCodec.Simple', () => {
                 done();
             });
         });
+
+        it('should decompress data without content size', done => {
+            ZstdCodec.run((zstd) => {
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCompressionParams', 'ZstdCodec#compressUsingParams'])) return done();
+
+                const simple = new zstd.Simple();
+                const lorem_bytes = fixtureBinary('lorem.txt');
+                const compressed_bytes = simple.compressUsingParams(lorem_bytes, { contentSizeFlag: false });
+
+                expect(simple.decompress(compressed_bytes)).toEqual(lorem_bytes);
+
+                done();
+            });
+        });
+    });
+
+    describe('compressUsingParams()', () => {
+        it('should compress data with advanced parameters', done => {
+            ZstdCodec.run((zstd) => {
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCompressionParams', 'ZstdCodec#compressUsingParams'])) return done();
+
+                const simple = new zstd.Simple();
+                const params = {
+                    compressionLevel: 9,
+                    windowLog: 20,
+                    strategy: zstd.Strategy.btopt,
+                    checksumFlag: true,
+                };
+
+                const man_bytes = fixtureBinary('dance_yorokobi_mai_man.bmp');
+                const compressed_bytes = simple.compressUsingParams(man_bytes, params);
+                expect(compressed_bytes.length).toBeLessThan(man_bytes.length);
+
+                const check_bytes = simple.decompress(compressed_bytes);
+                expect(check_bytes).toHaveLength(man_bytes.length);
+                expect(check_bytes.slice(0, 500000).toString()).toEqual(man_bytes.slice(0, 500000).toString());
+
+                done();
+            });
+        });
+
+        it('should fail on out of bound parameters', done => {
+            ZstdCodec.run((zstd) => {
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCompressionParams', 'ZstdCodec#compressUsingParams'])) return done();
+
+                const simple = new zstd.Simple();
+                const lorem_bytes = fixtureBinary('lorem.txt');
+                expect(simple.compressUsingParams(lorem_bytes, { windowLog: 1 })).toBeNull();
+
+                done();
+            });
+        });
     });
 
     describe('compressUsingDict', () => {
@@ -131,6 +228,71 @@ describe('ZstdCodec.Simple', () => {
                 done();
             });
         });
+
+        it('should not depend on dictionary lifetime', done => {
+            ZstdCodec.run((zstd) => {
+                const simple = new zstd.Simple();
+                const books_bytes = fixtureBinary('sample-books.json');
+
+                // dictionaries reference their own copy of the content (ZSTD_dlm_byRef), not caller's bytes
+                const dict_bytes = fixtureBinary('sample-dict');
+                const cdict = new zstd.Dict.Compression(dict_bytes, 5);
+                const ddict = new zstd.Dict.Decompression(dict_bytes);
+                dict_bytes.fill(0);
+
+                const compressed_bytes = simple.compressUsingDict(books_bytes, cdict);
+                expect(simple.decompressUsingDict(compressed_bytes, ddict)).toEqual(books_bytes);
+
+                // frames don't reference the dictionary, a new one of the same content decompresses them
+                cdict.delete();
+                ddict.delete();
+
+                const other_ddict = new zstd.Dict.Decompression(fixtureBinary('sample-dict'));
+                expect(simple.decompressUsingDict(compressed_bytes, other_ddict)).toEqual(books_bytes);
+                other_ddict.delete();
+
+                done();
+            });
+        });
+    });
+
+    describe('compressBatch()/decompressBatch()', () => {
+        it('should round-trip many small buffers', done => {
+            ZstdCodec.run((zstd) => {
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCodec#compressBatch', 'ZstdCodec#decompressBatch'])) return done();
+
+                const simple = new zstd.Simple();
+                const lines = fs.readFileSync(fixturePath('sample-books.json'), 'utf8').split('\n');
+                const items = lines.map(line => new TextEncoder().encode(line));
+
+                const compressed_items = simple.compressBatch(items, 3);
+                expect(compressed_items).toHaveLength(items.length);
+                expect(simple.decompress(compressed_items[1])).toEqual(items[1]);
+
+                expect(simple.decompressBatch(compressed_items)).toEqual(items);
+                expect(simple.compressBatch([], 3)).toEqual([]);
+
+                done();
+            });
+        });
+
+        it('should decompress frames without content size', done => {
+            ZstdCodec.run((zstd) => {
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCompressionParams', 'ZstdCodec#compressUsingParams', 'ZstdCodec#decompressBatch'])) return done();
+
+                const simple = new zstd.Simple();
+                const lorem_bytes = fixtureBinary('lorem.txt');
+                const items = [
+                    simple.compress(lorem_bytes, 3),
+                    simple.compressUsingParams(lorem_bytes, { contentSizeFlag: false }),
+                ];
+
+                expect(simple.decompressBatch(items)).toEqual([lorem_bytes, lorem_bytes]);
+                expect(simple.decompressBatch([items[0], lorem_bytes])).toBeNull();
+
+                done();
+            });
+        });
     });
 });
 
@@ -183,6 +345,85 @@ describe('ZstdCodec.Streaming', () => {
         });
     });
 
+    describe('compressUsingParams()', () => {
+        it('should compress chunked data with advanced parameters', done => {
+            ZstdCodec.run(zstd => {
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCompressionParams', 'ZstdCompressStreamBinding#beginUsingParams'])) return done();
+
+                const streaming = new zstd.Streaming();
+                const params = {
+                    compressionLevel: 5,
+                    enableLongDistanceMatching: true,
+                    contentSizeFlag: false,
+                };
+
+                const lorem_bytes = fixtureBinary('lorem.txt');
+                const chunks = new TypedArrayChunks(lorem_bytes, 64);
+                const compressed_bytes = streaming.compressChunksUsingParams(chunks, 512, params);
+                expect(compressed_bytes.length).toBeLessThan(lorem_bytes.length);
+
+                const check_bytes = streaming.decompress(compressed_bytes);
+                expect(check_bytes).toEqual(lorem_bytes);
+
+                done();
+            });
+        });
+    });
+
+    describe('compressParallel()', () => {
+        it('should compress blocks as independent frames', done => {
+            ZstdCodec.run(zstd => {
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCompressionParams', 'ZstdCodec#compressParallel', 'ZstdCodec#compressParallelUsingParams'])) return done();
+
+                const streaming = new zstd.Streaming();
+                const man_bytes = fixtureBinary('dance_yorokobi_mai_man.bmp');
+
+                const compressed_bytes = streaming.compressParallel(man_bytes, 3, 4, 128 * 1024);
+                expect(compressed_bytes.length).toBeLessThan(man_bytes.length);
+                expect(streaming.decompress(compressed_bytes)).toEqual(man_bytes);
+
+                // output doesn't depend on the number of threads
+                expect(streaming.compressParallel(man_bytes, 3, 1, 128 * 1024)).toEqual(compressed_bytes);
+
+                const params_bytes = streaming.compressParallelUsingParams(man_bytes, { compressionLevel: 3, checksumFlag: true }, 2, 128 * 1024);
+                expect(params_bytes.length).toBeGreaterThan(compressed_bytes.length);
+                expect(streaming.decompress(params_bytes)).toEqual(man_bytes);
+
+                expect(streaming.decompress(streaming.compressParallel(new Uint8Array(0)))).toEqual(new Uint8Array(0));
+
+                done();
+            });
+        });
+    });
+
+    describe('decompressParallel()', () => {
+        it('should decompress concatenated frames', done => {
+            ZstdCodec.run(zstd => {
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCodec#compressParallel', 'ZstdCodec#decompressParallel', 'ZstdSeekableCompressStreamBinding'])) return done();
+
+                const streaming = new zstd.Streaming();
+                const man_bytes = fixtureBinary('dance_yorokobi_mai_man.bmp');
+
+                const compressed_bytes = streaming.compressParallel(man_bytes, 3, 4, 64 * 1024);
+                expect(streaming.decompressParallel(compressed_bytes, 4)).toEqual(man_bytes);
+                expect(streaming.decompressParallel(compressed_bytes, 1)).toEqual(man_bytes);
+
+                // skips seek table of seekable format
+                const seekable_bytes = new zstd.Seekable().compress(man_bytes, 3, 64 * 1024);
+                expect(streaming.decompressParallel(seekable_bytes)).toEqual(man_bytes);
+
+                // fallback to streaming, frames without content size
+                const streamed_bytes = streaming.compressChunks([man_bytes.subarray(0, 1000), man_bytes.subarray(1000)], 0, 3);
+                expect(streaming.decompressParallel(streamed_bytes, 2)).toEqual(man_bytes);
+
+                expect(streaming.decompressParallel(new Uint8Array(0))).toEqual(new Uint8Array(0));
+                expect(streaming.decompressParallel(compressed_bytes.subarray(0, 100))).toBeNull();
+
+                done();
+            });
+        });
+    });
+
     describe('decompress()', () => {
         it('should decompress whole data', done => {
             ZstdCodec.run(zstd => {
@@ -236,6 +477,34 @@ describe('ZstdCodec.Streaming', () => {
                 done();
             });
         });
+
+        it('should decompress empty input', done => {
+            ZstdCodec.run(zstd => {
+                const streaming = new zstd.Streaming();
+                expect(streaming.decompress(new Uint8Array(0))).toEqual(new Uint8Array(0));
+
+                // empty chunks between and after frames
+                const lorem_bytes = fixtureBinary('lorem.txt');
+                const chunks = [new Uint8Array(0), fixtureBinary('lorem.txt.zst'), new Uint8Array(0)];
+                expect(streaming.decompressChunks(chunks, 0)).toEqual(lorem_bytes);
+
+                done();
+            });
+        });
+
+        it('should fail on truncated data', done => {
+            ZstdCodec.run(zstd => {
+                // NOTE: bindings older than this tree's ZstdDecompressStream accept truncated frames.
+                if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdDecompressStreamBinding#beginUsingRegistry'])) return done();
+
+                const streaming = new zstd.Streaming();
+
+                const zst_bytes = fixtureBinary('lorem.txt.zst');
+                expect(streaming.decompress(zst_bytes.slice(0, zst_bytes.length - 8))).toBe(null);
+
+                done();
+            });
+        });
     });
 
     describe('compress/decompress using dict', () => {
@@ -293,3 +562,582 @@ describe('ZstdCodec.Streaming', () => {
         });
     });
 });
+
+
+describe('ZstdCodec.Dict.Trainer', () => {
+    const bookSamples = () => {
+        const text = fs.readFileSync(fixturePath('sample-books.json'), 'utf8');
+        return text.split('\n').filter(line => line.length > 0).map(line => new TextEncoder().encode(line));
+    };
+
+    it('should train dictionary from samples', done => {
+        ZstdCodec.run(zstd => {
+            if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdDictTrainer'])) return done();
+
+            const simple = new zstd.Simple();
+            const trainer = new zstd.Dict.Trainer();
+
+            const samples = bookSamples();
+            for (const sample of samples) {
+                trainer.addSample(sample);
+            }
+            expect(trainer.sampleCount).toBe(samples.length);
+
+            const dict_bytes = trainer.train(4096, { algorithm: 'fastCover', steps: 4 });
+            expect(dict_bytes).toEqual(expect.any(Uint8Array));
+            expect(dict_bytes.length).toBeLessThanOrEqual(4096);
+            expect(zstd.Dict.Trainer.dictID(dict_bytes)).toBeGreaterThan(0);
+
+            const cdict = new zstd.Dict.Compression(dict_bytes, 3);
+            const ddict = new zstd.Dict.Decompression(dict_bytes);
+
+            const record = samples[samples.length - 1];
+            const compressed_bytes = simple.compressUsingDict(record, cdict);
+            expect(compressed_bytes.length).toBeLessThan(simple.compress(record, 3).length);
+            expect(simple.decompressUsingDict(compressed_bytes, ddict)).toEqual(record);
+
+            cdict.delete();
+            ddict.delete();
+            trainer.delete();
+
+            done();
+        });
+    });
+
+    it('should fail without enough samples', done => {
+        ZstdCodec.run(zstd => {
+            if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdDictTrainer'])) return done();
+
+            const trainer = new zstd.Dict.Trainer();
+            expect(trainer.train(4096)).toBe(null);
+            trainer.delete();
+
+            done();
+        });
+    });
+});
+
+
+describe('ZstdCodec.Dict.Registry', () => {
+    it('should pick dictionary by frame', done => {
+        ZstdCodec.run(zstd => {
+            if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdDictTrainer', 'ZstdDictRegistry'])) return done();
+
+            const simple = new zstd.Simple();
+            const streaming = new zstd.Streaming();
+
+            const books_bytes = fixtureBinary('sample-books.json');
+            const trainer = new zstd.Dict.Trainer();
+            for (const line of fs.readFileSync(fixturePath('sample-books.json'), 'utf8').split('\n')) {
+                trainer.addSample(new TextEncoder().encode(line));
+            }
+            const dicts = [fixtureBinary('sample-dict'), trainer.train(4096, { algorithm: 'fastCover', steps: 4 })];
+            trainer.delete();
+
+            const registry = new zstd.Dict.Registry();
+            const dict_ids = dicts.map(dict_bytes => registry.add(dict_bytes));
+            expect(registry.size).toBe(2);
+            expect(dict_ids[0]).toBe(zstd.Dict.Trainer.dictID(dicts[0]));
+            expect(registry.has(dict_ids[1])).toBe(true);
+            expect(registry.add(new Uint8Array(64))).toBe(null);
+
+            const frames = dicts.map(dict_bytes => {
+                const cdict = new zstd.Dict.Compression(dict_bytes, 3);
+                const compressed_bytes = simple.compressUsingDict(books_bytes, cdict);
+                cdict.delete();
+                return compressed_bytes;
+            });
+            frames.push(simple.compress(books_bytes, 3));
+
+            for (const frame of frames) {
+                expect(simple.decompressUsingDict(frame, registry)).toEqual(books_bytes);
+            }
+
+            // concatenated frames use different dictionaries
+            const all_bytes = new Uint8Array(frames.reduce((size, frame) => size + frame.length, 0));
+            frames.reduce((offset, frame) => {
+                all_bytes.set(frame, offset);
+                return offset + frame.length;
+            }, 0);
+
+            const decompressed_bytes = streaming.decompressChunksUsingDict(new TypedArrayChunks(all_bytes, 7), 0, registry);
+            expect(decompressed_bytes.length).toBe(books_bytes.length * frames.length);
+            expect(decompressed_bytes.subarray(books_bytes.length, books_bytes.length * 2)).toEqual(books_bytes);
+            expect(simple.decompressUsingDict(all_bytes, registry)).toEqual(decompressed_bytes);
+
+            // frame without content size falls back to streaming
+            const streamed_frame = streaming.compress(books_bytes, 3);
+            expect(new zstd.Generic().contentSize(streamed_frame)).toBeUndefined();
+            const unknown_size_bytes = new Uint8Array(frames[0].length + streamed_frame.length);
+            unknown_size_bytes.set(frames[0]);
+            unknown_size_bytes.set(streamed_frame, frames[0].length);
+            expect(simple.decompressUsingDict(unknown_size_bytes, registry)).toEqual(decompressed_bytes.subarray(0, books_bytes.length * 2));
+
+            registry.remove(dict_ids[0]);
+            expect(registry.has(dict_ids[0])).toBe(false);
+            expect(simple.decompressUsingDict(frames[0], registry)).toBe(null);
+
+            registry.delete();
+            done();
+        });
+    });
+});
+
+describe('ZstdCodec.Dict.CompressionCache', () => {
+    it('should digest dictionary per compression level', done => {
+        ZstdCodec.run(zstd => {
+            if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdDictTrainer', 'ZstdCDictCache'])) return done();
+
+            const simple = new zstd.Simple();
+            const streaming = new zstd.Streaming();
+
+            const books_bytes = fixtureBinary('sample-books.json');
+            const dict_bytes = fixtureBinary('sample-dict');
+            const ddict = new zstd.Dict.Decompression(dict_bytes);
+
+            const cache = new zstd.Dict.CompressionCache();
+            const dict_id = cache.add(dict_bytes);
+            expect(dict_id).toBe(zstd.Dict.Trainer.dictID(dict_bytes));
+            expect(cache.has(dict_id)).toBe(true);
+            expect(cache.add(new Uint8Array(64))).toBe(null);
+            expect(cache.digestedCount).toBe(0);
+
+            for (const level of [1, 19, 1]) {
+                const compressed_bytes = simple.compressUsingDict(books_bytes, cache.dict(dict_id, level));
+                expect(simple.decompressUsingDict(compressed_bytes, ddict)).toEqual(books_bytes);
+            }
+            expect(cache.digestedCount).toBe(2);
+            expect(cache.memoryUsage).toBeGreaterThan(0);
+
+            const streamed_bytes = streaming.compressUsingDict(books_bytes, cache.dict(dict_id, 1));
+            expect(streaming.decompressUsingDict(streamed_bytes, undefined, ddict)).toEqual(books_bytes);
+            expect(cache.digestedCount).toBe(2);
+
+            // most recently used one is kept
+            cache.memoryBudget = 0;
+            expect(cache.digestedCount).toBe(1);
+
+            cache.remove(dict_id);
+            expect(cache.has(dict_id)).toBe(false);
+            expect(cache.digestedCount).toBe(0);
+            expect(simple.compressUsingDict(books_bytes, cache.dict(dict_id, 1))).toBe(null);
+
+            cache.delete();
+            ddict.delete();
+            done();
+        });
+    });
+});
+
+describe('ZstdCodec.Seekable', () => {
+    it('should decompress ranges of seekable data', done => {
+        ZstdCodec.run(zstd => {
+            if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdSeekableCompressStreamBinding', 'ZstdSeekableReaderBinding'])) return done();
+
+            const seekable = new zstd.Seekable();
+            const streaming = new zstd.Streaming();
+
+            const man_bytes = fixtureBinary('dance_yorokobi_mai_man.bmp');
+            const compressed_bytes = seekable.compressChunks(new TypedArrayChunks(man_bytes, 100000), 0, 3, 64 * 1024);
+            expect(streaming.decompress(compressed_bytes)).toEqual(man_bytes);
+
+            const reader = new zstd.SeekableReader();
+            expect(reader.open(compressed_bytes)).toBe(true);
+            expect(reader.frameCount).toBe(Math.ceil(man_bytes.length / (64 * 1024)));
+            expect(reader.contentSize).toBe(man_bytes.length);
+
+            const ranges = [[0, 10], [65530, 20], [300000, 200000], [man_bytes.length - 5, 100]];
+            for (const [offset, size] of ranges) {
+                expect(reader.read(offset, size)).toEqual(man_bytes.subarray(offset, offset + size));
+            }
+
+            // reads through a source, only frames covering the range
+            const reads = [];
+            const source = (offset, size) => {
+                reads.push(size);
+                return compressed_bytes.subarray(offset, offset + size);
+            };
+            expect(reader.open(source, compressed_bytes.length)).toBe(true);
+            expect(reader.read(200000, 1000)).toEqual(man_bytes.subarray(200000, 201000));
+            expect(reads).toHaveLength(3);   // footer, seek table, one frame
+
+            expect(reader.open(new Uint8Array(64))).toBe(false);
+
+            // seek table entries: [compressed size, decompressed size, (checksum)] before the 9 bytes footer
+            const corruptEntry = (field, value) => {
+                const corrupted_bytes = compressed_bytes.slice();
+                const entry_size = (corrupted_bytes[corrupted_bytes.length - 5] & 0x80) ? 12 : 8;
+                const entry_offset = corrupted_bytes.length - 9 - entry_size;   // last frame
+                new DataView(corrupted_bytes.buffer).setUint32(entry_offset + field * 4, value, true);
+                return corrupted_bytes;
+            };
+            expect(reader.open(corruptEntry(1, 0xffffffff))).toBe(false);
+            expect(reader.open(corruptEntry(0, 0))).toBe(false);
+
+            // within bounds, but the frame doesn't decompress to the recorded size
+            expect(reader.open(corruptEntry(1, 1000))).toBe(true);
+            expect(reader.read((reader.frameCount - 1) * 64 * 1024, 1)).toBeNull();
+            reader.delete();
+
+            done();
+        });
+    });
+});
+
+describe('ZstdCodec.Allocator', () => {
+    it('should report bytes of contexts made with it', done => {
+        ZstdCodec.run(zstd => {
+            if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdAllocator', 'createMallocAllocator', 'createPoolAllocator', 'createArenaAllocator'])) return done();
+
+            const man_bytes = fixtureBinary('dance_yorokobi_mai_man.bmp');
+
+            for (const allocator of [zstd.Allocator.malloc(), zstd.Allocator.pool(), zstd.Allocator.arena(32 * 1024 * 1024)]) {
+                const simple = new zstd.Simple({ allocator });
+                const streaming = new zstd.Streaming({ allocator });
+
+                const compressed_bytes = simple.compress(man_bytes, 3);
+                expect(simple.decompress(compressed_bytes)).toEqual(man_bytes);
+                expect(allocator.peakBytes).toBeGreaterThan(0);
+                expect(allocator.reservedBytes).toBeGreaterThan(0);
+
+                allocator.resetPeak();
+                expect(streaming.decompress(streaming.compress(man_bytes, 3))).toEqual(man_bytes);
+                expect(allocator.peakBytes).toBeGreaterThan(0);
+
+                simple.close();
+                streaming.close();
+                expect(allocator.currentBytes).toBe(0);
+                allocator.delete();
+            }
+
+            // arena is too small for the workspace
+            const small = zstd.Allocator.arena(16 * 1024);
+            const simple = new zstd.Simple({ allocator: small });
+            expect(simple.compress(man_bytes, 19)).toBe(null);
+            simple.delete();
+            small.delete();
+
+            done();
+        });
+    });
+});
+
+describe('ZstdCodec static contexts', () => {
+    it('should compress and decompress in static workspaces', done => {
+        ZstdCodec.run(zstd => {
+            if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCodec.staticCompressWorkspaceSize', 'ZstdCompressStreamBinding.staticWorkspaceSize'])) return done();
+
+            const man_bytes = fixtureBinary('dance_yorokobi_mai_man.bmp');
+            const books_bytes = fixtureBinary('sample-books.json');
+
+            const simple = new zstd.Simple({ static: { compressionLevel: 3 } });
+            const streaming = new zstd.Streaming({ static: { compressionLevel: 3 } });
+
+            for (const bytes of [man_bytes, books_bytes]) {
+                expect(simple.decompress(simple.compress(bytes, 3))).toEqual(bytes);
+                expect(streaming.decompress(streaming.compress(bytes, 3))).toEqual(bytes);
+            }
+            expect(streaming.decompress(simple.compress(books_bytes, 1))).toEqual(books_bytes);
+
+            simple.close();
+            streaming.close();
+
+            // workspace of level 1 is too small for level 19
+            const small = new zstd.Simple({ static: { compressionLevel: 1 } });
+            expect(small.compress(man_bytes, 19)).toBe(null);
+            small.close();
+
+            done();
+        });
+    });
+});
+
+describe('ZstdCodec memory estimation', () => {
+    it('should estimate heap bytes of contexts', done => {
+        ZstdCodec.run(zstd => {
+            if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCodec.estimateCompressMemory', 'ZstdCompressStreamBinding.estimateMemory', 'ZstdCodec#memoryUsage'])) return done();
+
+            const generic = new zstd.Generic();
+            const books_bytes = fixtureBinary('sample-books.json');
+
+            for (const level of [1, 3, 19]) {
+                // NOTE: own allocators, pooled contexts of `simple` would count in peaks of `streaming`.
+                const simple_allocator = zstd.Allocator.malloc();
+                const simple = new zstd.Simple({ allocator: simple_allocator });
+                simple.compress(books_bytes, level);
+                expect(simple_allocator.peakBytes).toBeLessThanOrEqual(generic.estimateCompressMemory(level, books_bytes.length));
+                expect(generic.estimateCompressMemory(level, books_bytes.length)).toBeLessThanOrEqual(generic.estimateCompressMemory(level));
+                expect(simple.memoryUsage).toBeGreaterThan(0);
+                simple.close();
+                simple_allocator.delete();
+
+                const allocator = zstd.Allocator.malloc();
+                const streaming = new zstd.Streaming({ allocator });
+                const compressed_bytes = streaming.compress(books_bytes, level);
+                expect(allocator.peakBytes).toBeLessThanOrEqual(generic.estimateStreamingCompressMemory(level));
+
+                allocator.resetPeak();
+                streaming.decompress(compressed_bytes);
+                expect(allocator.peakBytes).toBeLessThanOrEqual(generic.estimateStreamingDecompressMemory(compressed_bytes));
+
+                streaming.close();
+                allocator.delete();
+            }
+
+            expect(generic.estimateCompressMemory({ compressionLevel: 3, enableLongDistanceMatching: true }))
+                .toBeGreaterThan(generic.estimateCompressMemory(3));
+            expect(generic.estimateCompressMemory({ windowLog: 99 })).toBe(null);
+            expect(generic.estimateStreamingDecompressMemory(new Uint8Array(2))).toBe(null);
+
+            const dict_bytes = fixtureBinary('sample-dict');
+            const cdict = new zstd.Dict.Compression(dict_bytes, 3);
+            const ddict = new zstd.Dict.Decompression(dict_bytes);
+            expect(cdict.memoryUsage).toBeGreaterThan(dict_bytes.length);
+            expect(cdict.memoryUsage).toBeLessThanOrEqual(generic.estimateCompressionDictMemory(dict_bytes.length, 3));
+            expect(ddict.memoryUsage).toBeLessThanOrEqual(generic.estimateDecompressionDictMemory(dict_bytes.length));
+            cdict.delete();
+            ddict.delete();
+
+            done();
+        });
+    });
+});
+
+describe('ZstdDecompressReadBinding', () => {
+    // reads all of `compressed_bytes` in `chunk_size` chunks into `dest_size` destinations,
+    // returns decompressed bytes and whether end() succeeded.
+    const readChunks = (binding, compressed_bytes, chunk_size, dest_size) => {
+        const stream = new binding.ZstdDecompressReadBinding();
+        expect(stream.begin()).toBe(true);
+
+        // nothing loaded yet, 0 asks for the next chunk
+        const dest = new Uint8Array(dest_size);
+        expect(stream.readInto(dest)).toBe(0);
+
+        const chunks = [];
+        let pending_reads = 0;
+        for (const chunk of new TypedArrayChunks(compressed_bytes, chunk_size)) {
+            expect(stream.load(chunk)).toBe(true);
+            for (;;) {
+                const had_input = stream.hasInput();
+                const read_size = stream.readInto(dest);
+                expect(read_size).toBeGreaterThanOrEqual(0);
+                if (read_size === 0) break;
+
+                expect(read_size).toBeLessThanOrEqual(dest_size);
+                if (!had_input) pending_reads++;
+                chunks.push(dest.slice(0, read_size));
+            }
+            expect(stream.hasInput()).toBe(false);
+        }
+
+        const ended = stream.end(() => {});
+        stream.delete();
+
+        return { bytes: Buffer.concat(chunks), ended, pending_reads };
+    };
+
+    it('should read into destinations smaller than a block', done => {
+        ZstdModule.run(binding => {
+            if (bindingLacks(binding.missingSymbols, ['ZstdDecompressReadBinding'])) return done();
+
+            const woman_bytes = fixtureBinary('dance_yorokobi_mai_woman.bmp');
+            const compressed_bytes = fixtureBinary('dance_yorokobi_mai_woman.bmp.zst');
+
+            const result = readChunks(binding, compressed_bytes, 1000, 100);
+            expect(new Uint8Array(result.bytes)).toEqual(woman_bytes);
+            expect(result.ended).toBe(true);
+
+            // last byte of a block decodes all of it, the rest is read after its input is consumed
+            const lorem_result = readChunks(binding, fixtureBinary('lorem.txt.zst'), 1, 100);
+            expect(new Uint8Array(lorem_result.bytes)).toEqual(fixtureBinary('lorem.txt'));
+            expect(lorem_result.ended).toBe(true);
+            expect(lorem_result.pending_reads).toBeGreaterThan(0);
+
+            done();
+        });
+    });
+
+    it('should fail to end truncated frame', done => {
+        ZstdModule.run(binding => {
+            if (bindingLacks(binding.missingSymbols, ['ZstdDecompressReadBinding'])) return done();
+
+            const compressed_bytes = fixtureBinary('dance_yorokobi_mai_woman.bmp.zst');
+            const truncated_bytes = compressed_bytes.slice(0, compressed_bytes.length - 100);
+
+            const result = readChunks(binding, truncated_bytes, 1000, 100);
+            expect(result.ended).toBe(false);
+
+            done();
+        });
+    });
+
+    it('should end without input', done => {
+        ZstdModule.run(binding => {
+            if (bindingLacks(binding.missingSymbols, ['ZstdDecompressReadBinding'])) return done();
+
+            const stream = new binding.ZstdDecompressReadBinding();
+            expect(stream.begin()).toBe(true);
+            expect(stream.readInto(new Uint8Array(100))).toBe(0);
+            expect(stream.end(() => {})).toBe(true);
+            stream.delete();
+
+            done();
+        });
+    });
+
+    it('should return error code on invalid input', done => {
+        ZstdModule.run(binding => {
+            if (bindingLacks(binding.missingSymbols, ['ZstdDecompressReadBinding'])) return done();
+
+            const stream = new binding.ZstdDecompressReadBinding();
+            expect(stream.begin()).toBe(true);
+            expect(stream.load(new Uint8Array(16))).toBe(true);
+            expect(stream.readInto(new Uint8Array(100))).toBeLessThan(0);
+            stream.delete();
+
+            done();
+        });
+    });
+});
+
+describe('ZstdStreamBinding zero-copy', () => {
+    // NOTE: Emscripten stream bindings take input written into their heap (`inputBuffer`/`transformInput`),
+    //       and pass output to callbacks as views of the heap. the native addon has neither.
+    const lacksHeapInput = (binding) => {
+        const lacks = typeof binding.ZstdCompressStreamBinding.prototype.inputBuffer !== 'function';
+        if (lacks) console.warn('skipped, the binding lacks inputBuffer/transformInput');
+        return lacks;
+    };
+
+    // writes `bytes` through the stream's input buffer in `piece_size` pieces, returns copies of callback views.
+    const transformThroughInput = (binding, stream, bytes, piece_size) => {
+        const outputs = [];
+        const callback = view => {
+            // view is only valid until the callback returns, copy it here
+            expect(view.buffer).toBe(binding.HEAPU8.buffer);
+            outputs.push(view.slice());
+        };
+
+        for (const piece of new TypedArrayChunks(bytes, piece_size)) {
+            const input = stream.inputBuffer(piece.length);
+            expect(input.buffer).toBe(binding.HEAPU8.buffer);
+            expect(input.length).toBe(piece.length);
+            input.set(piece);
+            expect(stream.transformInput(piece.length, callback)).toBe(true);
+        }
+        expect(stream.transformInput(piece_size + 1, callback)).toBe(false);   // larger than written
+        expect(stream.end(callback)).toBe(true);
+
+        return Buffer.concat(outputs);
+    };
+
+    it('should transform input written into the heap', done => {
+        ZstdModule.run(binding => {
+            if (lacksHeapInput(binding)) return done();
+
+            const man_bytes = fixtureBinary('dance_yorokobi_mai_man.bmp');
+
+            const cstream = new binding.ZstdCompressStreamBinding();
+            expect(cstream.begin(3)).toBe(true);
+            const compressed_bytes = transformThroughInput(binding, cstream, man_bytes, 100000);
+            cstream.delete();
+
+            const dstream = new binding.ZstdDecompressStreamBinding();
+            expect(dstream.begin()).toBe(true);
+            const decompressed_bytes = transformThroughInput(binding, dstream, compressed_bytes, 10000);
+            dstream.delete();
+
+            expect(new Uint8Array(decompressed_bytes)).toEqual(man_bytes);
+            done();
+        });
+    });
+
+    it('should not keep views across heap growth', done => {
+        ZstdModule.run(binding => {
+            // NOTE: builds with `inputBuffer` grow the heap (ALLOW_MEMORY_GROWTH), older ones abort instead.
+            if (lacksHeapInput(binding)) return done();
+
+            const lorem_bytes = new TextEncoder().encode(LOREM_TEXT);
+            let retained_view = null;
+            let output_bytes = null;
+
+            const stream = new binding.ZstdCompressStreamBinding();
+            expect(stream.begin(3)).toBe(true);
+            expect(stream.transform(lorem_bytes, () => {})).toBe(true);
+            expect(stream.end(view => {
+                retained_view = view;
+                output_bytes = view.slice();
+            })).toBe(true);
+            const input_view = stream.inputBuffer(16);
+
+            // growing replaces the heap buffer, views of the old one are detached
+            const heap_buffer = binding.HEAPU8.buffer;
+            const address = binding._malloc(heap_buffer.byteLength);
+            expect(address).toBeGreaterThan(0);
+            expect(binding.HEAPU8.buffer === heap_buffer).toBe(false);
+            expect(retained_view.length).toBe(0);
+            expect(input_view.length).toBe(0);
+            expect(stream.inputBuffer(16).length).toBe(16);     // ask for the buffer again
+            binding._free(address);
+            stream.delete();
+
+            // copy taken in the callback is still intact
+            const dstream = new binding.ZstdDecompressStreamBinding();
+            const decompressed = [];
+            expect(dstream.begin()).toBe(true);
+            expect(dstream.transform(output_bytes, view => decompressed.push(view.slice()))).toBe(true);
+            expect(dstream.end(view => decompressed.push(view.slice()))).toBe(true);
+            dstream.delete();
+
+            expect(new Uint8Array(Buffer.concat(decompressed))).toEqual(lorem_bytes);
+            done();
+        });
+    });
+});
+
+describe('ZstdCodec.Async', () => {
+    it('should compress and decompress on worker threads', () => {
+        return new Promise(resolve => ZstdCodec.run(resolve)).then(zstd => {
+            if (bindingLacks(zstd.bindingMissingSymbols, ['ZstdCompressionParams', 'ZstdCodec#compressUsingParams'])) return undefined;
+
+            const pool = new zstd.Async({ size: 2 });
+            expect(pool.size).toBe(2);
+
+            const man_bytes = fixtureBinary('dance_yorokobi_mai_man.bmp');
+            const books_bytes = fixtureBinary('sample-books.json');
+            const expected = new zstd.Simple().compress(books_bytes, 3);
+
+            return Promise.all([
+                pool.compress(man_bytes, 3).then(compressed => pool.decompress(compressed)),
+                pool.compress(books_bytes, 3),
+                pool.compressUsingParams(books_bytes, { compressionLevel: 3 }),
+                pool.decompress(new Uint8Array(16)),
+            ]).then(([man_again, books_compressed, params_compressed, invalid]) => {
+                expect(man_again).toEqual(man_bytes);
+                expect(books_compressed).toEqual(expected);
+                expect(params_compressed).toEqual(expected);
+                expect(invalid).toBe(null);
+
+                // input buffer is detached after transferred
+                const transfer_pool = new zstd.Async({ size: 1, transfer: true });
+                const content_bytes = books_bytes.slice();
+                const compressing = transfer_pool.compress(content_bytes, 3);
+                expect(content_bytes.length).toBe(0);
+
+                return compressing.then(compressed => {
+                    expect(compressed).toEqual(expected);
+                    return transfer_pool.close();
+                });
+            }).then(() => {
+                return pool.close();
+            }).then(() => {
+                return pool.compress(books_bytes, 3).then(() => {
+                    throw new Error('closed pool should reject');
+                }, error => {
+                    expect(error.message).toMatch(/closed/);
+                });
+            });
+        });
+    });
+});
@@ -0,0 +1,120 @@
+const fs = require('fs');
+const path = require('path');
+const ZstdWebStream = require('../zstd-web-stream.js');
+
+const fixtureBinary = (name) => {
+    const data = fs.readFileSync(path.join(__dirname, 'fixtures', name));
+    return new Uint8Array(data);
+};
+
+// NOTE: prebuilt Emscripten bindings may predate apis under test, their tests are skipped there with a warning.
+//       the native addon has all of them, see `npm test`.
+const bindingLacks = (missing_symbols, symbols) => {
+    const missing = symbols.filter(symbol => (missing_symbols || []).includes(symbol));
+    if (missing.length > 0) console.warn(`skipped, the binding lacks ${missing.join(', ')}`);
+    return missing.length > 0;
+};
+
+const webStreams = () => {
+    return typeof ReadableStream === 'function' ? { ReadableStream } : require('stream/web');
+};
+
+const chunkedStream = (bytes, chunk_size) => {
+    const { ReadableStream } = webStreams();
+    return new ReadableStream({
+        start(controller) {
+            for (let offset = 0; offset < bytes.length; offset += chunk_size) {
+                controller.enqueue(bytes.slice(offset, offset + chunk_size));
+            }
+            controller.close();
+        },
+    });
+};
+
+const readAll = (readable, byob_size) => {
+    const reader = byob_size ? readable.getReader({ mode: 'byob' }) : readable.getReader();
+    const chunks = [];
+
+    const next = () => {
+        const read = byob_size ? reader.read(new Uint8Array(byob_size)) : reader.read();
+        return read.then(({ value, done }) => {
+            if (done) return;
+            chunks.push(value);
+            return next();
+        });
+    };
+
+    return next().then(() => {
+        const result = new Uint8Array(chunks.reduce((size, chunk) => size + chunk.length, 0));
+        chunks.reduce((offset, chunk) => {
+            result.set(chunk, offset);
+            return offset + chunk.length;
+        }, 0);
+        return result;
+    });
+};
+
+
+describe('ZstdXXXStream', () => {
+    it('should compress and decompress through pipeThrough', () => {
+        return new Promise(resolve => ZstdWebStream.run(resolve)).then(streams => {
+            if (bindingLacks(streams.bindingMissingSymbols, ['ZstdDecompressReadBinding'])) return undefined;
+
+            const woman_bytes = fixtureBinary('dance_yorokobi_mai_woman.bmp');
+            const zst_bytes = fixtureBinary('dance_yorokobi_mai_woman.bmp.zst');
+
+            return readAll(chunkedStream(zst_bytes, 10000).pipeThrough(new streams.ZstdDecompressionStream()))
+                .then(decompressed => {
+                    expect(decompressed).toEqual(woman_bytes);
+
+                    const compressing = chunkedStream(woman_bytes, 100000).pipeThrough(new streams.ZstdCompressionStream(3));
+                    return readAll(compressing, 4096);
+                })
+                .then(compressed => {
+                    expect(compressed.length).toBeLessThan(woman_bytes.length);
+
+                    // BYOB reader gets decompressed bytes in its own buffers
+                    const decompressing = chunkedStream(compressed, 3333).pipeThrough(new streams.ZstdDecompressionStream());
+                    return readAll(decompressing, 10000);
+                })
+                .then(decompressed => {
+                    expect(decompressed).toEqual(woman_bytes);
+                });
+        });
+    });
+
+    it('should error both sides on invalid input', () => {
+        return new Promise(resolve => ZstdWebStream.run(resolve)).then(streams => {
+            if (bindingLacks(streams.bindingMissingSymbols, ['ZstdDecompressReadBinding'])) return undefined;
+
+            const decompressing = chunkedStream(new Uint8Array(100).fill(7), 10).pipeThrough(new streams.ZstdDecompressionStream());
+            return readAll(decompressing).then(() => {
+                throw new Error('invalid frame should error');
+            }, error => {
+                expect(error.message).toMatch(/ZstdDecompressionStream/);
+            });
+        });
+    });
+
+    it('should error both sides on truncated input', () => {
+        return new Promise(resolve => ZstdWebStream.run(resolve)).then(streams => {
+            if (bindingLacks(streams.bindingMissingSymbols, ['ZstdDecompressReadBinding'])) return undefined;
+
+            const zst_bytes = fixtureBinary('dance_yorokobi_mai_woman.bmp.zst');
+            const truncated_bytes = zst_bytes.slice(0, zst_bytes.length - 100);
+
+            const decompression = new streams.ZstdDecompressionStream();
+            const writing = chunkedStream(truncated_bytes, 10000).pipeTo(decompression.writable);
+            const reading = readAll(decompression.readable);
+
+            const expectError = (promise, side) => {
+                return promise.then(() => {
+                    throw new Error(`truncated frame should error ${side} side`);
+                }, error => {
+                    expect(error.message).toMatch(/ZstdDecompressionStream: Error on end/);
+                });
+            };
+            return Promise.all([expectError(writing, 'writable'), expectError(reading, 'readable')]);
+        });
+    });
+});
@@ -1,2 +1,100 @@
 exports.DEFAULT_COMPRESSION_LEVEL = 3;
 exports.STREAMING_DEFAULT_BUFFER_SIZE = 512 * 1024;
+
+// NOTE: same value as `ZstdPoolAllocator::DEFAULT_MAX_CACHED_BYTES` in zstd-allocator.h
+exports.POOL_DEFAULT_MAX_CACHED_BYTES = 64 * 1024 * 1024;
+
+// NOTE: window of compression levels up to 19 (windowLog 23), static decompression streams are sized for it by default.
+exports.STATIC_DEFAULT_MAX_WINDOW_SIZE = 8 * 1024 * 1024;
+
+// NOTE: same value as `ERR_CONTENT_SIZE_UNKNOWN` in zstd-codec.h
+exports.ERR_CONTENT_SIZE_UNKNOWN = -7;
+
+// NOTE: same values as `ZSTD_strategy`
+exports.Strategy = Object.freeze({
+    fast: 1,
+    dfast: 2,
+    greedy: 3,
+    lazy: 4,
+    lazy2: 5,
+    btlazy2: 6,
+    btopt: 7,
+    btultra: 8,
+    btultra2: 9,
+});
+
+// NOTE: classes (methods, static methods) and functions of the Emscripten binding that the JS api uses,
+//       same as `EMSCRIPTEN_BINDINGS` in cpp/src/binding/emscripten/zstd-binding.cc, keep them in sync.
+//       `inputBuffer`/`transformInput` are optional, callers fall back to `transform` without them.
+exports.BINDING_CLASSES = Object.freeze({
+    ZstdCompressionDict: [['memoryUsage'], ['estimateMemory']],
+    ZstdDecompressionDict: [['memoryUsage'], ['estimateMemory']],
+    ZstdAllocator: [['currentBytes', 'peakBytes', 'reservedBytes', 'resetPeak', 'trim'], []],
+    ZstdCompressionParams: [[], []],
+    ZstdDictTrainingParams: [[], []],
+    ZstdDictTrainer: [['addSample', 'clear', 'sampleCount', 'samplesSize', 'train', 'trainCover', 'trainFastCover'], ['dictID']],
+    ZstdDictRegistry: [['add', 'clear', 'contains', 'count', 'remove'], []],
+    ZstdCDictCache: [['addDict', 'clear', 'containsDict', 'digestedCount', 'memoryBudget', 'memoryUsage', 'removeDict', 'setMemoryBudget'], []],
+    ZstdCodec: [
+        ['compress', 'compressBatch', 'compressBound', 'compressParallel', 'compressParallelUsingParams', 'compressUsingCache',
+         'compressUsingDict', 'compressUsingParams', 'contentSize', 'decompress', 'decompressBatch', 'decompressParallel',
+         'decompressUsingDict', 'framesContentSize', 'decompressUsingRegistry', 'memoryUsage', 'releaseContexts'],
+        ['estimateCompressMemory', 'estimateCompressMemoryUsingParams', 'estimateDecompressMemory', 'maxWorkers',
+         'staticCompressWorkspaceSize', 'staticDecompressWorkspaceSize'],
+    ],
+    ZstdCompressStreamBinding: [
+        ['begin', 'beginUsingCache', 'beginUsingDict', 'beginUsingParams', 'end', 'flush', 'memoryUsage', 'transform'],
+        ['estimateMemory', 'estimateMemoryUsingParams', 'staticWorkspaceSize'],
+    ],
+    ZstdDecompressStreamBinding: [
+        ['begin', 'beginUsingDict', 'beginUsingRegistry', 'end', 'flush', 'memoryUsage', 'transform'],
+        ['estimateMemory', 'staticWorkspaceSize'],
+    ],
+    ZstdDecompressReadBinding: [
+        ['begin', 'beginUsingDict', 'beginUsingRegistry', 'end', 'flush', 'hasInput', 'load', 'memoryUsage', 'read', 'readInto'],
+        ['estimateMemory', 'staticWorkspaceSize'],
+    ],
+    ZstdSeekableCompressStreamBinding: [['begin', 'beginUsingParams', 'end', 'endFrame', 'frameCount', 'transform'], []],
+    ZstdSeekableReaderBinding: [['close', 'contentSize', 'frameCount', 'open', 'openUsingSource', 'read'], []],
+});
+
+exports.BINDING_FUNCTIONS = Object.freeze([
+    'cloneToVector',
+    'cloneAsTypedArray',
+    'toTypedArrayView',
+    'createCompressionDict',
+    'createDecompressionDict',
+    'createMallocAllocator',
+    'createArenaAllocator',
+    'createPoolAllocator',
+]);
+
+// NOTE: property names of `ZstdCompressionParams` binding
+exports.COMPRESSION_PARAMS = Object.freeze([
+    'compressionLevel',
+    'windowLog',
+    'hashLog',
+    'chainLog',
+    'searchLog',
+    'minMatch',
+    'targetLength',
+    'strategy',
+    'enableLongDistanceMatching',
+    'checksumFlag',
+    'contentSizeFlag',
+    'nbWorkers',
+]);
+
+// NOTE: property names of `ZstdDictTrainingParams` binding
+exports.DICT_TRAINING_PARAMS = Object.freeze([
+    'k',
+    'd',
+    'f',
+    'steps',
+    'accel',
+    'nbThreads',
+    'splitPoint',
+    'compressionLevel',
+]);
+
+exports.DEFAULT_DICT_CAPACITY = 112640;   // same as zstd CLI's `--maxdict` default (110KiB)
@@ -1,12 +1,34 @@
 class ArrayBufferHelper {
     static transfer(old_buffer, new_capacity) {
+        if (new_capacity <= old_buffer.byteLength) {
+            return old_buffer.slice(0, new_capacity);
+        }
+
         const bytes = new Uint8Array(new ArrayBuffer(new_capacity));
-        bytes.set(new Uint8Array(old_buffer.slice(0, new_capacity)));
+        bytes.set(new Uint8Array(old_buffer));
         return bytes.buffer;
     }
 }
 
 
+// NOTE: Emscripten bindings accept input written into their heap by `inputBuffer(size)`,
+//       feed large bytes piece by piece to keep heap usage bounded.
+//       native addon reads JS memory directly, so `transform` has no copy there.
+const transformBytes = (stream, bytes, callback, piece_size) => {
+    if (!stream.inputBuffer) {
+        return stream.transform(bytes, callback);
+    }
+
+    for (let offset = 0; offset < bytes.length; offset += piece_size) {
+        const piece = bytes.subarray(offset, offset + piece_size);
+        stream.inputBuffer(piece.length).set(piece);
+        if (!stream.transformInput(piece.length, callback)) return false;
+    }
+
+    return true;
+};
+
+
 const getClassName = (obj) => {
     if (!obj || typeof obj != 'object') return null;
 
@@ -47,12 +69,14 @@ const toTypedArray = (chunk, encoding, string_decoder) => {
 
 
 // NOTE: only available on Node.js environment
+// NOTE: shares memory with `typedArray`, which may be a view of a larger buffer.
 const fromTypedArrayToBuffer = (typedArray) => {
-    return Buffer.from(typedArray.buffer);
+    return Buffer.from(typedArray.buffer, typedArray.byteOffset, typedArray.byteLength);
 };
 
 
 exports.ArrayBufferHelper = ArrayBufferHelper;
+exports.transformBytes = transformBytes;
 exports.getClassName = getClassName;
 exports.isUint8Array = isUint8Array;
 exports.isString = isString;
@@ -1,3 +1,5 @@
+const constants = require('./constants.js');
+
 // REF: https://stackoverflow.com/a/47880734
 const wasmSupported = (() => {
     try {
@@ -12,9 +14,70 @@ const wasmSupported = (() => {
     return false;
 })();
 
-exports.run = (f) => {
+// NOTE: native addon is built per platform (see `zstd-codec-binding-node` in cpp/premake5.lua),
+//       use variable path to keep bundlers from resolving it.
+const nativeAddonPath = './zstd-codec-binding-node.node';
+const isNode = typeof process === 'object' && process.versions && process.versions.node;
+
+// returns null unless the addon is built, throws instead when it is `required`.
+const loadNativeAddon = (required) => {
+    try {
+        if (!isNode) throw new Error('not running on Node.js');
+        return require(nativeAddonPath);
+    } catch (e) {
+        if (!required) return null;
+        throw new Error(`zstd-codec: native addon is not available (${e.message}), see "Native addon" in README.md`);
+    }
+};
+
+// NOTE: `options.native` true requires the addon, false skips it.
+//       otherwise ZSTD_CODEC_BINDING=native|emscripten picks one (e.g. to test each), or the addon is used if built.
+const nativeOption = (options) => {
+    if (options && options.native !== undefined) return !!options.native;
+
+    const binding = isNode && process.env ? process.env.ZSTD_CODEC_BINDING : undefined;
+    if (binding === 'native') return true;
+    if (binding === 'emscripten') return false;
+    return undefined;
+};
+
+// NOTE: prebuilt Emscripten bindings in this directory may predate apis of the JS layer (rebuild them with
+//       update-zstd-binding.sh), callers detect those apis with the symbols missing here.
+// returns the symbols of `constants.BINDING_CLASSES`/`BINDING_FUNCTIONS` the binding lacks.
+const findMissingSymbols = (binding) => {
+    const missing = [];
+    for (const name of Object.keys(constants.BINDING_CLASSES)) {
+        const [methods, static_methods] = constants.BINDING_CLASSES[name];
+        if (typeof binding[name] !== 'function') {
+            missing.push(name);
+            continue;
+        }
+
+        for (const method of methods) {
+            if (typeof binding[name].prototype[method] !== 'function') missing.push(`${name}#${method}`);
+        }
+        for (const method of static_methods) {
+            if (typeof binding[name][method] !== 'function') missing.push(`${name}.${method}`);
+        }
+    }
+    for (const name of constants.BINDING_FUNCTIONS) {
+        if (typeof binding[name] !== 'function') missing.push(name);
+    }
+
+    return missing;
+};
+
+exports.run = (f, options) => {
+    const native = nativeOption(options);
+    const addon = native !== false ? loadNativeAddon(native === true) : null;
+    if (addon) {
+        f(addon);
+        return;
+    }
+
     const Module = {};
     Module.onRuntimeInitialized = () => {
+        Module.missingSymbols = findMissingSymbols(Module);
         f(Module);
     };
 
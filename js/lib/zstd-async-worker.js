@@ -0,0 +1,29 @@
+// NOTE: worker of `zstd.Async`, see zstd-async.js
+const worker_threads = require('worker_threads');
+const ZstdCodec = require('./zstd-codec.js');
+
+const parentPort = worker_threads.parentPort;
+
+ZstdCodec.run((zstd) => {
+    const simple = new zstd.Simple();
+    const methods = {
+        compress: (content_bytes, compression_level) => simple.compress(content_bytes, compression_level),
+        compressUsingParams: (content_bytes, params) => simple.compressUsingParams(content_bytes, params),
+        decompress: (compressed_bytes) => simple.decompress(compressed_bytes),
+    };
+
+    parentPort.on('message', (message) => {
+        let result = null;
+        let error = null;
+        try {
+            result = methods[message.method].apply(null, message.args);
+        }
+        catch (e) {
+            error = String(e && e.message || e);
+        }
+
+        // NOTE: results own their buffers, transfer them back without copying.
+        const transfer = result && result.buffer instanceof ArrayBuffer ? [result.buffer] : [];
+        parentPort.postMessage({ result, error }, transfer);
+    });
+}, worker_threads.workerData.run_options);
@@ -0,0 +1,131 @@
+// NOTE: Node.js only, use variable names to keep bundlers from resolving them.
+const workerThreadsModule = 'worker_threads';
+const osModule = 'os';
+const pathModule = 'path';
+
+const defaultPoolSize = () => {
+    const os = require(osModule);
+    return os.availableParallelism ? os.availableParallelism() : Math.max(1, os.cpus().length);
+};
+
+// NOTE: transfer only bytes owning the whole buffer, others share it (e.g. pooled Buffer).
+const isTransferable = (bytes) => {
+    return bytes && bytes.buffer instanceof ArrayBuffer
+        && bytes.byteOffset === 0 && bytes.byteLength === bytes.buffer.byteLength;
+};
+
+// runs Simple API calls on worker threads, each of them loads its own binding and codec.
+class ZstdAsync {
+    // options: { size: number of workers (default: cores), transfer: transfer input buffers instead of copying }
+    constructor(options, run_options) {
+        this._Worker = require(workerThreadsModule).Worker;
+        this._script_path = require(pathModule).join(__dirname, 'zstd-async-worker.js');
+        this._size = (options && options.size) || defaultPoolSize();
+        this._transfer = !!(options && options.transfer);
+        this._run_options = run_options || {};
+        this._slots = [];
+        this._queue = [];
+        this._closed = false;
+    }
+
+    get size() {
+        return this._size;
+    }
+
+    compress(content_bytes, compression_level) {
+        return this._post('compress', [content_bytes, compression_level]);
+    }
+
+    compressUsingParams(content_bytes, params) {
+        return this._post('compressUsingParams', [content_bytes, params]);
+    }
+
+    decompress(compressed_bytes) {
+        return this._post('decompress', [compressed_bytes]);
+    }
+
+    // rejects queued calls, resolves when all workers exit.
+    close() {
+        this._closed = true;
+
+        const queue = this._queue;
+        this._queue = [];
+        queue.forEach(job => job.reject(new Error('zstd-codec: async pool is closed')));
+
+        const slots = this._slots;
+        this._slots = [];
+        return Promise.all(slots.map(slot => slot.worker.terminate())).then(() => undefined);
+    }
+
+    delete() {
+        return this.close();
+    }
+
+    _post(method, args) {
+        return new Promise((resolve, reject) => {
+            if (this._closed) {
+                reject(new Error('zstd-codec: async pool is closed'));
+                return;
+            }
+
+            // NOTE: input bytes are detached once posted, when transferred.
+            const transfer = this._transfer && isTransferable(args[0]) ? [args[0].buffer] : [];
+            this._queue.push({ message: { method, args }, transfer, resolve, reject });
+            this._dispatch();
+        });
+    }
+
+    _dispatch() {
+        while (this._queue.length > 0) {
+            const slot = this._slots.find(slot => !slot.job)
+                || (this._slots.length < this._size ? this._spawn() : null);
+            if (!slot) return;
+
+            slot.job = this._queue.shift();
+            slot.worker.ref();
+            slot.worker.postMessage(slot.job.message, slot.job.transfer);
+        }
+    }
+
+    _spawn() {
+        const worker = new this._Worker(this._script_path, { workerData: { run_options: this._run_options } });
+        const slot = { worker, job: null, error: null };
+
+        // NOTE: idle workers don't keep the process alive.
+        worker.unref();
+
+        worker.on('message', (reply) => {
+            const job = slot.job;
+            slot.job = null;
+            worker.unref();
+
+            if (reply.error) {
+                job.reject(new Error(reply.error));
+            }
+            else {
+                job.resolve(reply.result);
+            }
+            this._dispatch();
+        });
+
+        worker.on('error', (error) => {
+            slot.error = error;
+        });
+
+        worker.on('exit', () => {
+            const index = this._slots.indexOf(slot);
+            if (index >= 0) this._slots.splice(index, 1);
+
+            if (slot.job) {
+                slot.job.reject(slot.error || new Error('zstd-codec: async worker exited'));
+                slot.job = null;
+            }
+            if (!this._closed) this._dispatch();
+        });
+
+        this._slots.push(slot);
+        return slot;
+    }
+}
+
+exports.ZstdAsync = ZstdAsync;
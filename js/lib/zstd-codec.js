@@ -1,7 +1,9 @@
 const ArrayBufferHelper = require('./helpers.js').ArrayBufferHelper;
+const transformBytes = require('./helpers.js').transformBytes;
 const constants = require('./constants.js');
+const ZstdAsync = require('./zstd-async.js').ZstdAsync;
 
-const onReady = (binding) => {
+const onReady = (binding, run_options) => {
     const codec = new binding.ZstdCodec();
 
     const withBindingInstance = (instance, callback) => {
@@ -13,22 +15,132 @@ const onReady = (binding) => {
         }
     };
 
+    // NOTE: embind picks constructor overloads by argument count, pass the allocator only when given.
+    const newWithAllocator = (klass, options) => {
+        const allocator = options && options.allocator;
+        return allocator ? new klass(allocator.get()) : new klass();
+    };
+
+    // `options.allocator` or `options.static` gives an object contexts of its own, instead of the shared ones.
+    const hasOwnContexts = (options) => {
+        return !!(options && (options.allocator || options.static));
+    };
+
+    // NOTE: static contexts are initialized into workspaces reserved once, sized for `options.static`.
+    const newCodec = (options) => {
+        if (!hasOwnContexts(options)) return codec;
+        if (!options.static) return newWithAllocator(binding.ZstdCodec, options);
+
+        const level = correctCompressionLevel(options.static.compressionLevel);
+        return new binding.ZstdCodec(binding.ZstdCodec.staticCompressWorkspaceSize(level),
+                                     binding.ZstdCodec.staticDecompressWorkspaceSize());
+    };
+
+    const newStaticStream = (klass, static_options) => {
+        const workspace_size = klass === binding.ZstdCompressStreamBinding
+            ? klass.staticWorkspaceSize(correctCompressionLevel(static_options.compressionLevel))
+            : klass.staticWorkspaceSize(static_options.maxWindowSize || constants.STATIC_DEFAULT_MAX_WINDOW_SIZE);
+        return new klass(workspace_size);
+    };
+
     const withCppVector = (callback) => {
         const vector = new binding.VectorU8();
         return withBindingInstance(vector, callback);
     };
 
+    const withCompressionParams = (params, callback) => {
+        const binding_params = new binding.ZstdCompressionParams();
+        for (const name of constants.COMPRESSION_PARAMS) {
+            if (params && params[name] !== undefined) {
+                binding_params[name] = params[name];
+            }
+        }
+
+        return withBindingInstance(binding_params, callback);
+    };
+
+    const withDictTrainingParams = (params, callback) => {
+        const binding_params = new binding.ZstdDictTrainingParams();
+        for (const name of constants.DICT_TRAINING_PARAMS) {
+            if (params && params[name] !== undefined) {
+                binding_params[name] = params[name];
+            }
+        }
+
+        return withBindingInstance(binding_params, callback);
+    };
+
     const correctCompressionLevel = (compression_level) => {
         return compression_level || constants.DEFAULT_COMPRESSION_LEVEL;
     };
 
+    const beginStream = (stream, compression_level, nb_workers) => {
+        return nb_workers
+            ? stream.begin(compression_level, nb_workers)
+            : stream.begin(compression_level);
+    };
+
+    // NOTE: `cdict` is either `ZstdCompressionDict` or a dictionary of `ZstdCompressionDictCache`.
+    const beginCompressStreamUsingDict = (stream, cdict) => {
+        return cdict instanceof CachedCompressionDict
+            ? stream.beginUsingCache(cdict.cache.get(), cdict.dict_id, cdict.compression_level)
+            : stream.beginUsingDict(cdict.get());
+    };
+
+    // NOTE: `ddict` is either `ZstdDecompressionDict` or `ZstdDictRegistry`, which picks dictionary by frame.
+    const beginDecompressStreamUsingDict = (stream, ddict) => {
+        return ddict instanceof ZstdDictRegistry
+            ? stream.beginUsingRegistry(ddict.get())
+            : stream.beginUsingDict(ddict.get());
+    };
+
+    // NOTE: batch items are packed into one buffer, item `i` is [offsets[i], offsets[i + 1]).
+    const packBatch = (items) => {
+        const offsets = new Uint32Array(items.length + 1);
+        for (let i = 0; i < items.length; i++) {
+            const end = offsets[i] + items[i].length;
+            if (end > 0xffffffff) return null;
+            offsets[i + 1] = end;
+        }
+
+        const bytes = new Uint8Array(offsets[items.length]);
+        items.forEach((item, i) => bytes.set(item, offsets[i]));
+        return { bytes, offsets };
+    };
+
+    // NOTE: returns views of the packed result, they share one ArrayBuffer.
+    const unpackBatch = (packed_bytes, offsets) => {
+        const items = new Array(offsets.length - 1);
+        for (let i = 0; i < items.length; i++) {
+            items[i] = packed_bytes.subarray(offsets[i], offsets[i + 1]);
+        }
+        return items;
+    };
+
     const compressBoundImpl = (content_size) => {
         const rc = codec.compressBound(content_size);
         return rc >= 0 ? rc : null;
     };
 
+    // NOTE: returns `undefined` if frame doesn't record content size, `null` on error.
     const contentSizeImpl = (src_vec) => {
         const rc = codec.contentSize(src_vec);
+        if (rc === constants.ERR_CONTENT_SIZE_UNKNOWN) return undefined;
+        return rc >= 0 ? rc : null;
+    };
+
+    // NOTE: same as `contentSizeImpl`, sums all concatenated frames.
+    //       `undefined` without binding support too (stale Emscripten builds), callers fall back to streaming.
+    const framesContentSizeImpl = (src_vec) => {
+        if (typeof codec.framesContentSize !== 'function') return undefined;
+
+        const rc = codec.framesContentSize(src_vec);
+        if (rc === constants.ERR_CONTENT_SIZE_UNKNOWN) return undefined;
+        return rc >= 0 ? rc : null;
+    };
+
+    // NOTE: estimates are `null` on invalid parameters (or incomplete frame header).
+    const toEstimate = (rc) => {
         return rc >= 0 ? rc : null;
     };
 
@@ -49,8 +161,10 @@ const onReady = (binding) => {
         }
 
         array() {
-            // NOTE: clone buffer to shrink to fit
-            const buffer = ArrayBufferHelper.transfer(this._buffer, this._offset);
+            // NOTE: clone buffer to shrink to fit, unless size hint was exact.
+            const buffer = this._offset == this._buffer.byteLength
+                ? this._buffer
+                : ArrayBufferHelper.transfer(this._buffer, this._offset);
             return new Uint8Array(buffer);
         }
 
@@ -71,10 +185,75 @@ const onReady = (binding) => {
                 return contentSizeImpl(src);
             });
         }
+
+        maxWorkers() {
+            // NOTE: 0 on Emscripten builds, they are single-threaded.
+            return binding.ZstdCodec.maxWorkers();
+        }
+
+        releaseContexts() {
+            // NOTE: contexts are pooled and shared by all api objects, free idle ones to shrink heap usage.
+            codec.releaseContexts();
+        }
+
+        // bytes of contexts pooled for reuse by api objects without options, see `releaseContexts`.
+        get memoryUsage() {
+            return codec.memoryUsage();
+        }
+
+        // memory api, heap bytes a call needs besides its input and output, to admit jobs within the heap.
+        // `level_or_params` is a compression level, or parameters of `compressUsingParams`.
+        // `content_size` tunes parameters as zstd does for inputs of known size, omit it if unknown.
+        estimateCompressMemory(level_or_params, content_size) {
+            if (typeof level_or_params === 'object') {
+                return withCompressionParams(level_or_params, (binding_params) => {
+                    return toEstimate(binding.ZstdCodec.estimateCompressMemoryUsingParams(binding_params, content_size || 0));
+                });
+            }
+            return toEstimate(binding.ZstdCodec.estimateCompressMemory(correctCompressionLevel(level_or_params), content_size || 0));
+        }
+
+        estimateDecompressMemory() {
+            return toEstimate(binding.ZstdCodec.estimateDecompressMemory());
+        }
+
+        // streams (`Streaming` and stream transforms) keep their buffers, and the window of frames they decompress.
+        estimateStreamingCompressMemory(level_or_params) {
+            if (typeof level_or_params === 'object') {
+                return withCompressionParams(level_or_params, (binding_params) => {
+                    return toEstimate(binding.ZstdCompressStreamBinding.estimateMemoryUsingParams(binding_params));
+                });
+            }
+            return toEstimate(binding.ZstdCompressStreamBinding.estimateMemory(correctCompressionLevel(level_or_params)));
+        }
+
+        // `compressed_bytes` needs the frame header only (up to 18 bytes).
+        estimateStreamingDecompressMemory(compressed_bytes) {
+            return withCppVector((src) => {
+                binding.cloneToVector(src, compressed_bytes);
+                return toEstimate(binding.ZstdDecompressStreamBinding.estimateMemory(src));
+            });
+        }
+
+        estimateCompressionDictMemory(dict_size, compression_level) {
+            return binding.ZstdCompressionDict.estimateMemory(dict_size, correctCompressionLevel(compression_level));
+        }
+
+        estimateDecompressionDictMemory(dict_size) {
+            return binding.ZstdDecompressionDict.estimateMemory(dict_size);
+        }
     }
 
+    // `options.allocator`: `zstd.Allocator` serving contexts of this object, instead of the shared ones.
+    // `options.static`: `{ compressionLevel }`, static contexts initialized into workspaces reserved up front,
+    //                   calls never allocate a context, and fail when the workspace is too small for them.
     class Simple {
-        compress(content_bytes, compression_level) {
+        constructor(options) {
+            this._options = options;
+            this._codec = newCodec(options);
+        }
+
+        compress(content_bytes, compression_level, nb_workers) {
             // use basic-api `compress`, to embed `frameContentSize`.
 
             const compressBound = compressBoundImpl(content_bytes.length);
@@ -87,7 +266,9 @@ const onReady = (binding) => {
                     binding.cloneToVector(src, content_bytes);
                     dest.resize(compressBound, 0);
 
-                    var rc = codec.compress(dest, src, compression_level);
+                    var rc = nb_workers
+                        ? this._codec.compress(dest, src, compression_level, nb_workers)
+                        : this._codec.compress(dest, src, compression_level);
                     if (rc < 0) return null;    // `rc` is compressed size
 
                     dest.resize(rc, 0);
@@ -97,22 +278,75 @@ const onReady = (binding) => {
         }
 
         decompress(compressed_bytes) {
-            // use streaming-api, to support data without `frameContentSize`.
-            return withCppVector((src) => {
+            // fallback to streaming-api, to support data without `frameContentSize`.
+            const result = withCppVector((src) => {
                 return withCppVector((dest) => {
                     binding.cloneToVector(src, compressed_bytes);
 
                     const contentSize = contentSizeImpl(src);
+                    if (contentSize === undefined) return undefined;
                     if (!contentSize) return null;
 
                     dest.resize(contentSize, 0);
 
-                    var rc = codec.decompress(dest, src);
+                    var rc = this._codec.decompress(dest, src);
                     if (rc < 0 || rc != contentSize) return null;    // `rc` is compressed size
 
                     return binding.cloneAsTypedArray(dest);
                 });
             });
+
+            return result === undefined
+                ? this._withStreaming(streaming => streaming.decompress(compressed_bytes))
+                : result;
+        }
+
+        // compresses many small buffers in one binding call, returns an array of compressed buffers.
+        compressBatch(content_items, compression_level) {
+            const batch = packBatch(content_items);
+            if (!batch) return null;
+
+            const offsets = new Uint32Array(batch.offsets.length);
+            const rc = this._codec.compressBatch(batch.bytes, batch.offsets, offsets, correctCompressionLevel(compression_level));
+            if (typeof rc === 'number') return null;    // `rc` is packed output, or an error code
+
+            return unpackBatch(rc, offsets);
+        }
+
+        decompressBatch(compressed_items) {
+            const batch = packBatch(compressed_items);
+            if (!batch) return null;
+
+            const offsets = new Uint32Array(batch.offsets.length);
+            const rc = this._codec.decompressBatch(batch.bytes, batch.offsets, offsets);
+            if (rc === constants.ERR_CONTENT_SIZE_UNKNOWN) {
+                // fallback to one by one, to support data without `frameContentSize`.
+                const items = compressed_items.map(item => this.decompress(item));
+                return items.includes(null) ? null : items;
+            }
+            if (typeof rc === 'number') return null;    // `rc` is packed output, or an error code
+
+            return unpackBatch(rc, offsets);
+        }
+
+        compressUsingParams(content_bytes, params) {
+            const compressBound = compressBoundImpl(content_bytes.length);
+            if (!compressBound) return null;
+
+            return withCompressionParams(params, (binding_params) => {
+                return withCppVector((src) => {
+                    return withCppVector((dest) => {
+                        binding.cloneToVector(src, content_bytes);
+                        dest.resize(compressBound, 0);
+
+                        var rc = this._codec.compressUsingParams(dest, src, binding_params);
+                        if (rc < 0) return null;    // `rc` is compressed size
+
+                        dest.resize(rc, 0);
+                        return binding.cloneAsTypedArray(dest);
+                    });
+                });
+            });
         }
 
         compressUsingDict(content_bytes, cdict) {
@@ -126,7 +360,9 @@ const onReady = (binding) => {
                     binding.cloneToVector(src, content_bytes);
                     dest.resize(compressBound, 0);
 
-                    var rc = codec.compressUsingDict(dest, src, cdict.get());
+                    var rc = cdict instanceof CachedCompressionDict
+                        ? this._codec.compressUsingCache(dest, src, cdict.cache.get(), cdict.dict_id, cdict.compression_level)
+                        : this._codec.compressUsingDict(dest, src, cdict.get());
                     if (rc < 0) return null;    // `rc` is original content size
 
                     dest.resize(rc, 0);
@@ -136,28 +372,74 @@ const onReady = (binding) => {
         }
 
         decompressUsingDict(compressed_bytes, ddict) {
-            // use streaming-api, to support data without `frameContentSize`.
-            return withCppVector((src) => {
+            // fallback to streaming-api, to support data without `frameContentSize`.
+            const result = withCppVector((src) => {
                 return withCppVector((dest) => {
                     binding.cloneToVector(src, compressed_bytes);
 
-                    const contentSize = contentSizeImpl(src);
+                    // NOTE: registry picks dictionary of each frame, frames may be concatenated.
+                    const isRegistry = ddict instanceof ZstdDictRegistry;
+                    const contentSize = isRegistry ? framesContentSizeImpl(src) : contentSizeImpl(src);
+                    if (contentSize === undefined) return undefined;
                     if (!contentSize) return null;
 
                     dest.resize(contentSize, 0);
 
-                    var rc = codec.decompressUsingDict(dest, src, ddict.get());
+                    var rc = isRegistry
+                        ? this._codec.decompressUsingRegistry(dest, src, ddict.get())
+                        : this._codec.decompressUsingDict(dest, src, ddict.get());
                     if (rc < 0 || rc != contentSize) return null;    // `rc` is compressed size
 
                     return binding.cloneAsTypedArray(dest);
                 });
             });
+
+            return result === undefined
+                ? this._withStreaming(streaming => streaming.decompressUsingDict(compressed_bytes, undefined, ddict))
+                : result;
+        }
+
+        // NOTE: frames without content size fall back to streaming, its streams are freed right after.
+        _withStreaming(callback) {
+            const streaming = new Streaming(this._options);
+            try {
+                return callback(streaming);
+            }
+            finally {
+                streaming.close();
+            }
+        }
+
+        // bytes of contexts kept for reuse, shared with other api objects unless made for `options`.
+        get memoryUsage() {
+            return this._codec.memoryUsage();
+        }
+
+        // frees the codec made for `options`, the allocator itself is not closed.
+        close() {
+            if (this._codec !== codec) {
+                this._codec.delete();
+                this._codec = codec;
+            }
+        }
+
+        delete() {
+            this.close();
         }
     }
 
+    // `options.allocator`: same as `Simple`.
+    // `options.static`: `{ compressionLevel, maxWindowSize }`, static streams reused by all calls.
+    //                   decompression fails on frames with windows larger than `maxWindowSize` (default 8 MiB).
     class Streaming {
-        compress(content_bytes, compression_level) {
-            return withBindingInstance(new binding.ZstdCompressStreamBinding(), (stream) => {
+        constructor(options) {
+            this._options = options;
+            this._own_codec = null;
+            this._static_streams = new Map();
+        }
+
+        compress(content_bytes, compression_level, nb_workers) {
+            return this._withStream(binding.ZstdCompressStreamBinding, (stream) => {
                 const initial_size = compressBoundImpl(content_bytes.length);
                 const sink = new ArrayBufferSink(initial_size);
                 const callback = (compressed) => {
@@ -166,16 +448,48 @@ const onReady = (binding) => {
 
                 const level = correctCompressionLevel(compression_level);
 
-                if (!stream.begin(level)) return null;
-                if (!stream.transform(content_bytes, callback)) return null;
+                if (!beginStream(stream, level, nb_workers)) return null;
+                if (!transformBytes(stream, content_bytes, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
                 if (!stream.end(callback)) return null;
 
                 return sink.array();
             });
         }
 
-        compressChunks(chunks, size_hint, compression_level) {
-            return withBindingInstance(new binding.ZstdCompressStreamBinding(), (stream) => {
+        // compresses `block_size` blocks as independent frames on `nb_threads` threads (default: hardware threads),
+        // threads are available on native addon, Emscripten builds compress blocks one by one.
+        compressParallel(content_bytes, compression_level, nb_threads, block_size) {
+            const level = correctCompressionLevel(compression_level);
+
+            return withCppVector((src) => {
+                return withCppVector((dest) => {
+                    binding.cloneToVector(src, content_bytes);
+
+                    const rc = this._codec.compressParallel(dest, src, level, nb_threads || 0, block_size || 0);
+                    if (rc < 0) return null;    // `rc` is compressed size, `dest` is resized to fit
+
+                    return binding.cloneAsTypedArray(dest);
+                });
+            });
+        }
+
+        compressParallelUsingParams(content_bytes, params, nb_threads, block_size) {
+            return withCompressionParams(params, (binding_params) => {
+                return withCppVector((src) => {
+                    return withCppVector((dest) => {
+                        binding.cloneToVector(src, content_bytes);
+
+                        const rc = this._codec.compressParallelUsingParams(dest, src, binding_params, nb_threads || 0, block_size || 0);
+                        if (rc < 0) return null;    // `rc` is compressed size, `dest` is resized to fit
+
+                        return binding.cloneAsTypedArray(dest);
+                    });
+                });
+            });
+        }
+
+        compressChunks(chunks, size_hint, compression_level, nb_workers) {
+            return this._withStream(binding.ZstdCompressStreamBinding, (stream) => {
                 const initial_size = size_hint || constants.STREAMING_DEFAULT_BUFFER_SIZE;
                 const sink = new ArrayBufferSink(initial_size);
                 const callback = (compressed) => {
@@ -184,9 +498,51 @@ const onReady = (binding) => {
 
                 const level = correctCompressionLevel(compression_level);
 
-                if (!stream.begin(level)) return null;
+                if (!beginStream(stream, level, nb_workers)) return null;
                 for (const chunk of chunks) {
-                    if (!stream.transform(chunk, callback)) return null;
+                    if (!transformBytes(stream, chunk, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
+                }
+                if (!stream.end(callback)) return null;
+
+                return sink.array();
+            });
+        }
+
+        compressUsingParams(content_bytes, params) {
+            return this._withStream(binding.ZstdCompressStreamBinding, (stream) => {
+                const initial_size = compressBoundImpl(content_bytes.length);
+                const sink = new ArrayBufferSink(initial_size);
+                const callback = (compressed) => {
+                    sink.concat(compressed);
+                };
+
+                const began = withCompressionParams(params, (binding_params) => {
+                    return stream.beginUsingParams(binding_params);
+                });
+
+                if (!began) return null;
+                if (!transformBytes(stream, content_bytes, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
+                if (!stream.end(callback)) return null;
+
+                return sink.array();
+            });
+        }
+
+        compressChunksUsingParams(chunks, size_hint, params) {
+            return this._withStream(binding.ZstdCompressStreamBinding, (stream) => {
+                const initial_size = size_hint || constants.STREAMING_DEFAULT_BUFFER_SIZE;
+                const sink = new ArrayBufferSink(initial_size);
+                const callback = (compressed) => {
+                    sink.concat(compressed);
+                };
+
+                const began = withCompressionParams(params, (binding_params) => {
+                    return stream.beginUsingParams(binding_params);
+                });
+
+                if (!began) return null;
+                for (const chunk of chunks) {
+                    if (!transformBytes(stream, chunk, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
                 }
                 if (!stream.end(callback)) return null;
 
@@ -195,15 +551,15 @@ const onReady = (binding) => {
         }
 
         compressUsingDict(content_bytes, cdict) {
-            return withBindingInstance(new binding.ZstdCompressStreamBinding(), (stream) => {
+            return this._withStream(binding.ZstdCompressStreamBinding, (stream) => {
                 const initial_size = compressBoundImpl(content_bytes.length);
                 const sink = new ArrayBufferSink(initial_size);
                 const callback = (compressed) => {
                     sink.concat(compressed);
                 };
 
-                if (!stream.beginUsingDict(cdict.get())) return null;
-                if (!stream.transform(content_bytes, callback)) return null;
+                if (!beginCompressStreamUsingDict(stream, cdict)) return null;
+                if (!transformBytes(stream, content_bytes, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
                 if (!stream.end(callback)) return null;
 
                 return sink.array();
@@ -211,16 +567,16 @@ const onReady = (binding) => {
         }
 
         compressChunksUsingDict(chunks, size_hint, cdict) {
-            return withBindingInstance(new binding.ZstdCompressStreamBinding(), (stream) => {
+            return this._withStream(binding.ZstdCompressStreamBinding, (stream) => {
                 const initial_size = size_hint || constants.STREAMING_DEFAULT_BUFFER_SIZE;
                 const sink = new ArrayBufferSink(initial_size);
                 const callback = (compressed) => {
                     sink.concat(compressed);
                 };
 
-                if (!stream.beginUsingDict(cdict.get())) return null;
+                if (!beginCompressStreamUsingDict(stream, cdict)) return null;
                 for (const chunk of chunks) {
-                    if (!stream.transform(chunk, callback)) return null;
+                    if (!transformBytes(stream, chunk, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
                 }
                 if (!stream.end(callback)) return null;
 
@@ -229,7 +585,7 @@ const onReady = (binding) => {
         }
 
         decompress(compressed_bytes, size_hint) {
-            return withBindingInstance(new binding.ZstdDecompressStreamBinding(), (stream) => {
+            return this._withStream(binding.ZstdDecompressStreamBinding, (stream) => {
                 const initial_size = size_hint || this._estimateContentSize(compressed_bytes);
                 const sink = new ArrayBufferSink(initial_size);
                 const callback = (decompressed) => {
@@ -237,15 +593,35 @@ const onReady = (binding) => {
                 };
 
                 if (!stream.begin()) return null;
-                if (!stream.transform(compressed_bytes, callback)) return null;
+                if (!transformBytes(stream, compressed_bytes, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
                 if (!stream.end(callback)) return null;
 
                 return sink.array();
             });
         }
 
+        // decompresses concatenated frames (e.g. compressParallel() output) on `nb_threads` threads,
+        // frames without `frameContentSize` fallback to decompress().
+        decompressParallel(compressed_bytes, nb_threads) {
+            const result = withCppVector((src) => {
+                return withCppVector((dest) => {
+                    binding.cloneToVector(src, compressed_bytes);
+
+                    const rc = this._codec.decompressParallel(dest, src, nb_threads || 0);
+                    if (rc === constants.ERR_CONTENT_SIZE_UNKNOWN) return undefined;
+                    if (rc < 0) return null;    // `rc` is decompressed size, `dest` is resized to fit
+
+                    return binding.cloneAsTypedArray(dest);
+                });
+            });
+
+            return result === undefined
+                ? this.decompress(compressed_bytes)
+                : result;
+        }
+
         decompressChunks(chunks, size_hint) {
-            return withBindingInstance(new binding.ZstdDecompressStreamBinding(), (stream) => {
+            return this._withStream(binding.ZstdDecompressStreamBinding, (stream) => {
                 const initial_size = size_hint || constants.STREAMING_DEFAULT_BUFFER_SIZE;
                 const sink = new ArrayBufferSink(initial_size);
                 const callback = (decompressed) => {
@@ -254,7 +630,7 @@ const onReady = (binding) => {
 
                 if (!stream.begin()) return null;
                 for (const chunk of chunks) {
-                    if (!stream.transform(chunk, callback)) return null;
+                    if (!transformBytes(stream, chunk, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
                 }
                 if (!stream.end(callback)) return null;
 
@@ -263,15 +639,15 @@ const onReady = (binding) => {
         }
 
         decompressUsingDict(compressed_bytes, size_hint, ddict) {
-            return withBindingInstance(new binding.ZstdDecompressStreamBinding(), (stream) => {
+            return this._withStream(binding.ZstdDecompressStreamBinding, (stream) => {
                 const initial_size = size_hint || this._estimateContentSize(compressed_bytes);
                 const sink = new ArrayBufferSink(initial_size);
                 const callback = (decompressed) => {
                     sink.concat(decompressed);
                 };
 
-                if (!stream.beginUsingDict(ddict.get())) return null;
-                if (!stream.transform(compressed_bytes, callback)) return null;
+                if (!beginDecompressStreamUsingDict(stream, ddict)) return null;
+                if (!transformBytes(stream, compressed_bytes, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
                 if (!stream.end(callback)) return null;
 
                 return sink.array();
@@ -279,16 +655,16 @@ const onReady = (binding) => {
         }
 
         decompressChunksUsingDict(chunks, size_hint, ddict) {
-            return withBindingInstance(new binding.ZstdDecompressStreamBinding(), (stream) => {
+            return this._withStream(binding.ZstdDecompressStreamBinding, (stream) => {
                 const initial_size = size_hint || constants.STREAMING_DEFAULT_BUFFER_SIZE;
                 const sink = new ArrayBufferSink(initial_size);
                 const callback = (decompressed) => {
                     sink.concat(decompressed);
                 };
 
-                if (!stream.beginUsingDict(ddict.get())) return null;
+                if (!beginDecompressStreamUsingDict(stream, ddict)) return null;
                 for (const chunk of chunks) {
-                    if (!stream.transform(chunk, callback)) return null;
+                    if (!transformBytes(stream, chunk, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
                 }
                 if (!stream.end(callback)) return null;
 
@@ -301,6 +677,136 @@ const onReady = (binding) => {
             // with lzbench, ratio=3.11 .. 3.14. round up to integer
             return compressed_bytes.length * 4;
         }
+
+        // NOTE: only parallel methods use a codec, make it on first use.
+        get _codec() {
+            if (!this._own_codec && hasOwnContexts(this._options)) {
+                this._own_codec = newCodec(this._options);
+            }
+            return this._own_codec || codec;
+        }
+
+        _withStream(klass, callback) {
+            if (!this._options || !this._options.static) {
+                return withBindingInstance(newWithAllocator(klass, this._options), callback);
+            }
+
+            if (!this._static_streams.has(klass)) {
+                this._static_streams.set(klass, newStaticStream(klass, this._options.static));
+            }
+
+            // NOTE: end() resets the stream for the next call, also after a failure.
+            const stream = this._static_streams.get(klass);
+            try {
+                return callback(stream);
+            }
+            finally {
+                stream.end(() => {});
+            }
+        }
+
+        // bytes of the codec and streams made for `options`, streams of other calls are freed when they return.
+        get memoryUsage() {
+            let memory = this._own_codec ? this._own_codec.memoryUsage() : 0;
+            this._static_streams.forEach(stream => { memory += stream.memoryUsage(); });
+            return memory;
+        }
+
+        // frees the codec and streams made for `options`, the allocator itself is not closed.
+        close() {
+            if (this._own_codec) {
+                this._own_codec.delete();
+                this._own_codec = null;
+            }
+
+            this._static_streams.forEach(stream => stream.delete());
+            this._static_streams.clear();
+        }
+
+        delete() {
+            this.close();
+        }
+    }
+
+    // zstd seekable format: independent frames of at most `max_frame_size` bytes (default 1 MiB) and a seek table.
+    // any decompressor reads it, `SeekableReader` decompresses ranges of it.
+    class Seekable {
+        compress(content_bytes, compression_level, max_frame_size, checksum_flag) {
+            return this.compressChunks([content_bytes], content_bytes.length, compression_level, max_frame_size, checksum_flag);
+        }
+
+        compressChunks(chunks, size_hint, compression_level, max_frame_size, checksum_flag) {
+            const level = correctCompressionLevel(compression_level);
+            const checksum = checksum_flag === undefined ? true : checksum_flag;
+
+            return this._compressChunks(chunks, size_hint, (stream) => {
+                return stream.begin(level, max_frame_size || 0, checksum);
+            });
+        }
+
+        compressUsingParams(content_bytes, params, max_frame_size) {
+            return withCompressionParams(params, (binding_params) => {
+                return this._compressChunks([content_bytes], content_bytes.length, (stream) => {
+                    return stream.beginUsingParams(binding_params, max_frame_size || 0);
+                });
+            });
+        }
+
+        _compressChunks(chunks, size_hint, begin) {
+            return withBindingInstance(new binding.ZstdSeekableCompressStreamBinding(), (stream) => {
+                const initial_size = size_hint || constants.STREAMING_DEFAULT_BUFFER_SIZE;
+                const sink = new ArrayBufferSink(initial_size);
+                const callback = (compressed) => {
+                    sink.concat(compressed);
+                };
+
+                if (!begin(stream)) return null;
+                for (const chunk of chunks) {
+                    if (!transformBytes(stream, chunk, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) return null;
+                }
+                if (!stream.end(callback)) return null;
+
+                return sink.array();
+            });
+        }
+    }
+
+    class SeekableReader {
+        constructor() {
+            this.binding = new binding.ZstdSeekableReaderBinding();
+        }
+
+        // `src` is seekable format data, or `(offset, size) => Uint8Array` reading `src_size` bytes of it,
+        // the source returns null on failure.
+        open(src, src_size) {
+            return typeof src === 'function'
+                ? this.binding.openUsingSource(src_size, src)
+                : this.binding.open(src);
+        }
+
+        get frameCount() {
+            return this.binding.frameCount();
+        }
+
+        get contentSize() {
+            return this.binding.contentSize();
+        }
+
+        // returns decompressed bytes of [offset, offset + size), shorter at the end of content, or null on failure.
+        read(offset, size) {
+            return this.binding.read(offset, size);
+        }
+
+        close() {
+            if (this.binding) {
+                this.binding.delete();
+                this.binding = null;
+            }
+        }
+
+        delete() {
+            this.close();
+        }
     }
 
     class ZstdCompressionDict {
@@ -308,6 +814,10 @@ const onReady = (binding) => {
             this.binding = binding.createCompressionDict(dict_bytes, compression_level);
         }
 
+        get memoryUsage() {
+            return this.binding.memoryUsage();
+        }
+
         get() {
             return this.binding;
         }
@@ -323,11 +833,87 @@ const onReady = (binding) => {
         }
     }
 
+    // dictionary of `ZstdCompressionDictCache` at a compression level, digested on first use.
+    class CachedCompressionDict {
+        constructor(cache, dict_id, compression_level) {
+            this.cache = cache;
+            this.dict_id = dict_id;
+            this.compression_level = compression_level;
+        }
+    }
+
+    class ZstdCompressionDictCache {
+        constructor(memory_budget) {
+            this.binding = new binding.ZstdCDictCache();
+            if (memory_budget !== undefined) {
+                this.binding.setMemoryBudget(memory_budget);
+            }
+        }
+
+        // returns dictionary ID, or null if `dict_bytes` is not a zstd dictionary (raw content has no ID)
+        add(dict_bytes) {
+            const rc = this.binding.addDict(dict_bytes);
+            return rc > 0 ? rc : null;
+        }
+
+        remove(dict_id) {
+            return this.binding.removeDict(dict_id);
+        }
+
+        has(dict_id) {
+            return this.binding.containsDict(dict_id);
+        }
+
+        // returns a dictionary usable in place of `ZstdCompressionDict`
+        dict(dict_id, compression_level) {
+            return new CachedCompressionDict(this, dict_id, compression_level);
+        }
+
+        get digestedCount() {
+            return this.binding.digestedCount();
+        }
+
+        get memoryUsage() {
+            return this.binding.memoryUsage();
+        }
+
+        get memoryBudget() {
+            return this.binding.memoryBudget();
+        }
+
+        set memoryBudget(memory_budget) {
+            this.binding.setMemoryBudget(memory_budget);
+        }
+
+        clear() {
+            this.binding.clear();
+        }
+
+        get() {
+            return this.binding;
+        }
+
+        close() {
+            if (this.binding) {
+                this.binding.delete();
+                this.binding = null;
+            }
+        }
+
+        delete() {
+            this.close();
+        }
+    }
+
     class ZstdDecompressionDict {
         constructor(dict_bytes) {
             this.binding = new binding.createDecompressionDict(dict_bytes);
         }
 
+        get memoryUsage() {
+            return this.binding.memoryUsage();
+        }
+
         get() {
             return this.binding;
         }
@@ -343,21 +929,206 @@ const onReady = (binding) => {
         }
     }
 
+    class ZstdDictRegistry {
+        constructor() {
+            this.binding = new binding.ZstdDictRegistry();
+        }
+
+        // returns dictionary ID, or null if `dict_bytes` is not a zstd dictionary (raw content has no ID)
+        add(dict_bytes) {
+            const rc = this.binding.add(dict_bytes);
+            return rc > 0 ? rc : null;
+        }
+
+        remove(dict_id) {
+            return this.binding.remove(dict_id);
+        }
+
+        has(dict_id) {
+            return this.binding.contains(dict_id);
+        }
+
+        get size() {
+            return this.binding.count();
+        }
+
+        clear() {
+            this.binding.clear();
+        }
+
+        get() {
+            return this.binding;
+        }
+
+        close() {
+            if (this.binding) {
+                this.binding.delete();
+                this.binding = null;
+            }
+        }
+
+        delete() {
+            this.close();
+        }
+    }
+
+    class ZstdDictTrainer {
+        constructor() {
+            this.binding = new binding.ZstdDictTrainer();
+        }
+
+        addSample(sample_bytes) {
+            this.binding.addSample(sample_bytes);
+            return this;
+        }
+
+        get sampleCount() {
+            return this.binding.sampleCount();
+        }
+
+        get samplesSize() {
+            return this.binding.samplesSize();
+        }
+
+        clear() {
+            this.binding.clear();
+        }
+
+        // `options.algorithm`: 'cover', 'fastCover', or undefined for `ZDICT_trainFromBuffer`
+        // other options are `ZstdDictTrainingParams` (0 or undefined to let zstd optimize it)
+        train(dict_capacity, options) {
+            dict_capacity = dict_capacity || constants.DEFAULT_DICT_CAPACITY;
+            const algorithm = options && options.algorithm;
+
+            return withCppVector((dict) => {
+                const rc = algorithm
+                    ? withDictTrainingParams(options, (params) => {
+                        return algorithm === 'cover'
+                            ? this.binding.trainCover(dict, dict_capacity, params)
+                            : this.binding.trainFastCover(dict, dict_capacity, params);
+                    })
+                    : this.binding.train(dict, dict_capacity);
+                if (rc < 0) return null;    // `rc` is dictionary size
+
+                return binding.cloneAsTypedArray(dict);
+            });
+        }
+
+        close() {
+            if (this.binding) {
+                this.binding.delete();
+                this.binding = null;
+            }
+        }
+
+        delete() {
+            this.close();
+        }
+
+        // returns 0 if `dict_bytes` is not a zstd dictionary.
+        static dictID(dict_bytes) {
+            return withCppVector((dict) => {
+                binding.cloneToVector(dict, dict_bytes);
+                return binding.ZstdDictTrainer.dictID(dict);
+            });
+        }
+    }
+
+    // allocator of zstd contexts, reports bytes they use. objects made with it keep it alive until they are closed.
+    // `arena(capacity)`: one buffer reserved up front, for a single stream or codec call at a time.
+    // `pool(max_cached_bytes)`: size classes, keeps freed blocks for the next contexts.
+    // `malloc()`: plain malloc, for numbers only.
+    class ZstdAllocator {
+        constructor(binding_allocator) {
+            this.binding = binding_allocator;
+        }
+
+        static malloc() {
+            return new ZstdAllocator(binding.createMallocAllocator());
+        }
+
+        static arena(capacity) {
+            const allocator = binding.createArenaAllocator(capacity);
+            if (!allocator) throw new Error('zstd-codec: failed to reserve arena');
+            return new ZstdAllocator(allocator);
+        }
+
+        static pool(max_cached_bytes) {
+            const max_cached = max_cached_bytes === undefined ? constants.POOL_DEFAULT_MAX_CACHED_BYTES : max_cached_bytes;
+            return new ZstdAllocator(binding.createPoolAllocator(max_cached));
+        }
+
+        // bytes allocated by zstd and not freed yet
+        get currentBytes() {
+            return this.binding.currentBytes();
+        }
+
+        get peakBytes() {
+            return this.binding.peakBytes();
+        }
+
+        // bytes taken from the heap, including free space of arena and cached blocks of pool
+        get reservedBytes() {
+            return this.binding.reservedBytes();
+        }
+
+        resetPeak() {
+            this.binding.resetPeak();
+        }
+
+        // frees cached blocks of pool
+        trim() {
+            this.binding.trim();
+        }
+
+        get() {
+            return this.binding;
+        }
+
+        close() {
+            if (this.binding) {
+                this.binding.delete();
+                this.binding = null;
+            }
+        }
+
+        delete() {
+            this.close();
+        }
+    }
+
+    // NOTE: Node.js only, workers load the same kind of binding as `run(f, options)`.
+    class Async extends ZstdAsync {
+        constructor(options) {
+            super(options, run_options);
+        }
+    }
+
     const zstd = {};
     zstd.Generic = Generic;
     zstd.Simple = Simple;
     zstd.Streaming = Streaming;
+    zstd.Seekable = Seekable;
+    zstd.SeekableReader = SeekableReader;
+    zstd.Async = Async;
+    zstd.Allocator = ZstdAllocator;
+    zstd.Strategy = constants.Strategy;
+    // NOTE: symbols the prebuilt Emscripten binding lacks (always empty on native addon), those apis throw when used.
+    zstd.bindingMissingSymbols = binding.missingSymbols || [];
 
     zstd.Dict = {};
     zstd.Dict.Compression = ZstdCompressionDict;
     zstd.Dict.Decompression = ZstdDecompressionDict;
+    zstd.Dict.Trainer = ZstdDictTrainer;
+    zstd.Dict.Registry = ZstdDictRegistry;
+    zstd.Dict.CompressionCache = ZstdCompressionDictCache;
 
     return zstd;
 };
 
-exports.run = (f) => {
+exports.run = (f, options) => {
     return require('./module.js').run((binding) => {
-        const zstd = onReady(binding);
+        const zstd = onReady(binding, options);
         f(zstd);
-    });
+    }, options);
 };
@@ -5,18 +5,37 @@ const helpers = require('./helpers.js');
 
 const getClassName = helpers.getClassName;
 const toTypedArray = helpers.toTypedArray;
-const fromTypedArrayToBuffer = helpers.fromTypedArrayToBuffer;
+const transformBytes = helpers.transformBytes;
 
 const onReady = (binding) => {
+    // `option.allocator`: `zstd.Allocator` serving the stream context, see zstd-codec.js
+    // `option.static`: static stream initialized into a workspace reserved up front,
+    //                  `{ maxWindowSize }` of decompression (default 8 MiB), compression is sized for its level.
+    const newStreamBinding = (klass, option) => {
+        const allocator = option && option.allocator;
+        return allocator ? new klass(allocator.get()) : new klass();
+    };
+
     class ZstdCompressTransform extends stream.Transform {
-        constructor(compression_level, string_decoder, option) {
+        constructor(compression_level, string_decoder, option, nb_workers) {
             super(option || {});
 
+            const level = compression_level || constants.DEFAULT_COMPRESSION_LEVEL;
+
             this.string_decoder = string_decoder;
-            this.binding = new binding.ZstdCompressStreamBinding();
-            this.binding.begin(compression_level || constants.DEFAULT_COMPRESSION_LEVEL);
+            this.binding = option && option.static
+                ? new binding.ZstdCompressStreamBinding(binding.ZstdCompressStreamBinding.staticWorkspaceSize(level))
+                : newStreamBinding(binding.ZstdCompressStreamBinding, option);
+
+            if (nb_workers) {
+                this.binding.begin(level, nb_workers);
+            }
+            else {
+                this.binding.begin(level);
+            }
+            // NOTE: callback may receive a view of binding's heap, copy it before passing downstream.
             this.callback = (compressed) => {
-                this.push(fromTypedArrayToBuffer(compressed), 'buffer');
+                this.push(Buffer.from(compressed), 'buffer');
             };
         }
 
@@ -28,7 +47,7 @@ const onReady = (binding) => {
                 return;
             }
 
-            if (this.binding.transform(chunkBytes, this.callback)) {
+            if (transformBytes(this.binding, chunkBytes, this.callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) {
                 callback();
             }
             else {
@@ -60,10 +79,13 @@ const onReady = (binding) => {
         constructor(option) {
             super(option || {});
 
-            this.binding = new binding.ZstdDecompressStreamBinding();
+            this.binding = option && option.static
+                ? new binding.ZstdDecompressStreamBinding(binding.ZstdDecompressStreamBinding.staticWorkspaceSize(
+                    option.static.maxWindowSize || constants.STATIC_DEFAULT_MAX_WINDOW_SIZE))
+                : newStreamBinding(binding.ZstdDecompressStreamBinding, option);
             this.binding.begin();
             this.callback = (decompressed) => {
-                this.push(fromTypedArrayToBuffer(decompressed), 'buffer');
+                this.push(Buffer.from(decompressed), 'buffer');
             };
         }
 
@@ -75,7 +97,7 @@ const onReady = (binding) => {
                 return;
             }
 
-            if (this.binding.transform(chunk, this.callback)) {
+            if (transformBytes(this.binding, chunkBytes, this.callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) {
                 callback();
             }
             else {
@@ -108,9 +130,9 @@ const onReady = (binding) => {
     return streams;
 };
 
-exports.run = (f) => {
+exports.run = (f, options) => {
     return require('./module.js').run((binding) => {
         const streams = onReady(binding);
         f(streams);
-    });
+    }, options);
 };
@@ -0,0 +1,268 @@
+const constants = require('./constants.js');
+const helpers = require('./helpers.js');
+
+const getClassName = helpers.getClassName;
+const toTypedArray = helpers.toTypedArray;
+const transformBytes = helpers.transformBytes;
+
+// NOTE: readable side is a byte stream, readers may read with `getReader({ mode: 'byob' })`.
+//       byte streams count bytes, their strategies take `highWaterMark` only.
+//       default is the same as `TransformStream`, nothing is queued until readers ask.
+const DEFAULT_READABLE_STRATEGY = { highWaterMark: 0 };
+const AUTO_ALLOCATE_CHUNK_SIZE = 128 * 1024;
+
+// NOTE: Node.js has them in `stream/web` too, use variable name to keep bundlers from resolving it.
+const streamWebModule = 'stream/web';
+const webStreams = () => {
+    if (typeof ReadableStream === 'function' && typeof WritableStream === 'function') {
+        return { ReadableStream, WritableStream };
+    }
+    return require(streamWebModule);
+};
+
+// NOTE: same as `CompressionStream`, chunks are BufferSource, strings are not encoded.
+const toChunkBytes = (chunk) => {
+    if (ArrayBuffer.isView(chunk)) return new Uint8Array(chunk.buffer, chunk.byteOffset, chunk.byteLength);
+    if (helpers.isString(chunk)) return null;
+    return toTypedArray(chunk);
+};
+
+const unsupportedChunkError = (chunk, class_name) => {
+    const type_name = getClassName(chunk) || typeof chunk;
+    return new TypeError(`${class_name}: unsupported chunk type: ${type_name}`);
+};
+
+const onReady = (binding) => {
+    // NOTE: Emscripten bindings call back with views of their heap, native addon with new arrays.
+    const ownsCallbackBytes = !binding.HEAPU8;
+
+    // same interface as `TransformStream` (and `CompressionStream`), pass it to `ReadableStream#pipeThrough`.
+    class ZstdCompressionStream {
+        constructor(compression_level, writable_strategy, readable_strategy) {
+            const { ReadableStream, WritableStream } = webStreams();
+            const stream = new binding.ZstdCompressStreamBinding();
+            if (!stream.begin(compression_level || constants.DEFAULT_COMPRESSION_LEVEL)) {
+                stream.delete();
+                throw new Error('ZstdCompressionStream: Error on begin');
+            }
+
+            let controller = null;
+            let pulled = null;      // resolves on next pull, while readable side is full
+            let demanded = false;   // pulled since the last enqueue, readers wait for output
+            let released = false;
+
+            const release = () => {
+                if (released) return;
+                released = true;
+                stream.delete();
+                if (pulled) pulled.resolve();
+            };
+
+            // NOTE: enqueue transfers the buffer, copy views of the binding's heap.
+            //       stream pulls again after enqueue, if readers still wait.
+            const callback = (compressed) => {
+                demanded = false;
+                controller.enqueue(ownsCallbackBytes ? compressed : compressed.slice());
+            };
+
+            const waitForPull = () => {
+                if (released || demanded || controller.desiredSize > 0) return undefined;
+
+                let resolve = null;
+                const promise = new Promise((r) => { resolve = r; });
+                pulled = { promise, resolve };
+                return promise;
+            };
+
+            // NOTE: errors both sides, like a throwing transformer of `TransformStream`.
+            const fail = (error) => {
+                controller.error(error);
+                release();
+                return error;
+            };
+
+            this.readable = new ReadableStream({
+                type: 'bytes',
+                start: (c) => { controller = c; },
+                pull: () => {
+                    demanded = true;
+                    if (pulled) {
+                        pulled.resolve();
+                        pulled = null;
+                    }
+                },
+                cancel: release,
+            }, readable_strategy || DEFAULT_READABLE_STRATEGY);
+
+            this.writable = new WritableStream({
+                write: (chunk) => {
+                    if (released) throw new Error('ZstdCompressionStream: readable side is canceled');
+
+                    const chunk_bytes = toChunkBytes(chunk);
+                    if (!chunk_bytes) throw fail(unsupportedChunkError(chunk, 'ZstdCompressionStream'));
+                    if (!transformBytes(stream, chunk_bytes, callback, constants.STREAMING_DEFAULT_BUFFER_SIZE)) {
+                        throw fail(new Error('ZstdCompressionStream: Error on transform'));
+                    }
+                    return waitForPull();
+                },
+                close: () => {
+                    if (released) return;
+                    if (!stream.end(callback)) throw fail(new Error('ZstdCompressionStream: Error on end'));
+
+                    controller.close();
+                    release();
+                },
+                abort: (reason) => {
+                    if (!released) controller.error(reason);
+                    release();
+                },
+            }, writable_strategy);
+        }
+    }
+
+
+    // decompresses as readers pull, straight into their views (BYOB) or chunks of `AUTO_ALLOCATE_CHUNK_SIZE`.
+    // NOTE: a written chunk is held until its output is read, so writes wait for the readers.
+    class ZstdDecompressionStream {
+        constructor(writable_strategy, readable_strategy) {
+            const { ReadableStream, WritableStream } = webStreams();
+            const stream = new binding.ZstdDecompressReadBinding();
+            if (!stream.begin()) {
+                stream.delete();
+                throw new Error('ZstdDecompressionStream: Error on begin');
+            }
+
+            let controller = null;
+            let loaded = null;      // resolves when the next chunk is loaded, or writable side is closed
+            let consumed = null;    // resolves when the loaded chunk is consumed
+            let ended = null;       // resolves when the stream is ended, after writable side is closed
+            let closing = false;
+            let released = false;
+            let failure = null;     // error of both sides
+
+            // NOTE: pending write/close reject with `failure`, that errors writable side too.
+            const release = () => {
+                if (released) return;
+                released = true;
+                stream.delete();
+                if (loaded) loaded.resolve();
+                for (const pending of [consumed, ended]) {
+                    if (pending && failure) pending.reject(failure);
+                    else if (pending) pending.resolve();
+                }
+            };
+
+            const deferred = () => {
+                let resolve = null;
+                let reject = null;
+                const promise = new Promise((res, rej) => { resolve = res; reject = rej; });
+                return { promise, resolve, reject };
+            };
+
+            const settle = (name) => {
+                if (name === 'loaded' && loaded) {
+                    loaded.resolve();
+                    loaded = null;
+                }
+                if (name === 'consumed' && consumed) {
+                    consumed.resolve();
+                    consumed = null;
+                }
+            };
+
+            const fail = (error) => {
+                failure = failure || error;
+                controller.error(error);
+                release();
+                return error;
+            };
+
+            const pull = () => {
+                if (released) return undefined;
+
+                const request = controller.byobRequest;
+                const view = new Uint8Array(request.view.buffer, request.view.byteOffset, request.view.byteLength);
+                const read_size = stream.readInto(view);
+                if (read_size < 0) {
+                    fail(new Error('ZstdDecompressionStream: Error on read'));
+                    return undefined;
+                }
+                if (read_size > 0) {
+                    request.respond(read_size);
+                    return undefined;
+                }
+
+                // loaded chunk is consumed, ask for the next one
+                settle('consumed');
+                if (closing) {
+                    // NOTE: fails on truncated frame, same as ZstdDecompressStream.
+                    if (!stream.end(() => {})) {
+                        fail(new Error('ZstdDecompressionStream: Error on end'));
+                        return undefined;
+                    }
+                    controller.close();
+                    request.respond(0);
+                    release();
+                    return undefined;
+                }
+
+                loaded = loaded || deferred();
+                return loaded.promise.then(pull);
+            };
+
+            this.readable = new ReadableStream({
+                type: 'bytes',
+                autoAllocateChunkSize: AUTO_ALLOCATE_CHUNK_SIZE,
+                start: (c) => { controller = c; },
+                pull: pull,
+                cancel: release,
+            }, readable_strategy || DEFAULT_READABLE_STRATEGY);
+
+            this.writable = new WritableStream({
+                write: (chunk) => {
+                    if (released) throw failure || new Error('ZstdDecompressionStream: readable side is canceled');
+
+                    const chunk_bytes = toChunkBytes(chunk);
+                    if (!chunk_bytes) throw fail(unsupportedChunkError(chunk, 'ZstdDecompressionStream'));
+                    if (chunk_bytes.length === 0) return undefined;
+                    if (!stream.load(chunk_bytes)) throw fail(new Error('ZstdDecompressionStream: Error on load'));
+
+                    consumed = deferred();
+                    const promise = consumed.promise;
+                    settle('loaded');
+                    return promise;
+                },
+                close: () => {
+                    if (released) {
+                        if (failure) throw failure;
+                        return undefined;
+                    }
+
+                    closing = true;
+                    ended = deferred();
+                    const promise = ended.promise;
+                    settle('loaded');
+                    return promise;
+                },
+                abort: (reason) => {
+                    if (!released) controller.error(reason);
+                    release();
+                },
+            }, writable_strategy);
+        }
+    }
+
+    const streams = {};
+    streams.ZstdCompressionStream = ZstdCompressionStream;
+    streams.ZstdDecompressionStream = ZstdDecompressionStream;
+    // NOTE: symbols the prebuilt Emscripten binding lacks (always empty on native addon), see zstd-codec.js
+    streams.bindingMissingSymbols = binding.missingSymbols || [];
+    return streams;
+};
+
+exports.run = (f, options) => {
+    return require('./module.js').run((binding) => {
+        const streams = onReady(binding);
+        f(streams);
+    }, options);
+};